@@ -0,0 +1,44 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <Arduino.h>
+#include <ArduinoLog.h>
+
+/**
+ * A clock for timing benchmarks. Returns the current time in any unit (e.g. ns on the host, CPU
+ * cycles on the ESP32). It may wrap, as only differences are used
+ */
+using BenchmarkClock = uint32_t (*)();
+
+// Keeps the compiler from removing the timed calls
+extern volatile float benchmarkSink;
+
+/**
+ * Time a kernel and log the average time per call at the notice level
+ *
+ * @tparam Kernel - A callable taking the iteration and returning a float
+ * @param name - The name to log the kernel as
+ * @param iterations - The number of calls to time
+ * @param now - The clock to time with
+ * @param unit - The name of the clock's unit
+ * @param kernel - The kernel
+ * @param elements - The number of elements each call processes (for batch kernels)
+ */
+template<typename Kernel>
+void benchmark(const char *name, const uint32_t &iterations, BenchmarkClock now, const char *unit,
+               Kernel kernel, const uint32_t &elements = 1) {
+    uint32_t start = now();
+    for (uint32_t i(0); i < iterations; ++i) {
+        benchmarkSink = benchmarkSink + kernel(i);
+    }
+    uint32_t elapsed = now() - start;
+
+    Log.noticeln("Benchmark - %s: %F %s/call", name,
+                 static_cast<float>(elapsed) / static_cast<float>(iterations * elements), unit);
+}
+
+#endif // BENCHMARK_H
@@ -0,0 +1,20 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef CONTROLBENCHMARKS_H
+#define CONTROLBENCHMARKS_H
+
+#include "benchmarks/benchmark.h"
+
+/**
+ * Time the stages of the control loop and log the average time of each call at the notice level.
+ * Runs the same on the host and the ESP32
+ *
+ * @param iterations - The number of calls to time per stage
+ * @param now - The clock to time with
+ * @param unit - The name of the clock's unit for the log
+ */
+void runControlBenchmarks(const uint32_t &iterations, BenchmarkClock now, const char *unit);
+
+#endif // CONTROLBENCHMARKS_H
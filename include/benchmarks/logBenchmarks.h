@@ -0,0 +1,22 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef LOGBENCHMARKS_H
+#define LOGBENCHMARKS_H
+
+#include "benchmarks/benchmark.h"
+
+/**
+ * Time the deferred logging and log the average time of each call at the notice level: what a
+ * message costs the caller (deferring it to the ring buffer), and what it costs the draining task
+ * (taking it back out and formatting it). Any waiting messages are written out first, and the
+ * ring buffer is left empty. Runs the same on the host and the ESP32
+ *
+ * @param iterations - The number of calls to time per stage
+ * @param now - The clock to time with
+ * @param unit - The name of the clock's unit for the log
+ */
+void runLogBenchmarks(const uint32_t &iterations, BenchmarkClock now, const char *unit);
+
+#endif // LOGBENCHMARKS_H
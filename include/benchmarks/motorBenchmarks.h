@@ -0,0 +1,26 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef MOTORBENCHMARKS_H
+#define MOTORBENCHMARKS_H
+
+#include <array>
+#include "benchmarks/benchmark.h"
+
+/**
+ * Time the motor outputs and log the average time of each call at the notice level: writing the
+ * motors one by one as the MotorHandler used to, the batched writes that replace it,
+ * MotorHandler::setMotorSpeeds with and without reversals and MotorHandler::setMotorCommands.
+ * The MotorHandler must be initialized, and the motors are left stopped. Runs the same on the
+ * host and the ESP32
+ *
+ * @param motorPins - The pins the MotorHandler was initialized with {Direction Pin, PWM Pin}
+ * @param iterations - The number of calls to time per stage
+ * @param now - The clock to time with
+ * @param unit - The name of the clock's unit for the log
+ */
+void runMotorBenchmarks(const std::array<std::array<uint8_t, 2>, 3> &motorPins,
+                        const uint32_t &iterations, BenchmarkClock now, const char *unit);
+
+#endif // MOTORBENCHMARKS_H
@@ -0,0 +1,20 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef QUATMATHBENCHMARKS_H
+#define QUATMATHBENCHMARKS_H
+
+#include "benchmarks/benchmark.h"
+
+/**
+ * Time the quatmath kernels against their helper_3dmath equivalents and log the average time of
+ * each call at the notice level. Runs the same on the host and the ESP32
+ *
+ * @param iterations - The number of calls to time per kernel
+ * @param now - The clock to time with
+ * @param unit - The name of the clock's unit for the log
+ */
+void runQuatMathBenchmarks(const uint32_t &iterations, BenchmarkClock now, const char *unit);
+
+#endif // QUATMATHBENCHMARKS_H
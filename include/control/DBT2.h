@@ -1,12 +1,13 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #ifndef DBT2_H
 #define DBT2_H
 
 #include <Arduino.h>
 #include"controlAlgoImpl.h"
+#include "control/sequencer.h"
 
 class DBT2 final : public ControlAlgoImpl {
 public:
@@ -18,6 +19,27 @@ public:
     // Default destructor
     ~DBT2() override = default;
 
+    /**
+     * Set the sequence DBT2 plays. Takes effect the next time DBT2 becomes the active algo. The
+     * table is not copied and must outlive DBT2's use of it
+     *
+     * @param steps - A ptr to the table of steps
+     * @param length - The number of steps in the table
+     * @param mode - What to do after the last step
+     */
+    static void setSequence(const SequenceStep *steps, const size_t &length, const SequenceMode
+    &mode) noexcept;
+
+    /**
+     * Start the sequence from its first step
+     */
+    void enter() override;
+
+    /**
+     * Stop the sequence and the motors
+     */
+    void exit() override;
+
     friend class Factory;   // For construction
 private:
     /**
@@ -29,14 +51,21 @@ private:
      * Set the target quaternion - does nothing for dbt2
      * @return target quaternion
      */
-    Quaternion setTargetQuaternion() override;
+    Quat setTargetQuaternion() override;
 
     /**
      * Arbitrarily control the motors to demonstrate movement capabilities. DBT2 does not
      * implement any actual feedback loop. The name just allows it to interface with the base
-     * class for easy execution
+     * class for easy execution. Each call advances the sequence by elapsed time and never blocks,
+     * and commands the motors so they ramp to the step's speeds
      */
     void PID() override;
+
+    // Member variables
+    Sequencer sequencer;    // Plays the demonstration sequence
+    static const SequenceStep *sequence;  // The table of steps to play
+    static size_t sequenceLength;   // The number of steps in the table
+    static SequenceMode sequenceMode;   // What to do after the last step
 };
 
-#endif // DBT2_H
\ No newline at end of file
+#endif // DBT2_H
@@ -0,0 +1,50 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef ATTITUDE_H
+#define ATTITUDE_H
+
+#include <cstddef>
+#include "control/quatmath.h"
+#include "mechanism/imuSample.h"
+
+/*
+ * Attitude Control
+ *
+ * Turns orientations into body-frame angular velocities: the velocity to command from the error
+ * between the measured orientation and the setpoint, and the velocity measured by the IMU
+ */
+
+/**
+ * Get the body-frame angular velocity that drives the orientation to the setpoint. It is the
+ * rotation vector of the error scaled by the gain, plus the setpoint's own angular velocity as a
+ * feed-forward so a moving setpoint is tracked without a steady lag. The result is limited to
+ * maxSpeed
+ *
+ * @param current - The measured orientation
+ * @param setpoint - The setpoint for this tick
+ * @param previousSetpoint - The setpoint of the previous tick
+ * @param period - The time between the two setpoints in s (0 disables the feed-forward)
+ * @param gain - The proportional gain in 1/s
+ * @param maxSpeed - The largest angular speed to command in rad/s
+ * @return The angular velocity in rad/s
+ */
+Vec3 commandAngularVelocity(const Quat &current, const Quat &setpoint, const Quat &previousSetpoint,
+                            const float &period, const float &gain, const float &maxSpeed)
+                            noexcept;
+
+/**
+ * Estimate the body-frame angular velocity by differentiating the newest IMU sample against the
+ * oldest of the given samples, using the server's timestamps so BLE latency and batching do not
+ * distort the interval
+ *
+ * @param samples - The IMU samples (newest first)
+ * @param count - The number of samples
+ * @param velocity - Set to the angular velocity in rad/s if it could be estimated
+ * @return True if there were two samples with distinct timestamps
+ */
+bool estimateAngularVelocity(const IMUSample *samples, const size_t &count, Vec3 &velocity)
+noexcept;
+
+#endif // ATTITUDE_H
@@ -1,6 +1,6 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #ifndef CONTROLALGO_H
 #define CONTROLALGO_H
@@ -10,7 +10,8 @@
 #include <memory>
 
 /**
- * Lhs of the ControlAlgo bridge
+ * Lhs of the ControlAlgo bridge. The bridge does not own the rhs - the Factory keeps each
+ * ControlAlgoImpl alive for the lifetime of the program
  */
 class ControlAlgo {
 public:
@@ -24,11 +25,21 @@ public:
     ControlAlgo(ControlAlgo &&) noexcept = default;
     ControlAlgo &operator=(ControlAlgo &&) noexcept = default;
 
-    // Destructor
-    ~ControlAlgo();
+    // Default destructor
+    ~ControlAlgo() = default;
 
     void execute() const;
 
+    /**
+     * Called when the control algo becomes the active algo
+     */
+    void enter() const;
+
+    /**
+     * Called when the control algo stops being the active algo
+     */
+    void exit() const;
+
     friend class Factory;
 
 private:
@@ -84,7 +95,6 @@ private:
 
 
 
-
 
 
 /**
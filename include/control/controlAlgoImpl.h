@@ -1,16 +1,19 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #ifndef CONTROLALGOIMPL_H
 #define CONTROLALGOIMPL_H
 
 #include <Arduino.h>
-#include <ArduinoLog.h>
-//#include "control/quaternion.h"
-#include "mechanism/clientHandler.h"
+#include "logging/deferredLog.h"
+#include "control/attitude.h"
+#include "control/kinematics.h"
+#include "control/quatmath.h"
+#include "control/velocityController.h"
+#include "hal/imuSource.h"
+#include "mechanism/encoderHandler.h"
 #include "mechanism/motorHandler.h"
-#include "../lib/MPU6050/helper_3dmath.h"
 
 /**
  * Abstract base class for rhs of ControlAlgo bridge
@@ -30,23 +33,107 @@ public:
      */
     void execute();
 
+    /**
+     * Called by the Factory when this algo becomes the active algo. Resets the per-run state
+     * (e.g. interpolation progress) while keeping state that should carry over between runs
+     */
+    virtual void enter();
+
+    /**
+     * Called by the Factory when this algo stops being the active algo
+     */
+    virtual void exit();
+
+    /**
+     * Set the fastest the setpoint may rotate toward the target. Applies to every algo
+     *
+     * @param speed - The maximum angular speed in rad/s (must be positive)
+     */
+    static void setMaxAngularSpeed(const float &speed);
+
+    /**
+     * Set how strongly an orientation error is turned into an angular velocity command. Applies
+     * to every algo
+     *
+     * @param gain - The proportional gain in 1/s (must be positive)
+     */
+    static void setAttitudeGain(const float &gain);
+
+    /**
+     * Set the geometry of the drive, precomputing its kinematics. Applies to every algo
+     *
+     * @param geometry - The drive's geometry (must be able to turn about every axis)
+     */
+    static void setDriveGeometry(const DriveGeometry &geometry);
+
+    /**
+     * Set the gains of the wheels' velocity loops. Takes effect on the next tick. Applies to every
+     * algo
+     *
+     * @param gains - The gains (must not be negative)
+     */
+    static void setVelocityGains(const VelocityGains &gains);
+
+protected:
+    /**
+     * Measure the speed of each wheel from the EncoderHandler's latest sample
+     *
+     * @return The speed of each wheel in rad/s
+     */
+    static std::array<float, 3> measureWheelSpeeds() noexcept;
+
 private:
-    virtual Quaternion setTargetQuaternion() = 0;
-    Quaternion setCurrentQuaternion();
+    static constexpr float COMMAND_HEADROOM = 2.0f; // The command's limit over maxAngularSpeed
+
+
+    virtual Quat setTargetQuaternion() = 0;
+    Quat setCurrentQuaternion();
+
+    /**
+     * Move the setpoint toward the target by at most the maximum angular speed times the time
+     * since the last tick, along the shortest arc. The setpoint starts at the current orientation
+     * when the algo is entered, so the eye never jumps to a new target
+     *
+     * @return The setpoint for this tick
+     */
+    Quat slerp();
 
     /**
-     * https://en.wikipedia.org/wiki/Slerp
-     * @return
+     * Compute the body-frame angular velocity command from the error between the current
+     * orientation and the setpoint, with the setpoint's motion as a feed-forward
      */
-    Quaternion slerp();
     void calculateAngularVelocity();
+
+    /**
+     * Convert the angular velocity command into the wheel speed each motor must turn at. The
+     * command is in the eyeball's frame and the wheels are fixed in the housing, so it is first
+     * rotated by the current orientation
+     */
     void applyInverseKinematics();
+
+    /**
+     * Drive each wheel at its commanded speed. The wheel speeds are measured by the
+     * EncoderHandler's latest sample, and each wheel's velocity loop sets its motor's command.
+     * When the MotorHandler clips, slews or current limits a command, that wheel's integrator
+     * stops winding up
+     */
     virtual void PID();
 
     // Member variables
-    Quaternion targetQuat;  // The desired quaternion orientation
-    Quaternion currentQuat; // Current quaternion orientation
-    static float initialDistance;
+    Quat targetQuat = QUAT_IDENTITY;    // The desired quaternion orientation
+    Quat currentQuat = QUAT_IDENTITY;   // Current quaternion orientation
+    Quat setpointQuat = QUAT_IDENTITY;  // The interpolated orientation to move to this tick
+    Quat previousSetpoint = QUAT_IDENTITY;  // The setpoint of the previous tick
+    bool setpointValid = false; // If the setpoint has been started from the current orientation
+    uint32_t lastTick = 0;  // When the setpoint was last moved in µs
+    float tickPeriod = 0.0f;    // The time between the last two setpoints in s
+    Vec3 angularVelocityCommand = {};   // The body-frame angular velocity to drive in rad/s
+    Vec3 wheelSpeedCommand = {};    // The speed each wheel should turn at in rad/s
+    std::array<VelocityController, 3> velocityControllers;  // Each wheel's velocity loop
+    static float maxAngularSpeed;   // The fastest the setpoint may rotate in rad/s
+    static float attitudeGain;  // The proportional gain from orientation error in 1/s
+    static Kinematics kinematics;   // The drive's kinematics
+    static VelocityGains velocityGains; // The gains of the wheels' velocity loops
 };
 
 #endif // CONTROLALGOIMPL_H
\ No newline at end of file
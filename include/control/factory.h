@@ -1,14 +1,13 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #ifndef FACTORY_H
 #define FACTORY_H
 
-//#define DISABLE_LOGGING
-
 #include <Arduino.h>
-#include <ArduinoLog.h>
+#include "logging/deferredLog.h"
+#include <type_traits>
 #include "controlAlgo.h"
 #include "control/DBT2.h"
 #include "control/pathFollowing.h"
@@ -16,12 +15,25 @@
 #include "control/sentient.h"
 
 /**
- * Factory for choosing controlAlgos from switch input
+ * The control algos that can be selected by the switches
+ */
+enum class ControlMode : uint8_t {
+    None,
+    DBT2,
+    PathFollowing,
+    Joystick,
+    Sentient
+};
+
+/**
+ * Factory for choosing controlAlgos from switch input. Each control algo is constructed once into
+ * static storage the first time it is selected and then reused, so switching modes never touches
+ * the heap and each algo keeps its state between runs
  */
  class Factory {
  public:
-     // Default constructor and destructor
-     Factory() = default;
+     // Primary constructor and default destructor
+     Factory();
      ~Factory() = default;
 
      // Delete copy-constructor and assignment-op
@@ -29,14 +41,31 @@
      Factory &operator=(const Factory&) = delete;
 
      /**
-      * Main factory method that parses switch inputs to create control algos
+      * Main factory method that parses switch inputs to select the active control algo. The
+      * active algo is only swapped (calling its exit and the new algo's enter hooks) when the
+      * selected mode changes
       *
-      * @param switchInput - The switch inputs
-      * @return The control algo
+      * @param switchInput - The debounced switch inputs
+      * @return The active control algo
       */
-     ControlAlgo makeControlAlgo(const std::array<uint8_t, 3> &switchInput);
+     ControlAlgo &makeControlAlgo(const std::array<uint8_t, 3> &switchInput);
+
+     /**
+      * Get the mode of the active control algo
+      *
+      * @return The active mode
+      */
+     ControlMode getMode() const noexcept;
 
  private:
+     /**
+      * Parse the switch inputs into a control mode
+      *
+      * @param switchInput - The switch inputs
+      * @return The selected mode
+      */
+     static ControlMode parseSwitchInput(const std::array<uint8_t, 3> &switchInput) noexcept;
+
      /**
       * Make a DBT2 control algo
       * @return - The control algo
@@ -60,6 +89,31 @@
       * @return - The control algo
       */
      ControlAlgo makeSentient();
+
+     /**
+      * Construct a control algo into its static storage if it has not been constructed yet
+      *
+      * @param instance - The ptr to the constructed algo (nullptr if not yet constructed)
+      * @param storage - The static storage for the algo
+      * @return The constructed algo
+      */
+     template<typename T>
+     static T *construct(T *&instance, void *storage);
+
+     // Member Variables
+     ControlMode mode;   // The mode of the active control algo
+     ControlAlgo active; // The active control algo
+
+     // Static storage for each control algo
+     static std::aligned_storage<sizeof(DBT2), alignof(DBT2)>::type dbt2Storage;
+     static std::aligned_storage<sizeof(PathFollowing), alignof(PathFollowing)>::type
+             pathFollowingStorage;
+     static std::aligned_storage<sizeof(Joystick), alignof(Joystick)>::type joystickStorage;
+     static std::aligned_storage<sizeof(Sentient), alignof(Sentient)>::type sentientStorage;
+     static DBT2 *dbt2;
+     static PathFollowing *pathFollowing;
+     static Joystick *joystick;
+     static Sentient *sentient;
  };
 
-#endif // FACTORY_H
\ No newline at end of file
+#endif // FACTORY_H
@@ -1,6 +1,6 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/27/2024
+// Last Modified: 10/16/2026
 
 #ifndef JOYSTICK_H
 #define JOYSTICK_H
@@ -29,7 +29,7 @@ private:
      */
     Joystick();
 
-    Quaternion setTargetQuaternion() override;
+    Quat setTargetQuaternion() override;
 };
 
 #endif // JOYSTICK_H
\ No newline at end of file
@@ -0,0 +1,208 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef KINEMATICS_H
+#define KINEMATICS_H
+
+#include "control/quatmath.h"
+
+/**
+ * A 3x3 matrix stored by rows
+ */
+struct Mat3 {
+    Vec3 row0;
+    Vec3 row1;
+    Vec3 row2;
+};
+
+/**
+ * Where a wheel touches the eyeball and which way it drives it
+ */
+struct WheelContact {
+    Vec3 contact;   // The unit vector from the eyeball's center to the contact point
+    Vec3 drive; // The unit direction the wheel's rim moves at the contact when turning forward
+};
+
+/**
+ * The geometry of the three-wheel drive, in the housing's frame
+ */
+struct DriveGeometry {
+    WheelContact wheels[3]; // The contact of each motor's wheel
+    float sphereRadius; // The eyeball's radius in m
+    float wheelRadius;  // The wheels' radius in m
+    float countsPerRevolution;  // The encoder counts per wheel revolution (CPR x gear ratio)
+};
+
+/**
+ * The drive as built: wheels 120° apart touching 45° below the equator and driving around the
+ * vertical axis, 24 mm wheels under a 50 mm eyeball, and the 48 CPR encoder on the 34:1 gearmotor
+ */
+constexpr DriveGeometry DEFAULT_DRIVE = {
+        {{{0.70710678f, 0.0f, -0.70710678f}, {0.0f, 1.0f, 0.0f}},
+         {{-0.35355339f, 0.61237244f, -0.70710678f}, {-0.8660254f, -0.5f, 0.0f}},
+         {{-0.35355339f, -0.61237244f, -0.70710678f}, {0.8660254f, -0.5f, 0.0f}}},
+        0.05f, 0.024f, 48.0f * 34.0f};
+
+//================================================================================================//
+// Matrix Operations
+
+/**
+ * Get m v
+ */
+constexpr Vec3 matMultiply(const Mat3 &m, const Vec3 &v) noexcept {
+    return {vecDot(m.row0, v), vecDot(m.row1, v), vecDot(m.row2, v)};
+}
+
+/**
+ * Get the transpose
+ */
+constexpr Mat3 matTranspose(const Mat3 &m) noexcept {
+    return {{m.row0.x, m.row1.x, m.row2.x}, {m.row0.y, m.row1.y, m.row2.y},
+            {m.row0.z, m.row1.z, m.row2.z}};
+}
+
+/**
+ * Get the determinant
+ */
+constexpr float matDeterminant(const Mat3 &m) noexcept {
+    return vecDot(m.row0, vecCross(m.row1, m.row2));
+}
+
+/**
+ * Get the inverse by cofactors. The columns of the inverse are the cross products of pairs of
+ * rows over the determinant. The matrix must not be singular
+ */
+constexpr Mat3 matInverse(const Mat3 &m) noexcept {
+    return matTranspose({vecScale(vecCross(m.row1, m.row2), 1.0f / matDeterminant(m)),
+                         vecScale(vecCross(m.row2, m.row0), 1.0f / matDeterminant(m)),
+                         vecScale(vecCross(m.row0, m.row1), 1.0f / matDeterminant(m))});
+}
+
+//================================================================================================//
+
+/**
+ * The kinematics of the three-wheel drive. A wheel's rim moves with the eyeball's surface at the
+ * contact point, so for an angular velocity ω (in the housing's frame) wheel i turns at
+ * (R / r) (c_i x d_i) . ω, where c_i is the contact, d_i the drive direction, R the eyeball's
+ * radius and r the wheel's radius. These rows form the Jacobian. It and its inverse are computed
+ * once (at compile time for a constexpr geometry), so each conversion is one 3x3 multiply
+ */
+class Kinematics {
+public:
+    /**
+     * Primary constructor
+     *
+     * @param geometry - The drive's geometry. Check isValid() before use
+     */
+    constexpr explicit Kinematics(const DriveGeometry &geometry) noexcept
+            : jacobian(buildJacobian(geometry)), inverseJacobian(matInverse(jacobian)),
+              radiansPerCount(2.0f * static_cast<float>(M_PI) / geometry.countsPerRevolution) {}
+
+    /**
+     * Inverse kinematics: the wheel speeds that turn the eyeball at an angular velocity
+     *
+     * @param angularVelocity - The angular velocity in the housing's frame in rad/s
+     * @return The speed of each wheel in rad/s
+     */
+    constexpr Vec3 inverse(const Vec3 &angularVelocity) const noexcept {
+        return matMultiply(jacobian, angularVelocity);
+    }
+
+    /**
+     * Forward kinematics: the eyeball's angular velocity from its wheel speeds
+     *
+     * @param wheelSpeeds - The speed of each wheel in rad/s
+     * @return The angular velocity in the housing's frame in rad/s
+     */
+    constexpr Vec3 forward(const Vec3 &wheelSpeeds) const noexcept {
+        return matMultiply(inverseJacobian, wheelSpeeds);
+    }
+
+    /**
+     * Forward kinematics from encoder rates, for odometry
+     *
+     * @param countRates - The rate of each wheel's encoder in counts/s
+     * @return The angular velocity in the housing's frame in rad/s
+     */
+    constexpr Vec3 forwardFromCounts(const Vec3 &countRates) const noexcept {
+        return forward(vecScale(countRates, radiansPerCount));
+    }
+
+    /**
+     * Check the geometry can turn the eyeball about every axis (the Jacobian is not singular)
+     *
+     * @return True if the geometry is usable
+     */
+    constexpr bool isValid() const noexcept {
+        return matDeterminant(jacobian) > 1.0e-3f || matDeterminant(jacobian) < -1.0e-3f;
+    }
+
+    /**
+     * Get the Jacobian from angular velocity to wheel speeds
+     *
+     * @return The Jacobian
+     */
+    constexpr const Mat3 &getJacobian() const noexcept {
+        return jacobian;
+    }
+
+    /**
+     * Get the wheel angle of one encoder count
+     *
+     * @return The angle in rad
+     */
+    constexpr float getRadiansPerCount() const noexcept {
+        return radiansPerCount;
+    }
+
+private:
+    /**
+     * Build a Jacobian row: (R / r) (c x d)
+     */
+    static constexpr Vec3 buildRow(const WheelContact &wheel, const float &ratio) noexcept {
+        return vecScale(vecCross(wheel.contact, wheel.drive), ratio);
+    }
+
+    /**
+     * Build the Jacobian from the geometry
+     */
+    static constexpr Mat3 buildJacobian(const DriveGeometry &geometry) noexcept {
+        return {buildRow(geometry.wheels[0], geometry.sphereRadius / geometry.wheelRadius),
+                buildRow(geometry.wheels[1], geometry.sphereRadius / geometry.wheelRadius),
+                buildRow(geometry.wheels[2], geometry.sphereRadius / geometry.wheelRadius)};
+    }
+
+    // Member variables
+    Mat3 jacobian;  // Angular velocity to wheel speeds
+    Mat3 inverseJacobian;   // Wheel speeds to angular velocity
+    float radiansPerCount;  // The wheel angle of one encoder count
+};
+
+/**
+ * Get the squared length of a vector
+ */
+constexpr float vecLengthSquared(const Vec3 &v) noexcept {
+    return vecDot(v, v);
+}
+
+/**
+ * Get the squared distance between forward(inverse(ω)) and ω
+ */
+constexpr float roundTripError(const Kinematics &kinematics, const Vec3 &angularVelocity)
+noexcept {
+    return vecLengthSquared(vecAdd(kinematics.forward(kinematics.inverse(angularVelocity)),
+                                   vecScale(angularVelocity, -1.0f)));
+}
+
+// Check the default drive at compile time: it must reach every axis, and the forward kinematics
+// must undo the inverse kinematics
+constexpr Kinematics DEFAULT_KINEMATICS(DEFAULT_DRIVE);
+static_assert(DEFAULT_KINEMATICS.isValid(), "The default drive cannot turn about every axis");
+static_assert(roundTripError(DEFAULT_KINEMATICS, {1.0f, 0.0f, 0.0f}) < 1.0e-10f &&
+              roundTripError(DEFAULT_KINEMATICS, {0.0f, 1.0f, 0.0f}) < 1.0e-10f &&
+              roundTripError(DEFAULT_KINEMATICS, {0.0f, 0.0f, 1.0f}) < 1.0e-10f &&
+              roundTripError(DEFAULT_KINEMATICS, {-2.0f, 3.5f, 0.25f}) < 1.0e-8f,
+              "forward(inverse(ω)) must equal ω");
+
+#endif // KINEMATICS_H
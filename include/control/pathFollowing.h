@@ -1,6 +1,6 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/27/2024
+// Last Modified: 10/16/2026
 
 #ifndef PATHFOLLOWING_H
 #define PATHFOLLOWING_H
@@ -28,7 +28,7 @@ private:
      */
     PathFollowing();
 
-    Quaternion setTargetQuaternion() override;
+    Quat setTargetQuaternion() override;
 };
 
 #endif // PATHFOLLOWING_H
\ No newline at end of file
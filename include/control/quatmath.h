@@ -0,0 +1,411 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef QUATMATH_H
+#define QUATMATH_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "../lib/MPU6050/helper_3dmath.h"
+
+/*
+ * Quaternion Math
+ *
+ * Single-precision quaternion and vector operations for the control loop. Everything is inline and
+ * works on plain aggregates, so results are built in place rather than returned through
+ * helper_3dmath's by-value member functions, and the pure arithmetic is constexpr. The ESP32's FPU
+ * has no divide or square root instruction, so normalization uses a fast inverse square root
+ * instead of sqrt and a divide. Quaternions are {w, x, y, z} and unit length unless noted
+ */
+
+/**
+ * A quaternion
+ */
+struct Quat {
+    float w;
+    float x;
+    float y;
+    float z;
+};
+
+/**
+ * A 3D vector
+ */
+struct Vec3 {
+    float x;
+    float y;
+    float z;
+};
+
+constexpr Quat QUAT_IDENTITY = {1.0f, 0.0f, 0.0f, 0.0f};  // The identity rotation
+constexpr float SMALL_ANGLE_THRESHOLD = 0.9995f;    // cos(θ/2) above which θ is small (~3.6°)
+
+//================================================================================================//
+// Conversions
+
+/**
+ * Convert from helper_3dmath
+ *
+ * @param q - The quaternion
+ * @return The quaternion
+ */
+inline Quat toQuat(const Quaternion &q) noexcept {
+    return {q.w, q.x, q.y, q.z};
+}
+
+/**
+ * Convert to helper_3dmath
+ *
+ * @param q - The quaternion
+ * @return The quaternion
+ */
+inline Quaternion toQuaternion(const Quat &q) noexcept {
+    return {q.w, q.x, q.y, q.z};
+}
+
+//================================================================================================//
+// Vector Operations
+
+/**
+ * Get a + b
+ */
+constexpr Vec3 vecAdd(const Vec3 &a, const Vec3 &b) noexcept {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+/**
+ * Get v * s
+ */
+constexpr Vec3 vecScale(const Vec3 &v, const float &s) noexcept {
+    return {v.x * s, v.y * s, v.z * s};
+}
+
+/**
+ * Get the dot product a . b
+ */
+constexpr float vecDot(const Vec3 &a, const Vec3 &b) noexcept {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/**
+ * Get the cross product a x b
+ */
+constexpr Vec3 vecCross(const Vec3 &a, const Vec3 &b) noexcept {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+//================================================================================================//
+// Quaternion Arithmetic
+
+/**
+ * Get a + b (not a rotation composition)
+ */
+constexpr Quat quatAdd(const Quat &a, const Quat &b) noexcept {
+    return {a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z};
+}
+
+/**
+ * Get q * s
+ */
+constexpr Quat quatScale(const Quat &q, const float &s) noexcept {
+    return {q.w * s, q.x * s, q.y * s, q.z * s};
+}
+
+/**
+ * Get -q (the same rotation)
+ */
+constexpr Quat quatNegate(const Quat &q) noexcept {
+    return {-q.w, -q.x, -q.y, -q.z};
+}
+
+/**
+ * Get the conjugate (the inverse rotation of a unit quaternion)
+ */
+constexpr Quat quatConjugate(const Quat &q) noexcept {
+    return {q.w, -q.x, -q.y, -q.z};
+}
+
+/**
+ * Get the 4D dot product a . b (cos(θ/2) between unit quaternions)
+ */
+constexpr float quatDot(const Quat &a, const Quat &b) noexcept {
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/**
+ * Get the squared length
+ */
+constexpr float quatNormSquared(const Quat &q) noexcept {
+    return quatDot(q, q);
+}
+
+/**
+ * Get the vector part of a quaternion
+ */
+constexpr Vec3 quatVector(const Quat &q) noexcept {
+    return {q.x, q.y, q.z};
+}
+
+/**
+ * Get the Hamilton product a * b (b's rotation followed by a's)
+ */
+constexpr Quat quatMultiply(const Quat &a, const Quat &b) noexcept {
+    return {a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+            a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+            a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+            a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w};
+}
+
+/**
+ * Get conj(a) * b without forming the conjugate
+ */
+constexpr Quat quatMultiplyConjugate(const Quat &a, const Quat &b) noexcept {
+    return {a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z,
+            a.w * b.x - a.x * b.w - a.y * b.z + a.z * b.y,
+            a.w * b.y + a.x * b.z - a.y * b.w - a.z * b.x,
+            a.w * b.z - a.x * b.y + a.y * b.x - a.z * b.w};
+}
+
+/**
+ * Finish quatRotate() given t = 2 (u x v)
+ */
+constexpr Vec3 quatRotateWith(const Quat &q, const Vec3 &v, const Vec3 &t) noexcept {
+    return vecAdd(vecAdd(v, vecScale(t, q.w)), vecCross(quatVector(q), t));
+}
+
+/**
+ * Rotate a vector by a unit quaternion without forming q * v * conj(q). Uses
+ * v' = v + w t + u x t where t = 2 (u x v) and u is the vector part (15 multiplies instead of 28)
+ *
+ * @param q - The rotation
+ * @param v - The vector
+ * @return The rotated vector
+ */
+constexpr Vec3 quatRotate(const Quat &q, const Vec3 &v) noexcept {
+    return quatRotateWith(q, v, vecScale(vecCross(quatVector(q), v), 2.0f));
+}
+
+//================================================================================================//
+// Normalization
+
+/**
+ * Approximate 1 / sqrt(x) with the bit-level initial guess and two Newton iterations (relative
+ * error below 5e-6). x must be positive
+ *
+ * @param x - The value
+ * @return The approximate inverse square root
+ */
+inline float fastInverseSqrt(const float &x) noexcept {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    bits = 0x5F375A86 - (bits >> 1);
+    float y;
+    std::memcpy(&y, &bits, sizeof(y));
+
+    float half = 0.5f * x;
+    y = y * (1.5f - half * y * y);
+    return y * (1.5f - half * y * y);
+}
+
+/**
+ * Normalize a quaternion of any non-zero length
+ *
+ * @param q - The quaternion
+ * @return The unit quaternion
+ */
+inline Quat quatNormalize(const Quat &q) noexcept {
+    return quatScale(q, fastInverseSqrt(quatNormSquared(q)));
+}
+
+/**
+ * Pull a nearly unit quaternion (e.g. after a product or a small step has let its length drift)
+ * back to unit length with one Newton step from 1: 1 / sqrt(n) ≈ (3 - n) / 2. The error is about
+ * 3/8 of the squared drift, so it is only for lengths within a few percent of 1
+ *
+ * @param q - The nearly unit quaternion
+ * @return The renormalized quaternion
+ */
+constexpr Quat quatRenormalize(const Quat &q) noexcept {
+    return quatScale(q, 0.5f * (3.0f - quatNormSquared(q)));
+}
+
+//================================================================================================//
+// Angles and Errors
+
+/**
+ * Make a quaternion's scalar part non-negative, so it takes the shorter of its two rotations
+ */
+constexpr Quat quatShortest(const Quat &q) noexcept {
+    return q.w < 0.0f ? quatNegate(q) : q;
+}
+
+/**
+ * Get the rotation from one orientation to another, expressed in the first's (body) frame:
+ * conj(from) * to, taking the shorter path
+ *
+ * @param from - The orientation to rotate from
+ * @param to - The orientation to rotate to
+ * @return The error rotation
+ */
+constexpr Quat quatError(const Quat &from, const Quat &to) noexcept {
+    return quatShortest(quatMultiplyConjugate(from, to));
+}
+
+/**
+ * Get the rotation vector (axis * angle) of a shortest-path error rotation by the small-angle
+ * approximation 2 * u. The magnitude is 2 sin(θ/2), which is within 0.1% of θ below 6°
+ *
+ * @param error - The error rotation (w >= 0)
+ * @return The rotation vector in rad
+ */
+constexpr Vec3 quatSmallAngleVector(const Quat &error) noexcept {
+    return vecScale(quatVector(error), 2.0f);
+}
+
+/**
+ * Get the rotation vector (axis * angle) of a shortest-path error rotation by the log map. Falls
+ * back to quatSmallAngleVector() when the angle is small, which skips the atan2
+ *
+ * @param error - The error rotation (w >= 0)
+ * @return The rotation vector in rad
+ */
+inline Vec3 quatLog(const Quat &error) noexcept {
+    if (error.w > SMALL_ANGLE_THRESHOLD) {
+        return quatSmallAngleVector(error);
+    }
+
+    float sinHalf = sqrtf(vecDot(quatVector(error), quatVector(error)));
+    return vecScale(quatVector(error), 2.0f * atan2f(sinHalf, error.w) / sinHalf);
+}
+
+/**
+ * Get the body-frame rotation vector that takes one orientation to another
+ *
+ * @param from - The orientation to rotate from
+ * @param to - The orientation to rotate to
+ * @return The rotation vector in rad
+ */
+inline Vec3 quatAngularError(const Quat &from, const Quat &to) noexcept {
+    return quatLog(quatError(from, to));
+}
+
+/**
+ * Get the angle between two orientations
+ *
+ * @param a - The first orientation
+ * @param b - The second orientation
+ * @return The angle in rad (0 - π)
+ */
+inline float quatAngle(const Quat &a, const Quat &b) noexcept {
+    float cosHalf = fminf(fabsf(quatDot(a, b)), 1.0f);
+    if (cosHalf > SMALL_ANGLE_THRESHOLD) {
+        // cos(θ/2) ≈ 1 - θ²/8
+        return sqrtf(8.0f * (1.0f - cosHalf));
+    }
+
+    return 2.0f * acosf(cosHalf);
+}
+
+//================================================================================================//
+// Interpolation
+
+/**
+ * Normalized linear interpolation along the shorter path. Matches slerp closely for small angles
+ *
+ * @param from - The orientation at t = 0
+ * @param to - The orientation at t = 1
+ * @param t - The interpolation factor (0 - 1)
+ * @return The interpolated orientation
+ */
+inline Quat quatNlerp(const Quat &from, const Quat &to, const float &t) noexcept {
+    float sign = quatDot(from, to) < 0.0f ? -1.0f : 1.0f;
+    return quatNormalize(quatAdd(quatScale(from, 1.0f - t), quatScale(to, sign * t)));
+}
+
+/**
+ * Spherical linear interpolation along the shorter path. Uses nlerp for small angles
+ * https://en.wikipedia.org/wiki/Slerp
+ *
+ * @param from - The orientation at t = 0
+ * @param to - The orientation at t = 1
+ * @param t - The interpolation factor (0 - 1)
+ * @return The interpolated orientation
+ */
+inline Quat quatSlerp(const Quat &from, const Quat &to, const float &t) noexcept {
+    float cosHalf = quatDot(from, to);
+    float sign = cosHalf < 0.0f ? -1.0f : 1.0f;
+    cosHalf = fabsf(cosHalf);
+    if (cosHalf > SMALL_ANGLE_THRESHOLD) {
+        return quatNlerp(from, to, t);
+    }
+
+    float half = acosf(cosHalf);
+    float inverseSin = 1.0f / sinf(half);
+    return quatNormalize(quatAdd(quatScale(from, sinf((1.0f - t) * half) * inverseSin),
+                                 quatScale(to, sign * sinf(t * half) * inverseSin)));
+}
+
+/**
+ * Rotate an orientation toward a target by at most an angle along the shorter path. When the
+ * step would overshoot the target is returned. The angle is estimated without trig when small
+ *
+ * @param from - The orientation to move
+ * @param to - The target orientation
+ * @param maxAngle - The largest rotation to apply in rad
+ * @return The new orientation
+ */
+inline Quat quatStep(const Quat &from, const Quat &to, const float &maxAngle) noexcept {
+    float angle = quatAngle(from, to);
+    if (angle <= maxAngle) {
+        return to;
+    }
+
+    return quatSlerp(from, to, maxAngle / angle);
+}
+
+//================================================================================================//
+// Batch Operations
+
+/**
+ * Multiply arrays of quaternions element-wise: out[i] = a[i] * b[i]. out may alias a or b
+ */
+inline void quatMultiplyBatch(const Quat *a, const Quat *b, Quat *out, const size_t &count)
+noexcept {
+    for (size_t i(0); i < count; ++i) {
+        out[i] = quatMultiply(a[i], b[i]);
+    }
+}
+
+/**
+ * Normalize an array of quaternions in place
+ */
+inline void quatNormalizeBatch(Quat *q, const size_t &count) noexcept {
+    for (size_t i(0); i < count; ++i) {
+        q[i] = quatNormalize(q[i]);
+    }
+}
+
+/**
+ * Rotate an array of vectors by one quaternion: out[i] = q v[i] conj(q). out may alias v
+ */
+inline void quatRotateBatch(const Quat &q, const Vec3 *v, Vec3 *out, const size_t &count)
+noexcept {
+    for (size_t i(0); i < count; ++i) {
+        out[i] = quatRotate(q, v[i]);
+    }
+}
+
+/**
+ * Get the body-frame rotation vectors from an array of orientations to one target
+ */
+inline void quatAngularErrorBatch(const Quat *from, const Quat &to, Vec3 *out,
+                                  const size_t &count) noexcept {
+    for (size_t i(0); i < count; ++i) {
+        out[i] = quatAngularError(from[i], to);
+    }
+}
+
+#endif // QUATMATH_H
@@ -0,0 +1,108 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstdint>
+#include "logging/deferredLog.h"
+
+/**
+ * Timing statistics gathered by the scheduler. All times are in µs
+ */
+struct SchedulerStatistics {
+    uint32_t ticks; // The number of ticks executed
+    uint32_t deadlineMisses;    // The number of ticks that were late or overran their period
+    uint32_t worstJitter;   // The largest deviation of a tick interval from the period
+    uint32_t worstExecutionTime;    // The longest time spent in the callback
+    uint32_t lastExecutionTime; // The time spent in the callback on the last tick
+};
+
+/**
+ * A class to run the control loop at a fixed rate. The tick timer (see hal/tickTimer.h) wakes the
+ * scheduler's task every period, which then executes the callback and records deadline misses and
+ * jitter. The timing bookkeeping lives in tick() so any tick source (e.g. a simulated one) can
+ * drive it
+ */
+class Scheduler {
+public:
+    using Callback = void (*)();    // The function executed every tick
+
+    // Delete copy-constructor and assignment-op
+    Scheduler(const Scheduler &) = delete;
+
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    // Destructor
+    ~Scheduler() noexcept;
+
+    /**
+     * Get the singleton Scheduler instance
+     *
+     * @return The instance ptr
+     */
+    static Scheduler *instance();
+
+    /**
+     * Initialize the Scheduler by setting its rate and callback
+     *
+     * @param RATE - The rate at which to execute the callback in Hz
+     * @param TIMER - The hardware timer number to use (0 - 3)
+     * @param callback - The function to execute every tick
+     */
+    void initialize(const uint32_t &RATE, const uint8_t &TIMER, Callback callback);
+
+    /**
+     * Execute a single tick. Measures the tick's jitter, runs the callback and measures its
+     * execution time
+     *
+     * @param now - The time of the tick in µs
+     * @param pending - The number of ticks that have elapsed since the last call (>1 means
+     *                  ticks were missed)
+     */
+    void tick(const uint32_t &now, const uint32_t &pending = 1);
+
+    /**
+     * Get the timing statistics
+     *
+     * @return A copy of the statistics
+     */
+    SchedulerStatistics getStatistics() const noexcept;
+
+    /**
+     * Reset the timing statistics
+     */
+    void resetStatistics() noexcept;
+
+    /**
+     * Get the period of the scheduler
+     *
+     * @return The period in µs
+     */
+    uint32_t getPeriod() const noexcept;
+
+    /**
+     * Start the tick timer and continuously execute ticks as the timer fires. Must be run
+     * from the task that should execute the callback, after initialize()
+     */
+    [[noreturn]] void loop();
+
+private:
+    /**
+     * Primary Constructor
+     */
+    Scheduler() = default;
+
+    // Member variables
+    static Scheduler *inst; // Ptr to the singleton inst
+    static bool initialized;    // Initialization flag
+    uint8_t timerNumber = 0;    // The hardware timer number
+    Callback callback = nullptr;    // The function executed every tick
+    uint32_t period = 0;    // The period between ticks in µs
+    uint32_t lastTick = 0;  // The time of the previous tick in µs
+    bool firstTick = true;  // If there has not been a previous tick to measure from
+    SchedulerStatistics statistics = {};    // The timing statistics
+};
+
+#endif // SCHEDULER_H
@@ -0,0 +1,97 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef SEQUENCER_H
+#define SEQUENCER_H
+
+#include <Arduino.h>
+#include <array>
+
+/**
+ * A single step of a motor sequence
+ */
+struct SequenceStep {
+    std::array<float, 3> speeds;    // The motor speeds to hold during the step [-1, 1]
+    uint32_t duration;  // How long to hold the speeds in ms
+};
+
+/**
+ * How a sequence behaves once its last step finishes
+ */
+enum class SequenceMode : uint8_t {
+    Once,   // Stop the motors after the last step
+    Loop    // Restart from the first step
+};
+
+/**
+ * A non-blocking player for a table of motor steps. update() is called every control tick and
+ * advances through the steps by elapsed time, so the caller never has to wait on a step
+ */
+class Sequencer {
+public:
+    // Default constructor and destructor
+    Sequencer() = default;
+    ~Sequencer() = default;
+
+    // Delete copy-constructor and assignment-op
+    Sequencer(const Sequencer &) = delete;
+
+    Sequencer &operator=(const Sequencer &) = delete;
+
+    /**
+     * Load a sequence. The table is not copied and must outlive the sequencer's use of it
+     *
+     * @param steps - A ptr to the table of steps
+     * @param length - The number of steps in the table
+     * @param mode - What to do after the last step
+     */
+    void load(const SequenceStep *steps, const size_t &length, const SequenceMode &mode) noexcept;
+
+    /**
+     * Start the loaded sequence from its first step
+     *
+     * @param now - The current time in ms
+     */
+    void start(const uint32_t &now) noexcept;
+
+    /**
+     * Stop the sequence and zero the speeds
+     */
+    void stop() noexcept;
+
+    /**
+     * Advance the sequence to the step that should be active at the given time
+     *
+     * @param now - The current time in ms
+     * @return True if the speeds changed since the last call
+     */
+    bool update(const uint32_t &now) noexcept;
+
+    /**
+     * Get the speeds of the active step
+     *
+     * @return The speeds (all zero when stopped)
+     */
+    const std::array<float, 3> &getSpeeds() const noexcept;
+
+    /**
+     * Check if the sequence is running
+     *
+     * @return True if running
+     */
+    bool isRunning() const noexcept;
+
+private:
+    // Member variables
+    const SequenceStep *steps = nullptr;    // The table of steps
+    size_t length = 0;  // The number of steps in the table
+    SequenceMode mode = SequenceMode::Once; // What to do after the last step
+    size_t index = 0;   // The index of the active step
+    uint32_t stepStart = 0; // When the active step started in ms
+    bool running = false;   // If the sequence is running
+    bool changed = false;   // If the speeds changed since the last update
+    std::array<float, 3> speeds = {0, 0, 0};    // The speeds of the active step
+};
+
+#endif // SEQUENCER_H
@@ -0,0 +1,88 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef VELOCITYCONTROLLER_H
+#define VELOCITYCONTROLLER_H
+
+/**
+ * The gains of a wheel's velocity loop. The output is a fraction of the full duty cycle, so the
+ * gains do not depend on the PWM resolution
+ */
+struct VelocityGains {
+    float proportional; // The duty per rad/s of speed error in s/rad
+    float integral; // The duty per rad of accumulated speed error in 1/rad
+    float derivative;   // The duty per rad/s² of measured acceleration in s²/rad
+    float feedForward;  // The duty per rad/s of target speed in s/rad
+    float derivativeFilter; // The time constant of the derivative's low-pass filter in s
+};
+
+/**
+ * Gains tuned on the plant simulator for the Pololu 34:1 gearmotor at 12 V. The feed-forward is
+ * the inverse of the wheel's free speed (~30 rad/s), so the feedback only corrects what the
+ * friction and load take away. The derivative is off: at low speed the encoder's velocity is
+ * averaged over several edges, and differentiating it costs more than it damps
+ */
+constexpr VelocityGains DEFAULT_VELOCITY_GAINS = {0.1f, 4.0f, 0.0f, 0.033f, 0.01f};
+
+/**
+ * A PI-D velocity controller for one wheel. The proportional and integral terms act on the speed
+ * error and the derivative acts on the filtered measurement only, so a step in the target does
+ * not kick the output. The target's feed-forward carries most of the command.
+ *
+ * The output is not limited here. The motor driver limits it, and the applied duty is handed back
+ * with saturate() so the integrator stops winding up while the driver is saturated.
+ *
+ * Each update is a fixed number of float operations with no allocation, so a tick always takes
+ * the same time
+ */
+class VelocityController {
+public:
+    // Default constructor and destructor
+    VelocityController() = default;
+    ~VelocityController() = default;
+
+    /**
+     * Clear the integrator and the derivative's history, e.g. when the controller takes over a
+     * wheel that may already be turning
+     */
+    void reset() noexcept;
+
+    /**
+     * Compute the duty for this tick
+     *
+     * @param target - The wheel speed to reach in rad/s
+     * @param measured - The measured wheel speed in rad/s
+     * @param period - The time since the last update in s (0 skips the integral and derivative)
+     * @param gains - The gains to use
+     * @return The duty as a fraction of full scale (may exceed ±1 before the driver limits it)
+     */
+    float update(const float &target, const float &measured, const float &period,
+                 const VelocityGains &gains) noexcept;
+
+    /**
+     * Report that the driver clipped the last output. The last integration is undone if it pushed
+     * further into the limit (conditional integration), so the integrator holds instead of
+     * winding up while the wheel cannot go any faster
+     *
+     * @param applied - The duty the driver applied as a fraction of full scale
+     */
+    void saturate(const float &applied) noexcept;
+
+    /**
+     * Get the integrator's contribution to the output
+     *
+     * @return The duty from the integral term as a fraction of full scale
+     */
+    float getIntegral() const noexcept;
+
+private:
+    // Member variables
+    float integral = 0.0f;  // The integral term's output
+    float lastIncrement = 0.0f; // The integral term's change in the last update
+    float filteredMeasurement = 0.0f;   // The low-pass filtered measured speed in rad/s
+    float output = 0.0f;    // The last output
+    bool started = false;   // If the filter has been seeded with a measurement
+};
+
+#endif // VELOCITYCONTROLLER_H
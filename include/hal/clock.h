@@ -0,0 +1,39 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <cstdint>
+
+/*
+ * Clock HAL
+ *
+ * The time base of the mechanism. On the ESP32 these are the Arduino core's clock. On the host
+ * they run from the system's steady clock, or from a simulated clock (see hal/native/hostHAL.h)
+ * so runs are repeatable
+ */
+
+/**
+ * Get the time since startup
+ *
+ * @return The time in µs (wraps after ~71 minutes)
+ */
+uint32_t clockMicros();
+
+/**
+ * Get the time since startup
+ *
+ * @return The time in ms
+ */
+uint32_t clockMillis();
+
+/**
+ * Block the calling task
+ *
+ * @param ms - The time to block in ms
+ */
+void clockDelay(const uint32_t &ms);
+
+#endif // CLOCK_H
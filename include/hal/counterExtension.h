@@ -0,0 +1,81 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef COUNTEREXTENSION_H
+#define COUNTEREXTENSION_H
+
+#include <cstdint>
+
+// The PCNT's limit. The 16-bit counter resets to 0 when it reaches ±COUNTER_LIMIT, so it holds
+// the count modulo COUNTER_LIMIT. The reset only happens while the limit events are enabled
+constexpr int16_t COUNTER_LIMIT = 32767;
+
+// The most the counter can move between samples before its wraps become ambiguous
+constexpr int32_t COUNTER_MAX_STEP = COUNTER_LIMIT / 2;
+
+/**
+ * Extends a 16-bit PCNT counter to 64 bits in software. Each sample of the counter is compared
+ * with the last, and the difference is taken as the smallest movement that explains it (modulo
+ * COUNTER_LIMIT), so a wrap past either limit is just another step. No limit interrupt is needed
+ * at any speed, so no ISR updates the 64-bit count behind a reader's back.
+ *
+ * The counter must be sampled before it moves by more than COUNTER_MAX_STEP: ~2 s at the
+ * motors' top speed (~7900 counts/s), where the control loop samples every millisecond.
+ *
+ * Only the sampling task may call update() and write(). Other tasks read the extended count
+ * through the EncoderHandler's snapshots
+ */
+class CounterExtension {
+public:
+    // Default constructor and destructor
+    CounterExtension() = default;
+    ~CounterExtension() = default;
+
+    /**
+     * Extend a new sample of the counter
+     *
+     * @param raw - The counter's value
+     * @return The extended count
+     */
+    int64_t update(const int16_t &raw) noexcept {
+        // Reduce the difference into (-COUNTER_LIMIT / 2, COUNTER_LIMIT / 2]
+        int32_t step = (static_cast<int32_t>(raw) - lastRaw) % COUNTER_LIMIT;
+        if (step > COUNTER_MAX_STEP) {
+            step -= COUNTER_LIMIT;
+        } else if (step < -COUNTER_MAX_STEP) {
+            step += COUNTER_LIMIT;
+        }
+
+        lastRaw = raw;
+        extended += step;
+        return extended;
+    }
+
+    /**
+     * Set the extended count, e.g. after the counter was cleared
+     *
+     * @param count - The extended count
+     * @param raw - The counter's value at that count
+     */
+    void write(const int64_t &count, const int16_t &raw) noexcept {
+        extended = count;
+        lastRaw = raw;
+    }
+
+    /**
+     * Get the extended count as of the last sample
+     *
+     * @return The extended count
+     */
+    int64_t get() const noexcept {
+        return extended;
+    }
+
+private:
+    // Member variables
+    int64_t extended = 0;   // The extended count
+    int16_t lastRaw = 0;    // The counter's value at the last sample
+};
+
+#endif // COUNTEREXTENSION_H
@@ -0,0 +1,57 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef GPIO_H
+#define GPIO_H
+
+#include <cstdint>
+
+/*
+ * GPIO HAL
+ *
+ * Digital pins. On the host each pin is a stored level that the host HAL can read and set
+ */
+
+constexpr uint8_t GPIO_PIN_COUNT = 40;  // The number of GPIO pins (0 - 39)
+
+/**
+ * Configure a pin as an output
+ *
+ * @param pin - The GPIO pin
+ */
+void gpioOutput(const uint8_t &pin);
+
+/**
+ * Configure a pin as an input
+ *
+ * @param pin - The GPIO pin
+ * @param pullUp - If the internal pull-up should be enabled
+ */
+void gpioInput(const uint8_t &pin, const bool &pullUp);
+
+/**
+ * Set the level of an output pin
+ *
+ * @param pin - The GPIO pin
+ * @param level - True for high
+ */
+void gpioWrite(const uint8_t &pin, const bool &level);
+
+/**
+ * Set and clear several output pins at once, leaving the others as they are
+ *
+ * @param high - A mask of the pins to set high (bit n for pin n)
+ * @param low - A mask of the pins to set low
+ */
+void gpioWriteMask(const uint64_t &high, const uint64_t &low);
+
+/**
+ * Read the level of a pin
+ *
+ * @param pin - The GPIO pin
+ * @return True if high
+ */
+bool gpioRead(const uint8_t &pin);
+
+#endif // GPIO_H
@@ -0,0 +1,25 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef IMUSOURCE_H
+#define IMUSOURCE_H
+
+#include "mechanism/imuSample.h"
+
+/*
+ * IMU Sample Source HAL
+ *
+ * Where the control loop gets the eyeball's orientation. On the ESP32 the samples arrive over BLE
+ * through the ClientHandler. On the host they are published by the host HAL (e.g. from a
+ * simulation)
+ */
+
+/**
+ * Get the latest IMU sample for use by the controller. Should only be called by the control loop
+ *
+ * @return A consistent copy of the latest sample
+ */
+IMUSample consumeIMUSample();
+
+#endif // IMUSOURCE_H
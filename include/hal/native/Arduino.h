@@ -0,0 +1,101 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/*
+ * The subset of the Arduino core the control code and handlers use, implemented on the host HAL
+ * for the native environment. It is only on the include path of the native build
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include "hal/clock.h"
+#include "hal/gpio.h"
+
+#define IRAM_ATTR
+
+constexpr uint8_t LOW = 0;
+constexpr uint8_t HIGH = 1;
+constexpr uint8_t INPUT = 0x01;
+constexpr uint8_t OUTPUT = 0x03;
+constexpr uint8_t INPUT_PULLUP = 0x05;
+
+#ifndef PI
+#define PI 3.1415926535897932384626433832795
+#endif
+
+using std::abs;
+using std::max;
+using std::min;
+
+/**
+ * Limit a value to a range
+ */
+template<typename T, typename L, typename H>
+inline T constrain(const T &value, const L &low, const H &high) {
+    return value < low ? low : (value > high ? high : value);
+}
+
+inline uint32_t micros() {
+    return clockMicros();
+}
+
+inline uint32_t millis() {
+    return clockMillis();
+}
+
+inline void delay(const uint32_t &ms) {
+    clockDelay(ms);
+}
+
+inline void pinMode(const uint8_t &pin, const uint8_t &mode) {
+    if (mode == OUTPUT) {
+        gpioOutput(pin);
+    } else {
+        gpioInput(pin, mode == INPUT_PULLUP);
+    }
+}
+
+inline void digitalWrite(const uint8_t &pin, const uint8_t &level) {
+    gpioWrite(pin, level != LOW);
+}
+
+inline int digitalRead(const uint8_t &pin) {
+    return gpioRead(pin) ? HIGH : LOW;
+}
+
+inline long random(const long &max) {
+    return max > 0 ? std::rand() % max : 0;
+}
+
+inline long random(const long &min, const long &max) {
+    return min < max ? min + random(max - min) : min;
+}
+
+/**
+ * A stand-in for the Arduino Print class. Output on the host goes to stdout
+ */
+class Print {
+public:
+    virtual ~Print() = default;
+};
+
+/**
+ * A stand-in for the Arduino serial port
+ */
+class HardwareSerial : public Print {
+public:
+    void begin(const unsigned long &baud) {}
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H
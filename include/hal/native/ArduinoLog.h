@@ -0,0 +1,144 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef ARDUINOLOG_H
+#define ARDUINOLOG_H
+
+/*
+ * A host version of the ArduinoLog library for the native environment. It keeps the library's
+ * levels and format specifiers and writes to stdout. As with the library, defining
+ * DISABLE_LOGGING before it is first included removes all output
+ */
+
+#include <cstdarg>
+#include <cstdint>
+#include "Arduino.h"
+
+#define LOG_LEVEL_SILENT  0
+#define LOG_LEVEL_FATAL   1
+#define LOG_LEVEL_ERROR   2
+#define LOG_LEVEL_WARNING 3
+#define LOG_LEVEL_INFO    4
+#define LOG_LEVEL_NOTICE  4
+#define LOG_LEVEL_TRACE   5
+#define LOG_LEVEL_VERBOSE 6
+
+/**
+ * Logs formatted messages at a level
+ */
+class Logging {
+public:
+    /**
+     * Start logging
+     *
+     * @param level - The most detailed level to show
+     * @param output - Ignored on the host (output goes to stdout)
+     * @param showLevel - If each message is prefixed with its level
+     */
+    void begin(const int &level, Print *output, const bool &showLevel = true);
+
+    template<class... Args> void fatal(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_FATAL, false, msg, args...);
+        }
+    }
+
+    template<class... Args> void fatalln(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_FATAL, true, msg, args...);
+        }
+    }
+
+    template<class... Args> void error(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_ERROR, false, msg, args...);
+        }
+    }
+
+    template<class... Args> void errorln(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_ERROR, true, msg, args...);
+        }
+    }
+
+    template<class... Args> void warning(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_WARNING, false, msg, args...);
+        }
+    }
+
+    template<class... Args> void warningln(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_WARNING, true, msg, args...);
+        }
+    }
+
+    template<class... Args> void notice(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_NOTICE, false, msg, args...);
+        }
+    }
+
+    template<class... Args> void noticeln(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_NOTICE, true, msg, args...);
+        }
+    }
+
+    template<class... Args> void info(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_INFO, false, msg, args...);
+        }
+    }
+
+    template<class... Args> void infoln(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_INFO, true, msg, args...);
+        }
+    }
+
+    template<class... Args> void trace(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_TRACE, false, msg, args...);
+        }
+    }
+
+    template<class... Args> void traceln(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_TRACE, true, msg, args...);
+        }
+    }
+
+    template<class... Args> void verbose(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_VERBOSE, false, msg, args...);
+        }
+    }
+
+    template<class... Args> void verboseln(const char *msg, Args... args) {
+        if (ENABLED) {
+            print(LOG_LEVEL_VERBOSE, true, msg, args...);
+        }
+    }
+
+private:
+#ifdef DISABLE_LOGGING
+    static constexpr bool ENABLED = false;  // If logging is compiled in
+#else
+    static constexpr bool ENABLED = true;   // If logging is compiled in
+#endif
+
+    /**
+     * Write a message if its level is shown
+     */
+    void print(const int &level, const bool &newline, const char *msg, ...);
+
+    // Member variables
+    int level = LOG_LEVEL_SILENT;   // The most detailed level to show
+    bool showLevel = true;  // If each message is prefixed with its level
+};
+
+extern Logging Log;
+
+#endif // ARDUINOLOG_H
@@ -0,0 +1,64 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef PREFERENCES_H
+#define PREFERENCES_H
+
+/*
+ * A host version of the ESP32 Preferences library for the native environment. The namespaces
+ * are kept in memory for the life of the program rather than in NVS, so what one Preferences
+ * writes another can read back, as after a restart on target
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Reads and writes the keys of one namespace
+ */
+class Preferences {
+public:
+    /**
+     * Open a namespace
+     *
+     * @param name - The namespace
+     * @param readOnly - If the namespace is only read
+     * @param partitionLabel - Ignored on the host
+     * @return True if the namespace was opened
+     */
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+
+    /**
+     * Close the namespace
+     */
+    void end();
+
+    /**
+     * Write bytes to a key
+     *
+     * @param key - The key
+     * @param value - The bytes
+     * @param length - The number of bytes
+     * @return The number of bytes written (0 on failure)
+     */
+    size_t putBytes(const char *key, const void *value, size_t length);
+
+    /**
+     * Read the bytes of a key
+     *
+     * @param key - The key
+     * @param buffer - The buffer to read into
+     * @param maxLength - The size of the buffer
+     * @return The number of bytes read (0 if the key is missing or does not fit)
+     */
+    size_t getBytes(const char *key, void *buffer, size_t maxLength);
+
+private:
+    // Member variables
+    std::string name;   // The open namespace (empty if none)
+    bool readOnly = false;  // If the namespace was opened read only
+};
+
+#endif // PREFERENCES_H
@@ -0,0 +1,80 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef HOSTHAL_H
+#define HOSTHAL_H
+
+#include <cstdint>
+#include "mechanism/imuSample.h"
+
+/*
+ * Host HAL
+ *
+ * The other side of the HAL on the host. A test, benchmark or simulation uses it to drive the
+ * inputs the handlers read and to observe the outputs they write
+ */
+
+/**
+ * Switch between the system's steady clock and a simulated clock. The simulated clock starts at
+ * 0 and only moves with hostClockAdvance() and clockDelay(), so runs are repeatable
+ *
+ * @param simulated - True to use the simulated clock
+ */
+void hostClockSimulate(const bool &simulated);
+
+/**
+ * Advance the simulated clock
+ *
+ * @param us - The time to advance in µs
+ */
+void hostClockAdvance(const uint32_t &us);
+
+/**
+ * Drive the level of an input pin
+ *
+ * @param pin - The GPIO pin
+ * @param level - True for high
+ */
+void hostGPIOSet(const uint8_t &pin, const bool &level);
+
+/**
+ * Get the duty cycle last written to a PWM channel
+ *
+ * @param channel - The channel
+ * @return The duty cycle
+ */
+uint32_t hostPWMRead(const uint8_t &channel);
+
+/**
+ * Get the resolution a PWM channel was configured with
+ *
+ * @param channel - The channel
+ * @return The resolution in bits (0 if not configured)
+ */
+uint8_t hostPWMResolution(const uint8_t &channel);
+
+/**
+ * Add edges to a counter unit's simulated 16-bit counter, as an encoder turning would. The
+ * counter wraps like the PCNT, so it must be read before it moves by more than COUNTER_MAX_STEP
+ *
+ * @param unit - The counter unit
+ * @param delta - The number of counts to add (negative to count down)
+ */
+void hostCounterAdd(const uint8_t &unit, const int64_t &delta);
+
+/**
+ * Raise ticks of the tick timer, as its period elapsing would. Wakes the task waiting on it
+ *
+ * @param ticks - The number of ticks to raise (more than 1 as if the task missed some)
+ */
+void hostTickRaise(const uint32_t &ticks);
+
+/**
+ * Publish an IMU sample for the control loop to consume
+ *
+ * @param sample - The sample
+ */
+void hostPublishIMUSample(const IMUSample &sample);
+
+#endif // HOSTHAL_H
@@ -0,0 +1,72 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef PWM_H
+#define PWM_H
+
+#include <cstdint>
+
+/*
+ * PWM HAL
+ *
+ * PWM channels that drive output pins (the ESP32's LEDC). On the host each channel's duty cycle
+ * is stored so it can be read back by a test or simulation
+ */
+
+constexpr uint8_t PWM_CHANNEL_COUNT = 16;   // The number of PWM channels
+
+/**
+ * Configure a PWM channel. Channels 0 - 7 and 8 - 15 each share their timers, so channels of the
+ * same group configured with the same frequency and resolution run off one timer and their
+ * periods line up
+ *
+ * @param channel - The channel (0 - 15)
+ * @param frequency - The frequency of the signal in Hz
+ * @param resolution - The resolution of the duty cycle in bits
+ * @return True if the channel could be configured
+ */
+bool pwmSetup(const uint8_t &channel, const uint32_t &frequency, const uint8_t &resolution);
+
+/**
+ * Route a PWM channel to a pin
+ *
+ * @param pin - The GPIO pin
+ * @param channel - The channel
+ */
+void pwmAttach(const uint8_t &pin, const uint8_t &channel);
+
+/**
+ * Set the duty cycle of a PWM channel
+ *
+ * @param channel - The channel
+ * @param duty - The duty cycle (0 to 2^resolution - 1)
+ */
+void pwmWrite(const uint8_t &channel, const uint32_t &duty);
+
+/**
+ * Stage the duty cycle of a PWM channel without applying it, so several channels can be applied
+ * together by pwmCommit()
+ *
+ * @param channel - The channel
+ * @param duty - The duty cycle (0 to 2^resolution - 1)
+ */
+void pwmStage(const uint8_t &channel, const uint32_t &duty);
+
+/**
+ * Apply the staged duty cycles of several channels. Each channel switches at the end of its
+ * current period, so no pulse is cut short
+ *
+ * @param channels - A mask of the channels (bit n for channel n)
+ */
+void pwmCommit(const uint16_t &channels);
+
+/**
+ * Drive several channels high at once, without waiting for the current period to end, and stage
+ * the full duty cycle for them. They stay high until they are next committed
+ *
+ * @param channels - A mask of the channels (bit n for channel n)
+ */
+void pwmHold(const uint16_t &channels);
+
+#endif // PWM_H
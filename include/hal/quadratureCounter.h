@@ -0,0 +1,57 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef QUADRATURECOUNTER_H
+#define QUADRATURECOUNTER_H
+
+#include <cstdint>
+
+/*
+ * Quadrature Counter HAL
+ *
+ * Counts the edges of a quadrature encoder (full quad: 4 counts per cycle). On the ESP32 each
+ * unit is a 16-bit counter of the PCNT peripheral, and on the host a simulated one driven by the
+ * host HAL. Either way the counter is extended to 64 bits by a CounterExtension when it is read,
+ * not by a limit interrupt, so a unit must be read by one task, often enough to see every wrap
+ * (see COUNTER_MAX_STEP)
+ */
+
+constexpr uint8_t COUNTER_UNIT_COUNT = 8;   // The number of counter units
+
+/**
+ * Attach a counter unit to an encoder's channels
+ *
+ * @param unit - The counter unit (0 - 7)
+ * @param pinA - The Channel A pin
+ * @param pinB - The Channel B pin
+ * @return True if the unit was attached
+ */
+bool counterAttach(const uint8_t &unit, const uint8_t &pinA, const uint8_t &pinB);
+
+/**
+ * Read a counter unit, extending its counter by the movement since the last read. Must only be
+ * called from the task that samples the unit
+ *
+ * @param unit - The counter unit
+ * @return The count
+ */
+int64_t counterRead(const uint8_t &unit);
+
+/**
+ * Clear a counter unit. The hardware keeps counting, so no edge is lost
+ *
+ * @param unit - The counter unit
+ * @return True if the count was cleared
+ */
+bool counterClear(const uint8_t &unit);
+
+/**
+ * Set the count of a counter unit
+ *
+ * @param unit - The counter unit
+ * @param count - The count
+ */
+void counterWrite(const uint8_t &unit, const int64_t &count);
+
+#endif // QUADRATURECOUNTER_H
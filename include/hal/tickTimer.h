@@ -0,0 +1,41 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef TICKTIMER_H
+#define TICKTIMER_H
+
+#include <cstdint>
+
+/*
+ * Tick Timer HAL
+ *
+ * A periodic timer that wakes one waiting task every period. On the ESP32 it is a hardware timer
+ * whose interrupt gives the task a notification, so ticks the task has not yet taken are counted
+ * rather than lost. On the host the ticks are raised by the host HAL (see hal/native/hostHAL.h)
+ */
+
+constexpr uint8_t TICK_TIMER_COUNT = 4; // The number of hardware timers
+
+/**
+ * Start the tick timer. Its ticks wake the calling task. Only one may run at a time
+ *
+ * @param timer - The hardware timer to use (0 - 3)
+ * @param period - The period between ticks in µs
+ * @return True if the timer was started
+ */
+bool tickTimerStart(const uint8_t &timer, const uint32_t &period);
+
+/**
+ * Stop the tick timer, if it is running
+ */
+void tickTimerStop();
+
+/**
+ * Block until the tick timer has ticked. Must only be called from the task that started it
+ *
+ * @return The number of ticks since the last call (>1 means ticks were missed)
+ */
+uint32_t tickTimerWait();
+
+#endif // TICKTIMER_H
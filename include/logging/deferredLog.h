@@ -0,0 +1,254 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef DEFERREDLOG_H
+#define DEFERREDLOG_H
+
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/*
+ * Logging that stays off the hot path. A message is a format string and up to
+ * LOG_MAX_ARGUMENTS numbers. The DLOG_* macros copy them into a lock-free ring buffer without
+ * formatting anything, and a low priority task formats and writes them to Log later, so a
+ * control tick or BLE callback never waits on the Serial port. If the task falls behind, new
+ * messages are dropped and counted rather than blocking.
+ *
+ * The levels are also resolved at compile time. A message above its file's LOG_MODULE_LEVEL
+ * compiles to nothing, arguments included. A file sets its level by defining LOG_MODULE_LEVEL
+ * before its first #include, and every other file uses LOG_COMPILED_LEVEL, which a build can
+ * override with -DLOG_COMPILED_LEVEL=<level>. Log's runtime level still filters what is shown.
+ *
+ * The format is kept as a pointer, so it must be a string literal, and the arguments are kept as
+ * 32-bit words (64-bit integers must be cast down, doubles are narrowed to floats). Strings
+ * cannot be deferred, as they may be gone by the time the message is written, so a message that
+ * formats one is written immediately with DLOG_DIRECT, which blocks but is compiled out the same
+ * way
+ */
+
+// The most detailed level compiled into files that do not set their own
+#ifndef LOG_COMPILED_LEVEL
+#define LOG_COMPILED_LEVEL LOG_LEVEL_INFO
+#endif
+
+// The most detailed level compiled into this file
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL LOG_COMPILED_LEVEL
+#endif
+
+// If messages of a level are compiled into this file
+#define DLOG_ENABLED(level) ((level) <= LOG_MODULE_LEVEL)
+
+// Defer a message at a level, if the level is compiled in
+#define DLOG(level, ...) do { \
+    if (DLOG_ENABLED(level)) { \
+        deferLog(level, __VA_ARGS__); \
+    } \
+} while (false)
+
+#define DLOG_FATAL(...) DLOG(LOG_LEVEL_FATAL, __VA_ARGS__)
+#define DLOG_ERROR(...) DLOG(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define DLOG_WARNING(...) DLOG(LOG_LEVEL_WARNING, __VA_ARGS__)
+#define DLOG_NOTICE(...) DLOG(LOG_LEVEL_NOTICE, __VA_ARGS__)
+#define DLOG_INFO(...) DLOG(LOG_LEVEL_INFO, __VA_ARGS__)
+#define DLOG_TRACE(...) DLOG(LOG_LEVEL_TRACE, __VA_ARGS__)
+#define DLOG_VERBOSE(...) DLOG(LOG_LEVEL_VERBOSE, __VA_ARGS__)
+
+// Write a message at a level immediately (blocking), if the level is compiled in
+#define DLOG_DIRECT(level, ...) do { \
+    if (DLOG_ENABLED(level)) { \
+        logDirect(level, __VA_ARGS__); \
+    } \
+} while (false)
+
+constexpr size_t LOG_MAX_ARGUMENTS = 8; // The most arguments a deferred message may have
+constexpr size_t LOG_RING_SIZE = 128;   // The messages the ring buffer holds (a power of 2)
+constexpr size_t LOG_LINE_SIZE = 160;   // The longest formatted message in chars
+
+/**
+ * A deferred message: its format and raw arguments
+ */
+struct LogRecord {
+    const char *format; // The format string (a string literal)
+    uint8_t level;  // The message's level
+    uint8_t count;  // The number of arguments
+    std::array<uint32_t, LOG_MAX_ARGUMENTS> arguments;  // The arguments as raw words
+};
+
+/**
+ * The ring buffer of deferred messages and the task side that writes them. Any task may defer a
+ * message. A bounded multi-producer queue (Vyukov's): each slot carries a sequence number, a
+ * producer claims a slot with one compare-and-swap on the tail and publishes it by advancing the
+ * slot's sequence, so producers never wait on each other or on the drain. Only one task may
+ * drain it
+ */
+class DeferredLog {
+public:
+    // Delete copy-constructor and assignment-op
+    DeferredLog(const DeferredLog &) = delete;
+
+    DeferredLog &operator=(const DeferredLog &) = delete;
+
+    // Destructor
+    ~DeferredLog() noexcept;
+
+    /**
+     * Get the singleton DeferredLog instance
+     *
+     * @return The instance ptr
+     */
+    static DeferredLog *instance();
+
+    /**
+     * Add a message to the ring buffer. Never blocks. The message is dropped if the buffer is full
+     *
+     * @param record - The message
+     * @return True if the message was added
+     */
+    bool push(const LogRecord &record) noexcept;
+
+    /**
+     * Take the oldest message from the ring buffer. Must only be called from the draining task
+     *
+     * @param record - Set to the message
+     * @return True if there was a message
+     */
+    bool pop(LogRecord &record) noexcept;
+
+    /**
+     * Format and write every waiting message to Log, after a warning if any were dropped since
+     * the last drain. Must only be called from the draining task
+     *
+     * @return The number of messages written
+     */
+    size_t drain();
+
+    /**
+     * Drain the ring buffer forever, sleeping between drains. Run in its own low priority task
+     *
+     * @param interval - The time between drains in ms
+     */
+    void loop(const uint32_t &interval);
+
+    /**
+     * Get how many messages have been dropped because the ring buffer was full
+     *
+     * @return The number of dropped messages
+     */
+    uint32_t getDropped() const noexcept;
+
+    /**
+     * Format a message with ArduinoLog's format specifiers, reading each argument as the type its
+     * specifier names
+     *
+     * @param record - The message
+     * @param buffer - The buffer to write to
+     * @param size - The size of the buffer (the message is truncated to fit)
+     * @return The length of the formatted message
+     */
+    static size_t format(const LogRecord &record, char *buffer, const size_t &size) noexcept;
+
+private:
+    /**
+     * A slot of the ring buffer
+     */
+    struct Slot {
+        std::atomic<uint32_t> sequence; // The position the slot is next pushed (or popped) at
+        LogRecord record;   // The message
+    };
+
+    // Private constructor
+    DeferredLog() noexcept;
+
+    // Member variables
+    static DeferredLog *inst;   // Singleton instance
+    std::array<Slot, LOG_RING_SIZE> slots;  // The ring buffer
+    std::atomic<uint32_t> tail; // The next position to push to
+    uint32_t head;  // The next position to pop from (owned by the draining task)
+    std::atomic<uint32_t> dropped;  // The messages dropped because the buffer was full
+    uint32_t reportedDropped;   // The dropped messages already reported
+};
+
+/**
+ * Turn an integer argument into a raw word. A wider integer must be cast down at the call site, so
+ * it is never truncated by accident
+ *
+ * @param value - The argument
+ * @return The word
+ */
+template<typename T>
+inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value,
+        uint32_t>::type toLogWord(const T &value) noexcept {
+    static_assert(sizeof(T) <= sizeof(uint32_t), "Cast a 64-bit argument to 32 bits to defer it");
+    return static_cast<uint32_t>(value);
+}
+
+/**
+ * Turn a floating point argument into a raw word, as the bits of a float
+ *
+ * @param value - The argument
+ * @return The word
+ */
+template<typename T>
+inline typename std::enable_if<std::is_floating_point<T>::value, uint32_t>::type
+toLogWord(const T &value) noexcept {
+    float narrowed = static_cast<float>(value);
+    uint32_t word;
+    memcpy(&word, &narrowed, sizeof(word));
+    return word;
+}
+
+/**
+ * Defer a message. Called through the DLOG_* macros
+ *
+ * @param level - The message's level
+ * @param format - The format string (a string literal)
+ * @param args - The numeric arguments
+ */
+template<typename... Args>
+inline void deferLog(const uint8_t &level, const char *format, const Args &... args) noexcept {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGUMENTS, "Too many arguments to defer a message");
+    LogRecord record = {format, level, static_cast<uint8_t>(sizeof...(Args)),
+                        {{toLogWord(args)...}}};
+    DeferredLog::instance()->push(record);
+}
+
+/**
+ * Write a message to Log at a level. Called through DLOG_DIRECT and by the drain
+ *
+ * @param level - The message's level
+ * @param format - The format string
+ * @param args - The arguments
+ */
+template<typename... Args>
+inline void logDirect(const uint8_t &level, const char *format, Args... args) {
+    switch (level) {
+        case LOG_LEVEL_FATAL:
+            Log.fatalln(format, args...);
+            break;
+        case LOG_LEVEL_ERROR:
+            Log.errorln(format, args...);
+            break;
+        case LOG_LEVEL_WARNING:
+            Log.warningln(format, args...);
+            break;
+        case LOG_LEVEL_NOTICE:
+            Log.noticeln(format, args...);
+            break;
+        case LOG_LEVEL_TRACE:
+            Log.traceln(format, args...);
+            break;
+        case LOG_LEVEL_VERBOSE:
+            Log.verboseln(format, args...);
+            break;
+        default:
+            break;
+    }
+}
+
+#endif // DEFERREDLOG_H
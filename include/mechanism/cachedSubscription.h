@@ -0,0 +1,151 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef CACHEDSUBSCRIPTION_H
+#define CACHEDSUBSCRIPTION_H
+
+#include <atomic>
+#include <cstdint>
+#include "mechanism/gattCache.h"
+
+/**
+ * Subscribes a client to the server's IMU characteristic with the handles cached from an earlier
+ * connection, skipping service discovery. The writes are not waited on, and a server whose GATT
+ * table changed may accept them at handles that are no longer the IMU's and never notify. So the
+ * handles are only trusted once a notification arrives, and if none arrives within the timeout
+ * they are forgotten so the caller falls back to discovery. It is templated on the client so the
+ * same logic runs against a NimBLEClient on target and against a mock client on the host
+ *
+ * @tparam Client - The client type. A free function bool writeHandle(Client &client,
+ *                  const uint16_t &handle, const uint8_t *data, const uint16_t &length) must send
+ *                  a write to an attribute handle without waiting for the response
+ */
+template<typename Client>
+class CachedSubscription {
+public:
+    /**
+     * Primary constructor
+     *
+     * @param cache - The cache of the server's handles
+     * @param timeout - How long to wait for the first notification in ms
+     */
+    CachedSubscription(GATTCache &cache, const uint32_t &timeout) noexcept: cache(cache),
+                                                                            timeout(timeout) {}
+
+    // Default destructor
+    ~CachedSubscription() = default;
+
+    // Delete copy-constructor and assignment-op
+    CachedSubscription(const CachedSubscription &) = delete;
+
+    CachedSubscription &operator=(const CachedSubscription &) = delete;
+
+    /**
+     * Enable notifications and request the encoding with a server's cached handles, then start
+     * waiting for the first notification
+     *
+     * @param client - The connected client
+     * @param address - The server's address key
+     * @param handles - The server's cached handles
+     * @param encodingID - The encoding to request
+     * @param now - The current time in ms
+     * @return True if the writes were sent
+     */
+    bool subscribe(Client &client, const uint64_t &address, const GATTHandles &handles,
+                   const uint8_t &encodingID, const uint32_t &now) {
+        const uint8_t enableNotifications[2] = {0x01, 0x00};
+        pending = false;
+
+        if (!writeHandle(client, handles.IMUCCCD, enableNotifications,
+                         sizeof(enableNotifications)) ||
+            !writeHandle(client, handles.IMUValue, &encodingID, sizeof(encodingID))) {
+            return false;
+        }
+
+        this->address = address;
+        start = now;
+        notified.store(false, std::memory_order_relaxed);
+        pending = true;
+        return true;
+    }
+
+    /**
+     * Record that an IMU notification arrived. Safe to call from the BLE host task
+     */
+    void notify() noexcept {
+        notified.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * Check if the cached handles are still waiting for their first notification
+     *
+     * @return True if waiting
+     */
+    bool isPending() const noexcept {
+        return pending;
+    }
+
+    /**
+     * Get the time left to wait for the first notification
+     *
+     * @param now - The current time in ms
+     * @return The time left in ms (0 if the wait is over or not pending)
+     */
+    uint32_t remaining(const uint32_t &now) const noexcept {
+        uint32_t elapsed = now - start;
+        return pending && elapsed < timeout ? timeout - elapsed : 0;
+    }
+
+    /**
+     * Check if the cached handles went without a notification for the whole timeout. If so they
+     * are forgotten, and the caller must discover the IMU characteristic again
+     *
+     * @param now - The current time in ms
+     * @return True if the handles timed out
+     */
+    bool expired(const uint32_t &now) {
+        if (!pending) {
+            return false;
+        }
+
+        if (notified.load(std::memory_order_relaxed)) {
+            pending = false;
+            return false;
+        }
+
+        if (now - start < timeout) {
+            return false;
+        }
+
+        pending = false;
+        cache.invalidate(address);
+        return true;
+    }
+
+    /**
+     * Forget the cached handles because the server rejected a write to one
+     */
+    void reject() {
+        pending = false;
+        cache.invalidate(address);
+    }
+
+    /**
+     * Stop waiting for the first notification, as the connection was lost
+     */
+    void cancel() noexcept {
+        pending = false;
+    }
+
+private:
+    // Member variables
+    GATTCache &cache;   // The cache of the server's handles
+    uint32_t timeout;   // How long to wait for the first notification in ms
+    uint64_t address = 0;   // The address key of the server subscribed to
+    uint32_t start = 0; // When the writes were sent in ms
+    bool pending = false;   // If the handles are waiting for their first notification
+    std::atomic<bool> notified{false};  // If a notification arrived since the writes were sent
+};
+
+#endif // CACHEDSUBSCRIPTION_H
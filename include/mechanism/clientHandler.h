@@ -1,16 +1,77 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #ifndef CLIENTHANDLER_H
 #define CLIENTHANDLER_H
 
-#define DISABLE_LOGGING
-
 #include <Arduino.h>
-#include <ArduinoLog.h>
+#include "logging/deferredLog.h"
 #include <NimBLEDevice.h>
 #include <../lib/MPU6050/helper_3dmath.h>
+#include "mechanism/imuSample.h"
+#include "mechanism/sampleChannel.h"
+#include "mechanism/sampleHistory.h"
+#include "protocol/imuPacket.h"
+#include "protocol/linkProfile.h"
+#include "mechanism/cachedSubscription.h"
+#include "mechanism/gattCache.h"
+
+/**
+ * Statistics about the IMU samples received over BLE. All times are in µs
+ */
+struct LinkStatistics {
+    uint32_t received;  // The number of samples received
+    uint32_t dropped;   // The number of samples missing from the sequence
+    uint32_t interval;  // The smoothed time between samples on the server
+    uint32_t jitter;    // The smoothed variation in transit time
+    uint32_t maxJitter; // The largest variation in transit time
+    uint32_t age;   // The age of the last consumed sample when it was consumed
+    uint32_t maxAge;    // The largest age of a consumed sample
+};
+
+/**
+ * The states of the client's connection to the server
+ */
+enum class ConnectionState : uint8_t {
+    Idle,   // Not initialized
+    Scanning,   // Looking for a server advertising the service
+    Connecting, // Establishing the connection
+    Discovering,    // Finding the IMU characteristic and subscribing to it
+    Subscribed, // Receiving IMU samples
+    Backoff // Waiting to retry after a failure
+};
+
+/**
+ * The events that drive the connection state machine
+ */
+enum class ConnectionEvent : uint8_t {
+    Start,  // The handler was initialized
+    DeviceFound,    // A scan found a server advertising the service
+    ScanEnded,  // A timed scan ended without finding a server
+    CacheRejected,  // The server rejected a write to a cached handle
+    Disconnected    // The connection to the server was lost
+};
+
+/**
+ * An event posted to the connection task along with the address it concerns
+ */
+struct ConnectionMessage {
+    ConnectionEvent event;  // The event
+    NimBLEAddress address;  // The server's address (DeviceFound only)
+};
+
+/**
+ * Statistics about the client's connection to the server. All times are in ms
+ */
+struct ConnectionStatistics {
+    ConnectionState state;  // The current state
+    uint32_t connects;  // The number of successful connections
+    uint32_t failures;  // The number of failed connection attempts
+    uint32_t disconnects;   // The number of times a subscribed connection was lost
+    uint32_t reconnectTime; // The time from the last disconnect until subscribed again
+    uint32_t maxReconnectTime;  // The longest time from a disconnect until subscribed again
+};
 
 /**
  * A struct to define what to do for client events
@@ -24,7 +85,26 @@ struct ClientCallbacks final : public NimBLEClientCallbacks {
     void onConnect(NimBLEClient *connectedClient) override;
 
     /**
-     * Called for disconnection events. Starts a new scan
+     * Called when the MTU changes
+     *
+     * @param client - The client whose MTU changed
+     * @param MTU - The new MTU
+     */
+    void onMTUChange(NimBLEClient *client, uint16_t MTU) override;
+
+    /**
+     * Called when the server asks for new connection parameters. They are accepted, but a
+     * request slower than the link profile is reported
+     *
+     * @param client - The client the request is for
+     * @param params - The requested parameters
+     * @return True to accept the parameters
+     */
+    bool onConnParamsUpdateRequest(NimBLEClient *client, const ble_gap_upd_params *params)
+    override;
+
+    /**
+     * Called for disconnection events. Notifies the connection task
      *
      * @param disconnectedClient - The client that disconnected
      * @param reason - The reason for disconnect
@@ -37,14 +117,15 @@ struct ClientCallbacks final : public NimBLEClientCallbacks {
  */
 struct ScanCallbacks final : public NimBLEScanCallbacks {
     /**
-     * Called for each device found during a scan. Checks if it has the correct service UUID
+     * Called for each device found during a scan. Notifies the connection task if it has the
+     * correct service UUID
      *
      * @param advertisedDevice - The device that was found
      */
     void onResult(NimBLEAdvertisedDevice *advertisedDevice) override;
 
     /**
-     * Called when a scan ends
+     * Called when a scan ends. Notifies the connection task
      *
      * @param results - The results of the scan
      */
@@ -53,7 +134,20 @@ struct ScanCallbacks final : public NimBLEScanCallbacks {
 
 /**
  * A class to handle the BLE Client. It manages its connection to the server and is notified with
- * new data
+ * new data.
+ *
+ * The connection is a state machine run by loop() and driven by events the BLE callbacks post to
+ * a queue, so the task sleeps until something happens:
+ *
+ *      Scanning --DeviceFound--> Connecting --> Discovering --> Subscribed
+ *      Subscribed --Disconnected--> Connecting (the fast path to the last server's address)
+ *      Connecting/Discovering --failure--> Backoff --timeout--> Connecting or Scanning
+ *
+ * Failed attempts wait an exponential backoff with jitter. The last server's address is kept so
+ * reconnecting skips the scan, falling back to scanning after FAST_RECONNECT_ATTEMPTS failures.
+ * The server's attribute handles are cached too, so reconnecting also skips service discovery
+ * and subscribes by writing the CCCD directly. If the server rejects a cached handle, or no
+ * notification arrives within CACHE_TIMEOUT, the handles are discovered again
  */
 class ClientHandler {
 public:
@@ -73,7 +167,8 @@ public:
     static ClientHandler *instance();
 
     /**
-    * Initialize the Client Handler by creating a BLE Device and starting a scan
+    * Initialize the Client Handler by creating a BLE Device and the connection event queue. The
+    * scan starts once loop() runs
     *
     * @param SERVICE_UUID - The service UUID to look for
     * @param IMU_CHARACTERISTIC_UUID - The IMU Characteristic UUID to look for
@@ -81,39 +176,105 @@ public:
     * @param SCAN_TIME - The duration of a scan in ms (0 is indefinite)
     * @param SCAN_WINDOW - The scan window in ms
     * @param SCAN_INTERVAL - The scan interval in ms
+    * @param ENCODING - The encoding to request for the IMU's quaternions
+    * @param LINK_PROFILE - The link settings to request from the server
+    * @param PERSIST_HANDLES - If the server's attribute handles should be kept in NVS
     */
     void initialize(const std::string &SERVICE_UUID, const std::string
     &IMU_CHARACTERISTIC_UUID, const std::string &DEVICE_NAME, const uint8_t
-                    &SCAN_TIME, const uint32_t &SCAN_WINDOW, const uint32_t &SCAN_INTERVAL);
+                    &SCAN_TIME, const uint32_t &SCAN_WINDOW, const uint32_t &SCAN_INTERVAL,
+                    const IMUEncoding &ENCODING, const LinkProfile &LINK_PROFILE,
+                    const bool &PERSIST_HANDLES);
 
     /**
-     * Called when a subscribed characteristic notifies the client. It un-packages the IMU's
-     * quaternion data
+     * Called for every GAP event. Un-packages notifications of the IMU characteristic into the
+     * sample history
      *
-     * @param remoteCharacteristic - The characteristic that notified the client
-     * @param data - A ptr to the data received in the notification
-     * @param length - The length of the data
-     * @param isNotify - If the callback was triggered by a notification
+     * @param event - The GAP event
+     * @param arg - Unused
+     * @return 0 (the event is still passed on to NimBLE)
      */
-    static void notifyCallback(NimBLERemoteCharacteristic *remoteCharacteristic, uint8_t *data,
-                               size_t length, bool isNotify);
+    static int gapHandler(ble_gap_event *event, void *arg);
 
     /**
-     * Continuously manage the client's connection to the server
+     * Continuously manage the client's connection to the server. Blocks until an event arrives
+     * or a backoff expires
      */
     [[noreturn]] void loop();
 
+    /**
+     * Post an event to the connection task. Safe to call from the BLE callbacks
+     *
+     * @param event - The event
+     * @param address - The server's address the event concerns
+     */
+    static void postEvent(const ConnectionEvent &event, const NimBLEAddress &address =
+    NimBLEAddress());
+
+    /**
+     * Get the statistics of the connection to the server
+     *
+     * @return A copy of the statistics
+     */
+    ConnectionStatistics getConnectionStatistics() const;
+
     /**
      * Get the current quaternion
      * @return The current quaternion
      */
-    const Quaternion &getQuaternion() const;
+    Quaternion getQuaternion() const;
+
+    /**
+     * Get the latest IMU sample. Safe to call from any task while notifications arrive
+     *
+     * @return A consistent copy of the latest sample
+     */
+    IMUSample getSample() const;
+
+    /**
+     * Get the latest IMU sample for use by the controller and record its age. Should only be
+     * called by the control loop
+     *
+     * @return A consistent copy of the latest sample
+     */
+    IMUSample consumeSample();
+
+    /**
+     * Get up to the last n IMU samples
+     *
+     * @param samples - The array to copy the samples into (newest first)
+     * @param n - The maximum number of samples to copy
+     * @return The number of samples copied
+     */
+    size_t getSamples(IMUSample *samples, const size_t &n) const;
+
+    /**
+     * Get the IMU samples that arrived within a window of time before now
+     *
+     * @param duration - The length of the window in µs
+     * @param samples - The array to copy the samples into (newest first)
+     * @param n - The maximum number of samples to copy
+     * @return The number of samples copied
+     */
+    size_t getSamples(const uint32_t &duration, IMUSample *samples, const size_t &n) const;
+
+    /**
+     * Get the statistics of the BLE link
+     *
+     * @return A copy of the statistics
+     */
+    LinkStatistics getLinkStatistics() const;
+
+    static constexpr size_t HISTORY_SIZE = 64; // The number of IMU samples kept
+    static constexpr uint8_t EVENT_QUEUE_LENGTH = 8;  // The number of pending connection events
+    static constexpr uint32_t BACKOFF_MIN = 100;    // The first retry delay in ms
+    static constexpr uint32_t BACKOFF_MAX = 5000;   // The longest retry delay in ms
+    static constexpr uint8_t FAST_RECONNECT_ATTEMPTS = 3;   // Retries before scanning again
+    static constexpr uint32_t CACHE_TIMEOUT = 1000; // The wait for a notification on cached handles
 
     // Public Member variables - used by the callbacks
-    static NimBLEAdvertisedDevice *advDevice;   // A ptr to a device with the correct UUID
     static std::string serviceUUID; // The service UUID to look for
-    static uint32_t scanTime; // The duration of a scan in ms (0 is indefinite)
-    static bool doConnect;  // If the client should try to connect to a device
+    static LinkProfile linkProfile; // The link settings requested from the server
 
 private:
     /**
@@ -122,20 +283,113 @@ private:
     ClientHandler() = default;
 
     /**
-     * Attempts to connect to a server with the correct service UUID. It then checks its
-     * characteristic's properties and subscribes to notifications.
+     * Handle a connection event in the current state
      *
+     * @param message - The event
+     */
+    void handleEvent(const ConnectionMessage &message);
+
+    /**
+     * Start scanning for a server
+     */
+    void startScan();
+
+    /**
+     * Connect to the server and subscribe to its IMU characteristic, moving through the
+     * Connecting and Discovering states. Enters Subscribed on success or Backoff on failure
+     */
+    void attemptConnection();
+
+    /**
+     * Attempts to connect to the server at peerAddress, reusing an existing client if there is
+     * one
+     *
+     * @return The connected client or nullptr on failure
+     */
+    NimBLEClient *connectToServer();
+
+    /**
+     * Checks the server's characteristic's properties, subscribes to notifications and requests
+     * the encoding
+     *
+     * @param client - The connected client
      * @return True if successful
      */
-    bool connectToServer();
+    bool subscribeToIMU(NimBLEClient *client);
+
+    /**
+     * Discover the IMU characteristic again on the current connection after the cached handles
+     * failed. Enters Subscribed on success or Backoff on failure
+     */
+    void rediscover();
+
+    /**
+     * Enter a state and publish it
+     *
+     * @param next - The state to enter
+     */
+    void setState(const ConnectionState &next);
+
+    /**
+     * Get the time until the backoff expires or the cached handles time out
+     *
+     * @return The time to wait in FreeRTOS ticks (portMAX_DELAY if there is nothing to wait for)
+     */
+    TickType_t getTimeout() const;
+
+    /**
+     * Subscribe to the IMU characteristic with the cached handles of the server, skipping
+     * discovery
+     *
+     * @param client - The connected client
+     * @return True if the writes were sent (a later rejection posts CacheRejected)
+     */
+    bool subscribeCached(NimBLEClient *client);
+
+    /**
+     * Un-package a batch of IMU samples into the sample history
+     *
+     * @param data - A ptr to the packet
+     * @param length - The length of the packet
+     */
+    static void receivePacket(const uint8_t *data, const size_t &length);
+
+    /**
+     * Add a received sample to the history and update the arrival statistics
+     *
+     * @param received - The sample that was received
+     */
+    static void recordSample(const IMUSample &received);
 
     // Member Variables
     static ClientHandler *inst; // Ptr to the singleton inst
     static ClientCallbacks clientCallback; // Client callback instance
     static ScanCallbacks scanCallback; // Scan callback instance
     static bool initialized;    // Initialization flag
+    static QueueHandle_t events;    // The queue of connection events
+    static uint32_t scanTime; // The duration of a scan in ms (0 is indefinite)
+    static GATTCache cache; // The server's attribute handles
+    static CachedSubscription<NimBLEClient> cachedSubscription; // Subscribes with the cache
+    static std::atomic<uint16_t> connHandle;    // The handle of the connection to the server
+    static std::atomic<uint16_t> IMUHandle; // The IMU characteristic's value handle (0 if none)
     static std::string IMUCharacteristicUUID;  // The IMU Characteristic UUID
-    static Quaternion quaternion;  // To hold the current quaternion value
+    static IMUEncoding encoding;    // The encoding requested for the IMU's quaternions
+    static SampleHistory<IMUSample, HISTORY_SIZE> history;   // To hold the latest IMU samples
+    static LinkStatistics arrivalStatistics;    // The arrival statistics (written by the callback)
+    static SampleChannel<LinkStatistics> publishedStatistics; // The published arrival statistics
+    static std::atomic<uint32_t> age;   // The age of the last consumed sample
+    static std::atomic<uint32_t> maxAge;    // The largest age of a consumed sample
+
+    // Connection state - only used by the connection task
+    ConnectionState state = ConnectionState::Idle;  // The current state
+    NimBLEAddress peerAddress;  // The address of the last server found
+    uint8_t attempts = 0;   // The number of failed attempts since the last success
+    uint32_t backoffStart = 0;  // When the backoff started in ms
+    uint32_t backoffDelay = 0;  // The length of the backoff in ms
+    uint32_t disconnectTime = 0;    // When the connection was lost in ms
+    bool reconnecting = false;  // If the client is recovering from a lost connection
+    ConnectionStatistics connectionStatistics = {}; // The connection statistics
+    SampleChannel<ConnectionStatistics> publishedConnection;    // The published statistics
 };
 
 #endif // CLIENTHANDLER_H
\ No newline at end of file
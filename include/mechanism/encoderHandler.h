@@ -1,19 +1,32 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #ifndef ENCODERHANDLER_H
 #define ENCODERHANDLER_H
 
-#define DISABLE_LOGGING
-
 #include <Arduino.h>
-#include "ArduinoLog.h"
-#include "ESP32Encoder.h"
+#include "logging/deferredLog.h"
 #include <array>
+#include <atomic>
+#include "mechanism/snapshotRegister.h"
+#include "mechanism/velocityEstimator.h"
+
+/**
+ * The state of the 3 encoders at one instant
+ */
+struct EncoderState {
+    std::array<int64_t, 3> counts;  // The count of each encoder
+    std::array<float, 3> velocities;    // The velocity of each encoder in counts/s
+    uint32_t timestamp; // When the counts were read in µs
+    uint32_t version;   // The number of updates up to this one (0 before the first)
+};
 
 /**
- * A class to handle all the 3 encoders. It manages their states and allows access to their data
+ * A class to handle all the 3 encoders. It manages their states and allows access to their data.
+ * The encoders are sampled together by update(), which the control loop calls every tick, and
+ * each sample is published as an EncoderState. The task calling update() reads it directly, and
+ * any other task reads a consistent copy wait-free through its own reader index
  */
 class EncoderHandler {
 public:
@@ -41,38 +54,58 @@ public:
     static EncoderHandler *instance();
 
     /**
-    * Get the encoder counts
+     * Get the latest sample of the encoders. Must only be called from the task calling update()
      *
-    * @return A reference to the array containing the encoder counts
-    */
-    const std::array<int64_t, 3> &getCounts() const noexcept;
+     * @return The counts and velocities from the last update()
+     */
+    const EncoderState &getState() const noexcept;
 
     /**
-     * Continuously update the encoder counts
+     * Reserve a reader index for a task other than the one calling update(). Called once per task
+     * during setup
+     *
+     * @return The reader index to pass to getSnapshot()
      */
-    [[noreturn]] void loop();
+    uint8_t addReader();
 
-private:
     /**
-     * Primary Constructor
+     * Get a snapshot of the latest sample from any task. Wait-free, so it never blocks update()
+     * and always takes the same time
+     *
+     * @param reader - The task's index from addReader()
+     * @return A consistent copy of the counts, velocities, timestamp and version of one update()
      */
-    EncoderHandler();
+    EncoderState getSnapshot(const uint8_t &reader) const noexcept;
 
     /**
-     * Updates each encoder's count
+     * Sample the encoders. The three counts are read back to back under one timestamp, their
+     * velocities are estimated and the result is published. Called by the control loop at the
+     * start of every tick, so it must only be called from one task. Sampling also extends the
+     * 16-bit hardware counters, so it must run at least every ~2 s while the wheels turn
      */
-    void updateCounts() noexcept;
+    void update() noexcept;
+
+private:
+    /**
+     * Primary Constructor
+     */
+    EncoderHandler();
 
     /**
      * Resets each of the encoder counts to 0. Used for calibration
      */
     void resetCounts() noexcept;
 
+    static constexpr uint8_t MAX_READERS = 4;   // The tasks other than the updater that can read
+
     // Member variables
     static EncoderHandler *inst; // Ptr to the singleton inst
     static bool initialized; // Initialization flag
-    std::array<ESP32Encoder, 3> encoders; // Array to hold the encoders
-    std::array<int64_t, 3> counts;  // Array to hold the encoder counts
+    std::array<uint8_t, 3> units;   // The quadrature counter unit of each encoder
+    std::array<VelocityEstimator, 3> estimators;    // Each encoder's velocity estimate
+    EncoderState state; // The latest sample, owned by the task calling update()
+    SnapshotRegister<EncoderState, MAX_READERS> snapshots;  // The latest sample for other tasks
+    std::atomic<uint8_t> readers;   // The number of reader indices reserved
 };
 
 #endif // ENCODERHANDLER_H
\ No newline at end of file
@@ -0,0 +1,102 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef GATTCACHE_H
+#define GATTCACHE_H
+
+#include <Arduino.h>
+
+/**
+ * The attribute handles the client needs from the server
+ */
+struct GATTHandles {
+    uint16_t IMUValue;  // The handle of the IMU characteristic's value
+    uint16_t IMUCCCD;   // The handle of the IMU characteristic's CCCD
+};
+
+/**
+ * Remembers the attribute handles discovered on a server so reconnecting to the same server can
+ * skip service discovery. It holds the handles of one server (the client only talks to one) in
+ * RAM, and optionally in NVS so they survive a restart.
+ *
+ * The handles are only valid as long as the server's GATT table is unchanged, so the caller must
+ * invalidate them as soon as the server rejects one
+ */
+class GATTCache {
+public:
+    /**
+     * Primary constructor. The cache starts empty and in RAM only, as NVS is not ready during
+     * static initialization
+     */
+    GATTCache() noexcept;
+
+    // Default destructor
+    ~GATTCache() = default;
+
+    // Delete copy-constructor and assignment-op
+    GATTCache(const GATTCache &) = delete;
+
+    GATTCache &operator=(const GATTCache &) = delete;
+
+    /**
+     * Set if the handles are kept in NVS. Loads any handles already in NVS when enabled
+     *
+     * @param persistent - If the handles should also be kept in NVS
+     */
+    void setPersistent(const bool &persistent);
+
+    /**
+     * Get the handles of a server
+     *
+     * @param address - The server's address (48-bit address and type as from addressKey())
+     * @param handles - Set to the handles if they are known
+     * @return True if the handles are known
+     */
+    bool lookup(const uint64_t &address, GATTHandles &handles) const noexcept;
+
+    /**
+     * Remember the handles of a server, replacing any others
+     *
+     * @param address - The server's address
+     * @param handles - The handles
+     */
+    void store(const uint64_t &address, const GATTHandles &handles);
+
+    /**
+     * Forget the handles of a server
+     *
+     * @param address - The server's address
+     */
+    void invalidate(const uint64_t &address);
+
+    /**
+     * Build the key for a server's address
+     *
+     * @param address - The 48-bit address
+     * @param type - The address type
+     * @return The key
+     */
+    static uint64_t addressKey(const uint64_t &address, const uint8_t &type) noexcept;
+
+private:
+    /**
+     * The cache as stored in NVS
+     */
+    struct Entry {
+        uint64_t address;   // The server's address key
+        GATTHandles handles;    // The server's handles
+        bool valid; // If the entry holds handles
+    };
+
+    /**
+     * Write the entry to NVS if the cache is persistent
+     */
+    void save() const;
+
+    // Member variables
+    Entry entry;    // The cached handles
+    bool persistent;    // If the handles are kept in NVS
+};
+
+#endif // GATTCACHE_H
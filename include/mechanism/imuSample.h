@@ -0,0 +1,22 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef IMUSAMPLE_H
+#define IMUSAMPLE_H
+
+#include <cstdint>
+#include <cmath>
+#include "../lib/MPU6050/helper_3dmath.h"
+
+/**
+ * A quaternion received from the IMU along with when it was taken and when it arrived
+ */
+struct IMUSample {
+    Quaternion quaternion;  // The IMU's orientation
+    uint32_t timestamp; // When the sample arrived in µs
+    uint32_t sequence;  // The server's sequence number of the sample
+    uint32_t deviceTimestamp;   // When the sample was taken in the server's µs
+};
+
+#endif // IMUSAMPLE_H
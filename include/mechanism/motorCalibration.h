@@ -0,0 +1,39 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef MOTORCALIBRATION_H
+#define MOTORCALIBRATION_H
+
+#include <Arduino.h>
+#include <array>
+#include "control/velocityController.h"
+#include "mechanism/motorCharacterizer.h"
+
+/**
+ * A calibration profile: the measured model of each motor and the velocity loop gains tuned from
+ * them. It is written by the motor driver hardware test's characterization mode and kept in NVS,
+ * so the mechanism can start with its own motors' deadbands and gains
+ */
+struct MotorCalibration {
+    std::array<MotorModel, 3> models;   // The model of each motor
+    VelocityGains gains;    // The wheels' velocity loop gains
+};
+
+/**
+ * Load the calibration profile from NVS
+ *
+ * @param calibration - Set to the profile if one is stored
+ * @return True if a profile of the current layout was stored
+ */
+bool loadMotorCalibration(MotorCalibration &calibration);
+
+/**
+ * Store a calibration profile in NVS, replacing any other
+ *
+ * @param calibration - The profile
+ * @return True if the profile was written
+ */
+bool saveMotorCalibration(const MotorCalibration &calibration);
+
+#endif // MOTORCALIBRATION_H
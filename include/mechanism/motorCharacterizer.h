@@ -0,0 +1,179 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef MOTORCHARACTERIZER_H
+#define MOTORCHARACTERIZER_H
+
+#include <Arduino.h>
+#include <array>
+#include "control/velocityController.h"
+
+/**
+ * A first-order model of a motor turning its wheel, from duty cycle to wheel speed
+ */
+struct MotorModel {
+    float deadband; // The duty cycle the wheel needs to start turning, as a fraction of full scale
+    float gain; // The steady wheel speed gained per unit of duty cycle in rad/s
+    float timeConstant; // The time the wheel takes to cover 63% of a change in speed in s
+};
+
+/**
+ * How the motors are characterized and the velocity loops tuned from the result
+ */
+struct CharacterizationSettings {
+    float rampRate; // How fast the duty cycle rises while finding the deadband in full scale/s
+    float rampLimit;    // The duty cycle at which a motor that has not moved is given up on
+    float startSpeed;   // The wheel speed counted as moving in rad/s
+    uint32_t stepTime;  // How long each duty cycle of the sweep is held in ms
+    float closedLoopRatio;  // The velocity loop's time constant over the wheel's
+    float delay;    // The velocity loop's delay (a tick plus the encoders' averaging) in s
+};
+
+/**
+ * Settings for the 34:1 gearmotors on a 1 kHz control loop. The wheels settle within ~0.1 s, so
+ * each duty cycle is held for 0.4 s, and the velocity loops are tuned to be 3 times faster than
+ * the wheels
+ */
+constexpr CharacterizationSettings DEFAULT_CHARACTERIZATION = {0.1f, 0.3f, 0.5f, 400, 0.33f,
+                                                               0.002f};
+
+/**
+ * Measures each motor's deadband, gain and time constant by driving it and watching its encoder,
+ * one motor at a time while the others brake. Each motor's duty cycle is first ramped up slowly
+ * in both directions until the wheel starts turning, which gives the deadband. It is then swept
+ * up and down a staircase of duty cycles in both directions. The steady speed of every step is
+ * fitted by least squares for the gain, and the time to cover 63% of each step's change in speed
+ * gives the time constant.
+ *
+ * update() is called every control tick after the EncoderHandler has sampled the encoders, so
+ * the same characterization runs on the ESP32 and against the plant simulator. It drives the
+ * motors through MotorHandler::setMotorSpeeds, bypassing the command limits, and keeps every step
+ * a quarter of full scale so the current stays safe
+ */
+class MotorCharacterizer {
+public:
+    /**
+     * Primary constructor
+     *
+     * @param settings - How to characterize the motors
+     * @param radiansPerCount - The wheel angle of one encoder count in rad
+     */
+    MotorCharacterizer(const CharacterizationSettings &settings, const float &radiansPerCount)
+    noexcept;
+
+    // Default destructor
+    ~MotorCharacterizer() = default;
+
+    // Delete copy-constructor and assignment-op
+    MotorCharacterizer(const MotorCharacterizer &) = delete;
+
+    MotorCharacterizer &operator=(const MotorCharacterizer &) = delete;
+
+    /**
+     * Start characterizing from the first motor
+     *
+     * @param now - The current time in µs
+     */
+    void start(const uint32_t &now) noexcept;
+
+    /**
+     * Advance the characterization by one tick. Stops the motors once it is done
+     *
+     * @param now - The current time in µs
+     * @return True while the characterization is running
+     */
+    bool update(const uint32_t &now);
+
+    /**
+     * Check if every motor was characterized. A motor that never moved fails the run
+     *
+     * @return True if the models are valid
+     */
+    bool succeeded() const noexcept;
+
+    /**
+     * Get the models measured so far
+     *
+     * @return The model of each motor
+     */
+    const std::array<MotorModel, 3> &getModels() const noexcept;
+
+private:
+    /**
+     * The stages of one motor's characterization
+     */
+    enum class Stage : uint8_t {
+        RampForward,    // Ramp forward until the wheel turns
+        RampReverse,    // Ramp in reverse until the wheel turns
+        Sweep,  // Hold each duty cycle of the staircase
+        Rest,   // Coast until the wheel stops, then move on
+        Done    // Every motor has been characterized
+    };
+
+    /**
+     * Command one motor, stopping the others
+     *
+     * @param duty - The duty cycle as a fraction of full scale
+     */
+    void drive(const float &duty);
+
+    /**
+     * Start a stage
+     *
+     * @param next - The stage
+     * @param now - The current time in µs
+     */
+    void enter(const Stage &next, const uint32_t &now);
+
+    /**
+     * Finish a step of the sweep: record its steady speed and how fast it got there
+     */
+    void finishStep();
+
+    /**
+     * Fit the current motor's model from its sweep
+     */
+    void fitModel();
+
+    static constexpr size_t SWEEP_STEPS = 14;   // The duty cycles of the sweep
+    static constexpr size_t MAX_STEP_SAMPLES = 1000;    // The samples kept of a step
+
+    // The staircase: up and down in quarters of full scale, forward then in reverse
+    static constexpr float SWEEP[SWEEP_STEPS] = {0.25f, 0.5f, 0.75f, 1.0f, 0.75f, 0.5f, 0.25f,
+                                                 -0.25f, -0.5f, -0.75f, -1.0f, -0.75f, -0.5f,
+                                                 -0.25f};
+
+    // Member variables
+    CharacterizationSettings settings;  // How to characterize the motors
+    float radiansPerCount;  // The wheel angle of one encoder count in rad
+    Stage stage = Stage::Done;  // The current stage
+    Stage afterRest = Stage::Done;  // The stage to start once the wheel has stopped
+    size_t motor = 0;   // The motor being characterized
+    size_t step = 0;    // The step of the sweep being held
+    uint32_t stageStart = 0;    // When the stage (or step) started in µs
+    std::array<float, 2> breakaways = {};   // The duty cycle that started the wheel each way
+    std::array<float, SWEEP_STEPS> steadySpeeds = {};   // The steady speed of each step in rad/s
+    std::array<float, SWEEP_STEPS> riseTimes = {};  // The 63% time of each step in s (0 if none)
+    std::array<float, MAX_STEP_SAMPLES> samples = {};   // The wheel speed during the step in rad/s
+    std::array<uint32_t, MAX_STEP_SAMPLES> sampleTimes = {};    // When each sample was taken
+    size_t sampleCount = 0; // The samples taken during the step
+    std::array<MotorModel, 3> models = {};  // The model of each motor
+    bool failed = false;    // If a motor never moved
+};
+
+/**
+ * Tune the wheels' velocity loops from the motors' models with the IMC (lambda) rules for a
+ * first-order plant with delay. The feed-forward inverts the average gain, the integral time
+ * equals the average time constant, and the proportional gain sets the closed-loop time constant
+ * to closedLoopRatio of it. The derivative is left off, as the tuning in DEFAULT_VELOCITY_GAINS
+ * found it does not help
+ *
+ * @param models - The model of each motor
+ * @param settings - The closed-loop ratio and the loop's delay
+ * @return The gains
+ */
+VelocityGains deriveVelocityGains(const std::array<MotorModel, 3> &models,
+                                  const CharacterizationSettings &settings) noexcept;
+
+#endif // MOTORCHARACTERIZER_H
@@ -1,21 +1,64 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/24/2024
+// Last Modified: 10/16/2026
 
 #ifndef MOTORHANDLER_H
 #define MOTORHANDLER_H
 
-#define DISABLE_LOGGING
-
 #include <Arduino.h>
-#include <ArduinoLog.h>
+#include "logging/deferredLog.h"
 #include <array>
 
 struct MotorDriver {
     uint8_t pwmPin; // PWM signal pin connected to IN1
-    uint8_t directionPin;   // Direction signal pin connected to IN2
+    uint8_t directionPin;   // Direction signal pin connected to IN2 (low only when forward)
+    bool reverse;   // If the motor was last driven in reverse
+    bool stopped;   // If the duty cycle is 0
+    uint32_t stoppedSince;  // When the duty cycle was set to 0 in us
+    int16_t speed;  // The pwm value applied
+};
+
+/**
+ * How fast and how hard setMotorCommands() may drive the motors
+ */
+struct MotorLimits {
+    float slewRate; // The fastest a command may change in full scale/s (0 for no limit)
+    float currentLimit; // The largest driving current as a fraction of stall (0 for no limit)
+    float freeSpeed;    // The wheel speed whose back-EMF cancels the full duty cycle in rad/s
+};
+
+/**
+ * Limits for the Pololu 34:1 gearmotor at 12 V on the DRV8871. A command may go from 0 to full
+ * scale in 20 ms, which still lets the velocity loops correct their encoders' noise, and the
+ * current is held to 60% of the ~5.5 A stall current, under the DRV8871's 3.6 A limit. The
+ * wheel's free speed is ~30 rad/s
+ */
+constexpr MotorLimits DEFAULT_MOTOR_LIMITS = {50.0f, 0.6f, 30.0f};
+
+/**
+ * What setMotorCommands() applied
+ */
+struct MotorOutput {
+    std::array<float, 3> applied;   // The commands applied, in the caller's units [-1, 1]
+    std::array<bool, 3> saturated;  // If a command was clipped, slewed, limited or held back
 };
 
+/**
+ * A class to drive the 3 motors. setMotorSpeeds() works out every duty cycle and direction before
+ * touching the outputs, then changes the direction pins in one register write and applies the
+ * three duty cycles together. The three PWM channels have the same frequency and resolution, so
+ * they share a timer and the drivers switch in the same PWM period.
+ *
+ * The DRV8871 drives forward with IN1 high and IN2 low, in reverse with IN1 low and IN2 high,
+ * brakes with both high and coasts with both low. A motor driven forward has IN2 low and its duty
+ * cycle on IN1, coasting for the rest of the period. A motor driven in reverse has IN2 high and
+ * IN1 low for its duty cycle, braking for the rest of the period. A motor at a duty cycle of 0
+ * has both inputs high and brakes. On a reversal it brakes for the direction deadtime before it
+ * is driven the other way.
+ *
+ * Controllers command the motors through setMotorCommands() with fractions of full scale, which
+ * are compensated for each motor's deadband and limited in slew rate and current
+ */
 class MotorHandler {
 public:
     // Delete constructor, copy-constructor and assignment-op
@@ -34,26 +77,97 @@ public:
      *                    {Direction Pin, PWM Pin}
      * @param PWM_FREQUENCY - The frequency of the PWM signal
      * @param PWM_RESOLUTION - The resolution of the PWM duty cycle
+     * @param DIRECTION_DEADTIME - How long a motor brakes before it is reversed in us. At least 2
+     *                             PWM periods
      */
     void initialize(const std::array<std::array<uint8_t, 2>, 3> &motorPins, const uint32_t
-    &PWM_FREQUENCY, const uint8_t &PWM_RESOLUTION);
+    &PWM_FREQUENCY, const uint8_t &PWM_RESOLUTION, const uint32_t &DIRECTION_DEADTIME);
 
     /**
-     * Set the speeds of the 3 motors
+     * Set the speeds of the 3 motors. Speeds beyond the largest duty cycle are clipped to it, and
+     * a motor being reversed is held at 0 until its deadtime has passed
      *
      * @param speeds - An array holding the pwm values
+     * @return The pwm values applied after clipping and deadtime, so a controller can tell it
+     *         saturated
+     */
+    std::array<int16_t, 3> setMotorSpeeds(const std::array<int16_t, 3> &speeds);
+
+    /**
+     * Command the 3 motors with fractions of full scale. Each command is clipped to [-1, 1] and
+     * slewed from the last applied command, then raised past the motor's deadband so any nonzero
+     * command moves the wheel. The duty cycle is then kept within the current limit of the
+     * wheel's back-EMF, which ramps a stalled motor up as it gains speed and keeps a spinning one
+     * from being plugged into reverse. Must be called every tick for the slew to progress
+     *
+     * @param commands - The command of each motor [-1, 1]
+     * @param wheelSpeeds - The measured speed of each wheel in rad/s, for the back-EMF
+     * @return The commands applied and which were limited, so a controller can hold its
+     *         integrators
+     */
+    MotorOutput setMotorCommands(const std::array<float, 3> &commands,
+                                 const std::array<float, 3> &wheelSpeeds);
+
+    /**
+     * Set the duty cycle each motor needs to overcome static friction
+     *
+     * @param deadbands - The deadband of each motor as a fraction of full scale [0, 1)
+     */
+    void setDeadbands(const std::array<float, 3> &deadbands);
+
+    /**
+     * Set the slew rate and current limits of setMotorCommands()
+     *
+     * @param motorLimits - The limits. None may be negative, and the free speed must be positive
+     */
+    void setLimits(const MotorLimits &motorLimits);
+
+    /**
+     * Get the largest speed setMotorSpeeds applies (the full duty cycle)
+     *
+     * @return The largest pwm value
      */
-    void setMotorSpeeds(const std::array<int16_t, 3> &speeds);
+    int16_t getMaxSpeed() const noexcept;
 
 private:
     // Primary constructor
     MotorHandler() = default;
 
+    /**
+     * Map a command to the duty cycle that makes it move the motor. Commands above
+     * DEADBAND_BLEND start at the deadband, and smaller ones blend into it so 0 stays continuous
+     *
+     * @param command - The command [-1, 1]
+     * @param deadband - The motor's deadband
+     * @return The duty cycle as a fraction of full scale
+     */
+    static float compensateDeadband(const float &command, const float &deadband) noexcept;
+
+    /**
+     * Map a duty cycle back to the command that produces it (the inverse of compensateDeadband)
+     *
+     * @param duty - The duty cycle as a fraction of full scale
+     * @param deadband - The motor's deadband
+     * @return The command [-1, 1]
+     */
+    static float removeDeadband(const float &duty, const float &deadband) noexcept;
+
+    // The command below which the deadband is blended in
+    static constexpr float DEADBAND_BLEND = 0.01f;
+
+    // The longest time a call to setMotorCommands() may slew for in s, so the first command after
+    // a pause is still ramped
+    static constexpr float MAX_SLEW_PERIOD = 0.01f;
+
     // Member variables
     static MotorHandler *inst;  // Ptr to the singleton inst
     static bool initialized;    // Initialization flag
     std::array<MotorDriver, 3> drivers; // Array to hold the motor drivers
     uint8_t resolution; // The resolution of the PWM duty cycle
+    uint32_t directionDeadtime; // How long a motor brakes before it is reversed in us
+    std::array<float, 3> deadbands = {};    // The duty cycle each motor needs to start moving
+    MotorLimits limits = DEFAULT_MOTOR_LIMITS;  // The slew rate and current limits
+    uint32_t lastCommandTime = 0;   // When setMotorCommands() was last called in us
 };
 
 #endif // MOTORHANDLER_H
\ No newline at end of file
@@ -0,0 +1,101 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef SAMPLECHANNEL_H
+#define SAMPLECHANNEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * A lock-free single-writer/multi-reader channel holding the latest value of a sample (a
+ * seqlock). The writer never blocks, and readers retry until they copy a value that was not
+ * written to while they were reading, so a read never mixes fields from two samples.
+ *
+ * The sample is stored as atomic words so the concurrent accesses are well defined
+ *
+ * @tparam T - The sample type. Must be trivially copyable
+ */
+template<typename T>
+class SampleChannel {
+    static_assert(std::is_trivially_copyable<T>::value, "SampleChannel requires a trivially "
+                                                        "copyable type");
+
+public:
+    // Default constructor and destructor
+    SampleChannel() = default;
+    ~SampleChannel() = default;
+
+    // Delete copy-constructor and assignment-op
+    SampleChannel(const SampleChannel &) = delete;
+
+    SampleChannel &operator=(const SampleChannel &) = delete;
+
+    /**
+     * Publish a new sample. Must only be called from a single writer
+     *
+     * @param sample - The sample to publish
+     */
+    void write(const T &sample) noexcept {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &sample, sizeof(T));
+
+        // An odd sequence marks a write in progress
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i(0); i < WORDS; ++i) {
+            data[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * Read the latest sample. Never blocks the writer
+     *
+     * @return A consistent copy of the latest sample
+     */
+    T read() const noexcept {
+        uint32_t words[WORDS];
+        uint32_t before;
+        uint32_t after;
+
+        do {
+            before = sequence.load(std::memory_order_acquire);
+
+            for (size_t i(0); i < WORDS; ++i) {
+                words[i] = data[i].load(std::memory_order_relaxed);
+            }
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        T sample;
+        memcpy(&sample, words, sizeof(T));
+        return sample;
+    }
+
+    /**
+     * Get the number of samples written
+     *
+     * @return The number of completed writes
+     */
+    uint32_t getWriteCount() const noexcept {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    // Member variables
+    std::atomic<uint32_t> sequence{0};  // Incremented before and after every write
+    std::atomic<uint32_t> data[WORDS] = {}; // The sample stored as words
+};
+
+#endif // SAMPLECHANNEL_H
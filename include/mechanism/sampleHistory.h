@@ -0,0 +1,149 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef SAMPLEHISTORY_H
+#define SAMPLEHISTORY_H
+
+#include <atomic>
+#include <cstdint>
+#include "mechanism/sampleChannel.h"
+
+/**
+ * A fixed-capacity, lock-free ring buffer of timestamped samples with a single writer and any
+ * number of readers. Each slot is a SampleChannel, so readers always copy whole samples, and a
+ * slot the writer laps while it is being read is discarded rather than returned.
+ *
+ * All query results are ordered newest first
+ *
+ * @tparam T - The sample type. Must be trivially copyable and have a uint32_t timestamp in µs
+ * @tparam N - The capacity of the history
+ */
+template<typename T, size_t N>
+class SampleHistory {
+    static_assert(N > 0, "SampleHistory requires a non-zero capacity");
+
+public:
+    // Default constructor and destructor
+    SampleHistory() = default;
+    ~SampleHistory() = default;
+
+    // Delete copy-constructor and assignment-op
+    SampleHistory(const SampleHistory &) = delete;
+
+    SampleHistory &operator=(const SampleHistory &) = delete;
+
+    /**
+     * Add a sample, overwriting the oldest once full. Must only be called from a single writer
+     *
+     * @param sample - The sample to add
+     */
+    void push(const T &sample) noexcept {
+        uint32_t index = count.load(std::memory_order_relaxed);
+        slots[index % SLOTS].write(sample);
+        count.store(index + 1, std::memory_order_release);
+    }
+
+    /**
+     * Get the newest sample
+     *
+     * @param sample - Set to the newest sample if there is one
+     * @return True if there was a sample
+     */
+    bool latest(T &sample) const noexcept {
+        return lastN(&sample, 1) == 1;
+    }
+
+    /**
+     * Get up to the last n samples
+     *
+     * @param samples - The array to copy the samples into (newest first)
+     * @param n - The maximum number of samples to copy
+     * @return The number of samples copied
+     */
+    size_t lastN(T *samples, const size_t &n) const noexcept {
+        uint32_t newest = count.load(std::memory_order_acquire);
+        size_t copied = 0;
+
+        for (uint32_t i(0); i < n && i < N && i < newest; ++i) {
+            if (!readSlot(newest - 1 - i, samples[copied])) {
+                break;
+            }
+            ++copied;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Get the samples that arrived within a window of time before now
+     *
+     * @param now - The current time in µs
+     * @param duration - The length of the window in µs
+     * @param samples - The array to copy the samples into (newest first)
+     * @param n - The maximum number of samples to copy
+     * @return The number of samples copied
+     */
+    size_t window(const uint32_t &now, const uint32_t &duration, T *samples, const size_t &n)
+    const noexcept {
+        uint32_t newest = count.load(std::memory_order_acquire);
+        size_t copied = 0;
+
+        for (uint32_t i(0); copied < n && i < N && i < newest; ++i) {
+            if (!readSlot(newest - 1 - i, samples[copied])) {
+                break;
+            }
+
+            // Samples are in arrival order so the first one outside the window ends the search
+            if (now - samples[copied].timestamp > duration) {
+                break;
+            }
+            ++copied;
+        }
+
+        return copied;
+    }
+
+    /**
+     * Get the number of samples held
+     *
+     * @return The number of samples (at most N)
+     */
+    size_t size() const noexcept {
+        uint32_t total = count.load(std::memory_order_acquire);
+        return total < N ? total : N;
+    }
+
+    /**
+     * Get the capacity of the history
+     *
+     * @return N
+     */
+    static constexpr size_t capacity() noexcept {
+        return N;
+    }
+
+private:
+    // One spare slot so the slot being written is never one of the N readable samples
+    static constexpr size_t SLOTS = N + 1;
+
+    /**
+     * Read the sample with the given index
+     *
+     * @param index - The index of the sample since the history was created
+     * @param sample - Set to the sample
+     * @return True if the sample was still held once it was copied
+     */
+    bool readSlot(const uint32_t &index, T &sample) const noexcept {
+        sample = slots[index % SLOTS].read();
+
+        // The writer may have lapped the slot during the read
+        return count.load(std::memory_order_acquire) - index <= N;
+    }
+
+    // Member variables
+    std::atomic<uint32_t> count{0}; // The number of samples ever pushed
+    SampleChannel<T> slots[SLOTS];  // The samples
+};
+
+#endif // SAMPLEHISTORY_H
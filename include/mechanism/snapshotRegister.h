@@ -0,0 +1,144 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef SNAPSHOTREGISTER_H
+#define SNAPSHOTREGISTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * A wait-free single-writer/multi-reader register (Peterson's "concurrent reading while
+ * writing"). Unlike a SampleChannel, a reader never retries: every read takes the same number of
+ * steps however often the writer writes, so a low priority reader cannot be starved by the
+ * control loop, and the writer never waits on a reader either.
+ *
+ * The value is written to two buffers in turn, with a flag and a switch that tell a reader which
+ * of its two copies was not written to while it was reading. If the writer could have overwritten
+ * both, it has first left the reader a private copy. Each concurrent reader therefore needs its
+ * own reader index, and the writer's cost grows with the number of readers.
+ *
+ * The buffers are stored as atomic words so the concurrent accesses are well defined
+ *
+ * @tparam T - The value type. Must be trivially copyable
+ * @tparam READERS - The number of readers
+ */
+template<typename T, size_t READERS>
+class SnapshotRegister {
+    static_assert(std::is_trivially_copyable<T>::value, "SnapshotRegister requires a trivially "
+                                                        "copyable type");
+    static_assert(READERS > 0, "SnapshotRegister requires at least one reader");
+
+public:
+    // Default constructor and destructor
+    SnapshotRegister() = default;
+    ~SnapshotRegister() = default;
+
+    // Delete copy-constructor and assignment-op
+    SnapshotRegister(const SnapshotRegister &) = delete;
+
+    SnapshotRegister &operator=(const SnapshotRegister &) = delete;
+
+    /**
+     * Write a new value. Must only be called from a single writer
+     *
+     * @param value - The value to write
+     */
+    void write(const T &value) noexcept {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+
+        // Write the first buffer, flagging it and flipping the switch so a reader of it knows
+        writing.store(true);
+        store(first, words);
+        flip.store(!flip.load(std::memory_order_relaxed));
+        writing.store(false);
+
+        // Leave a copy for every reader that started since its last copy, as its read of the
+        // second buffer may overlap the write below
+        for (size_t i(0); i < READERS; ++i) {
+            bool started = reading[i].load();
+            if (started != copied[i].load(std::memory_order_relaxed)) {
+                store(copies[i], words);
+                copied[i].store(started);
+            }
+        }
+
+        store(second, words);
+    }
+
+    /**
+     * Read the latest value. Never blocks and never retries
+     *
+     * @param reader - The reader's index (< READERS). Concurrent readers must use different ones
+     * @return A consistent copy of the latest value
+     */
+    T read(const size_t &reader) const noexcept {
+        uint32_t firstWords[WORDS];
+        uint32_t secondWords[WORDS];
+
+        // Ask the writer for a copy, then read both buffers, noting any write to the first
+        reading[reader].store(!copied[reader].load());
+        bool writingBefore = writing.load();
+        bool flipBefore = flip.load();
+        load(first, firstWords);
+        bool writingAfter = writing.load();
+        bool flipAfter = flip.load();
+        load(second, secondWords);
+
+        T value;
+        if (reading[reader].load() == copied[reader].load()) {
+            // The writer made a copy, so it may have written both buffers during the read
+            uint32_t copyWords[WORDS];
+            load(copies[reader], copyWords);
+            memcpy(&value, copyWords, sizeof(T));
+        } else if (writingBefore || writingAfter || flipBefore != flipAfter) {
+            // The first buffer was written during the read, but the second was not
+            memcpy(&value, secondWords, sizeof(T));
+        } else {
+            memcpy(&value, firstWords, sizeof(T));
+        }
+
+        return value;
+    }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    /**
+     * Store words into a buffer, ordered after everything before it
+     */
+    static void store(std::atomic<uint32_t> (&buffer)[WORDS], const uint32_t *words) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (size_t i(0); i < WORDS; ++i) {
+            buffer[i].store(words[i], std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    /**
+     * Load words from a buffer, ordered after everything before it
+     */
+    static void load(const std::atomic<uint32_t> (&buffer)[WORDS], uint32_t *words) noexcept {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (size_t i(0); i < WORDS; ++i) {
+            words[i] = buffer[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    // Member variables
+    std::atomic<bool> writing{false};   // Set while the first buffer is written
+    std::atomic<bool> flip{false};  // Flipped after every write of the first buffer
+    mutable std::atomic<bool> reading[READERS] = {};    // Flipped by a reader to ask for a copy
+    std::atomic<bool> copied[READERS] = {}; // Set to reading by the writer once it has copied
+    std::atomic<uint32_t> first[WORDS] = {};    // The buffer written first
+    std::atomic<uint32_t> second[WORDS] = {};   // The buffer written last
+    std::atomic<uint32_t> copies[READERS][WORDS] = {};  // Each reader's private copy
+};
+
+#endif // SNAPSHOTREGISTER_H
@@ -0,0 +1,71 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef VELOCITYESTIMATOR_H
+#define VELOCITYESTIMATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Estimates an encoder's velocity from its count, sampled at a steady rate. The PCNT does not
+ * timestamp its edges, so an edge is timestamped with the sample it is first seen in, and the
+ * velocity is the counts between two such edge samples over the time between them. The window
+ * adapts to the speed:
+ *      At high speed the last sample period already spans MIN_COUNTS, so the estimate is the
+ *      count difference over one period and responds immediately
+ *      At low speed an edge only arrives every few samples, so a single period's difference is
+ *      either 0 or a whole count. The window instead reaches back over the last edges until it
+ *      spans MIN_COUNTS or MAX_WINDOW, measuring the time between edges. It never reaches
+ *      back past a reversal, so the estimate takes the new direction from the first edge after it
+ *      While no edge arrives the wheel cannot be turning faster than one count over the time
+ *      since the last edge, so the estimate decays toward 0 instead of holding its last value
+ *
+ * Both ends of the window are edges, so its error is at most a sample period however slowly the
+ * wheel turns, and the counting needs no interrupts at any speed
+ */
+class VelocityEstimator {
+public:
+    // Default constructor and destructor
+    VelocityEstimator() = default;
+    ~VelocityEstimator() = default;
+
+    /**
+     * Start estimating from a count, at rest
+     *
+     * @param count - The count
+     * @param timestamp - When the count was read in µs
+     */
+    void reset(const int64_t &count, const uint32_t &timestamp) noexcept;
+
+    /**
+     * Update the estimate with a new sample
+     *
+     * @param count - The count
+     * @param timestamp - When the count was read in µs
+     * @return The velocity in counts/s
+     */
+    float update(const int64_t &count, const uint32_t &timestamp) noexcept;
+
+    /**
+     * Get the latest estimate
+     *
+     * @return The velocity in counts/s
+     */
+    float getVelocity() const noexcept;
+
+private:
+    static constexpr size_t EDGES = 16; // The number of edge samples kept
+    static constexpr int64_t MIN_COUNTS = 16;   // The counts a window spans when it can
+    static constexpr uint32_t MAX_WINDOW = 20000;   // The longest window when it cannot in µs
+
+    // Member variables
+    int64_t edgeCounts[EDGES] = {}; // The count of each edge sample (a ring, newest at head)
+    uint32_t edgeTimes[EDGES] = {}; // When each edge sample was read in µs
+    size_t head = 0;    // The index of the newest edge sample
+    size_t edges = 0;   // The number of edge samples held
+    float velocity = 0.0f;  // The latest estimate in counts/s
+};
+
+#endif // VELOCITYESTIMATOR_H
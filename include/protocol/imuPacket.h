@@ -0,0 +1,232 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef IMUPACKET_H
+#define IMUPACKET_H
+
+#include <Arduino.h>
+#include "../lib/MPU6050/helper_3dmath.h"
+
+/*
+ * The IMU characteristic's notification format (all fields little-endian):
+ *
+ *      Header (12 bytes)
+ *          uint8_t  version     IMU_PACKET_VERSION
+ *          uint8_t  encoding    The IMUEncoding of the quaternions
+ *          uint8_t  count       The number of samples in the packet
+ *          uint8_t  reserved    0
+ *          uint32_t sequence    The sequence number of the first sample
+ *          uint32_t timestamp   The device timestamp of the first sample in µs
+ *      Samples (count times)
+ *          uint16_t delta       The time since the previous sample in µs (0 for the first)
+ *          quaternion           The encoded quaternion
+ *
+ * Samples in a packet have consecutive sequence numbers
+ */
+
+constexpr uint8_t IMU_PACKET_VERSION = 1;   // The version of the packet format
+constexpr size_t IMU_PACKET_HEADER_SIZE = 12;   // The size of the header in bytes
+constexpr size_t IMU_PACKET_MAX_SIZE = 512; // The largest packet (the max ATT value length)
+
+/**
+ * The ways a quaternion can be encoded in a packet
+ */
+enum class IMUEncoding : uint8_t {
+    Float32 = 0,    // 4 x 32-bit float [wxyz] (16 bytes)
+    Q14 = 1,    // 4 x 16-bit Q14 fixed-point [wxyz], the DMP's native format (8 bytes)
+    SmallestThree = 2   // The largest component's index in 2 bits and the other three as 15-bit
+                        // fixed-point in [-1/sqrt(2), 1/sqrt(2)] (6 bytes)
+};
+
+/*
+ * Worst-case error of each decoded component of a unit quaternion, and of the rotation it
+ * stands for:
+ *      Float32         0 (exact)
+ *      Q14             3.1e-5, 1.3e-4 rad (exact for quaternions read from the DMP)
+ *      SmallestThree   2.2e-5 for the three sent components, 6.5e-5 for the reconstructed one
+ *                      (3 times as much, when all four components are 0.5), 1.5e-4 rad
+ *
+ * The mechanism asks for an encoding by writing its ID to the IMU characteristic. The server
+ * uses Float32 until a new encoding is requested, and every packet names its own encoding
+ */
+
+/**
+ * Check if an encoding ID is known
+ *
+ * @param encoding - The encoding ID
+ * @return True if it is a known IMUEncoding
+ */
+bool isKnownEncoding(const uint8_t &encoding) noexcept;
+
+/**
+ * A quaternion sample as sent by the server
+ */
+struct IMUPacketSample {
+    Quaternion quaternion;  // The IMU's orientation
+    uint32_t sequence;  // The sequence number of the sample
+    uint32_t timestamp; // When the sample was taken on the device in µs
+};
+
+/**
+ * Builds a packet of consecutive samples to send in a single notification
+ */
+class IMUPacketEncoder {
+public:
+    /**
+     * Primary constructor
+     *
+     * @param encoding - The encoding of the quaternions
+     * @param capacity - The maximum number of samples per packet
+     */
+    explicit IMUPacketEncoder(const IMUEncoding &encoding = IMUEncoding::Float32, const uint8_t
+    &capacity = 1) noexcept;
+
+    // Default destructor
+    ~IMUPacketEncoder() = default;
+
+    // Delete copy-constructor and assignment-op
+    IMUPacketEncoder(const IMUPacketEncoder &) = delete;
+
+    IMUPacketEncoder &operator=(const IMUPacketEncoder &) = delete;
+
+    /**
+     * Set the maximum number of samples per packet. Clamped to what fits in a packet. Clears the
+     * packet
+     *
+     * @param samples - The maximum number of samples
+     */
+    void setCapacity(const uint8_t &samples) noexcept;
+
+    /**
+     * Set the encoding of the quaternions. Clears the packet
+     *
+     * @param encoding - The encoding
+     */
+    void setEncoding(const IMUEncoding &encoding) noexcept;
+
+    /**
+     * Add a sample to the packet. Fails if the packet is full, or the sample is not the next
+     * in sequence or too far in time from the previous sample, in which case the packet should
+     * be sent and cleared before adding it again
+     *
+     * @param sample - The sample to add
+     * @return True if the sample was added
+     */
+    bool add(const IMUPacketSample &sample) noexcept;
+
+    /**
+     * Clear the packet
+     */
+    void clear() noexcept;
+
+    /**
+     * Check if the packet is at capacity
+     *
+     * @return True if full
+     */
+    bool isFull() const noexcept;
+
+    /**
+     * Check if the packet has no samples
+     *
+     * @return True if empty
+     */
+    bool isEmpty() const noexcept;
+
+    /**
+     * Get the encoded packet
+     *
+     * @return A ptr to the packet's bytes
+     */
+    const uint8_t *data() const noexcept;
+
+    /**
+     * Get the size of the encoded packet
+     *
+     * @return The size in bytes
+     */
+    size_t size() const noexcept;
+
+    /**
+     * Get the number of samples that fit in a notification for a given MTU
+     *
+     * @param MTU - The ATT MTU of the connection
+     * @param encoding - The encoding of the quaternions
+     * @return The number of samples (at least 1)
+     */
+    static uint8_t samplesForMTU(const uint16_t &MTU, const IMUEncoding &encoding) noexcept;
+
+    /**
+     * Get the size of an encoded quaternion
+     *
+     * @param encoding - The encoding
+     * @return The size in bytes
+     */
+    static size_t encodedSize(const IMUEncoding &encoding) noexcept;
+
+private:
+    // Member variables
+    uint8_t buffer[IMU_PACKET_MAX_SIZE];    // The encoded packet
+    size_t length;  // The size of the encoded packet
+    IMUEncoding encoding;   // The encoding of the quaternions
+    uint8_t capacity;   // The maximum number of samples
+    uint8_t count;  // The number of samples in the packet
+    uint32_t lastSequence;  // The sequence number of the last sample
+    uint32_t lastTimestamp; // The timestamp of the last sample
+};
+
+/**
+ * Unpacks the samples from a received packet one at a time, so no buffer is needed for them
+ */
+class IMUPacketDecoder {
+public:
+    /**
+     * Primary constructor. Validates the packet
+     *
+     * @param data - A ptr to the packet's bytes. Must outlive the decoder
+     * @param length - The size of the packet
+     */
+    IMUPacketDecoder(const uint8_t *data, const size_t &length) noexcept;
+
+    // Default destructor
+    ~IMUPacketDecoder() = default;
+
+    // Delete copy-constructor and assignment-op
+    IMUPacketDecoder(const IMUPacketDecoder &) = delete;
+
+    IMUPacketDecoder &operator=(const IMUPacketDecoder &) = delete;
+
+    /**
+     * Check if the packet is valid
+     *
+     * @return True if valid
+     */
+    bool isValid() const noexcept;
+
+    /**
+     * Get the number of samples in the packet
+     *
+     * @return The number of samples (0 if the packet is invalid)
+     */
+    uint8_t getCount() const noexcept;
+
+    /**
+     * Decode the next sample, oldest first
+     *
+     * @param sample - Set to the next sample
+     * @return True if there was another sample
+     */
+    bool next(IMUPacketSample &sample) noexcept;
+
+private:
+    // Member variables
+    const uint8_t *cursor;  // The next sample's bytes
+    IMUEncoding encoding;   // The encoding of the quaternions
+    uint8_t count;  // The number of samples in the packet
+    uint8_t index;  // The index of the next sample
+    uint32_t sequence;  // The sequence number of the first sample
+    uint32_t timestamp; // The timestamp of the previous sample
+};
+
+#endif // IMUPACKET_H
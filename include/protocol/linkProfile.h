@@ -0,0 +1,78 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef LINKPROFILE_H
+#define LINKPROFILE_H
+
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <NimBLEDevice.h>
+
+/**
+ * The link settings one side of the connection asks for. Each is only a request: the peer and
+ * the controllers may settle on something else, so the agreed values are read back afterwards
+ */
+struct LinkProfile {
+    uint16_t MTU;   // The ATT MTU to exchange in bytes
+    uint16_t dataLength;    // The link-layer payload to request in bytes (27-251)
+    bool PHY2M; // If the 2M PHY should be requested
+    uint16_t minInterval;   // The minimum connection interval in 1.25 ms units
+    uint16_t maxInterval;   // The maximum connection interval in 1.25 ms units
+    uint16_t latency;   // The number of connection events the peripheral may skip
+    uint16_t timeout;   // The supervision timeout in 10 ms units
+};
+
+/**
+ * A profile for delivering IMU samples within 7.5-15 ms. Controllers without the 2M PHY (such as
+ * the original ESP32) stay on the 1M PHY
+ */
+constexpr LinkProfile LOW_LATENCY_LINK = {247, 251, true, 6, 12, 0, 100};
+
+/**
+ * The link settings that were agreed for a connection
+ */
+struct LinkParameters {
+    uint16_t MTU;   // The ATT MTU in bytes
+    uint16_t interval;  // The connection interval in 1.25 ms units
+    uint16_t latency;   // The number of connection events the peripheral may skip
+    uint16_t timeout;   // The supervision timeout in 10 ms units
+    uint8_t txPHY;  // The transmit PHY (1 = 1M, 2 = 2M, 3 = coded, 0 = unknown)
+    uint8_t rxPHY;  // The receive PHY (1 = 1M, 2 = 2M, 3 = coded, 0 = unknown)
+};
+
+/**
+ * Apply the device-wide parts of a profile (the preferred MTU and PHY). Must be called after
+ * NimBLEDevice::init() and before connecting
+ *
+ * @param profile - The profile to apply
+ */
+void applyLinkProfile(const LinkProfile &profile);
+
+/**
+ * Request a profile's data length, PHY and connection parameters on a connection. Every request
+ * is attempted even if an earlier one fails, so an unsupported feature only loses that feature
+ *
+ * @param connHandle - The connection's handle
+ * @param profile - The profile to request
+ * @return True if every request was accepted by the local controller
+ */
+bool tuneConnection(const uint16_t &connHandle, const LinkProfile &profile);
+
+/**
+ * Read the agreed link settings of a connection
+ *
+ * @param connInfo - The connection's info
+ * @return The agreed settings
+ */
+LinkParameters readLinkParameters(const NimBLEConnInfo &connInfo);
+
+/**
+ * Log the agreed link settings of a connection, warning if they are slower than the profile
+ *
+ * @param parameters - The agreed settings
+ * @param profile - The profile that was requested
+ */
+void logLinkParameters(const LinkParameters &parameters, const LinkProfile &profile);
+
+#endif // LINKPROFILE_H
@@ -0,0 +1,89 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef FIFOREADER_H
+#define FIFOREADER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Reads complete DMP packets out of an MPU's FIFO. It is templated on the device so the same
+ * logic runs against the MPU6050 on target and against a mock FIFO on the host
+ *
+ * @tparam Device - The device type. Must provide uint8_t getIntStatus(), uint16_t getFIFOCount(),
+ *                  void getFIFOBytes(uint8_t *data, uint8_t length) and void resetFIFO()
+ */
+template<typename Device>
+class FIFOReader {
+public:
+    static constexpr uint8_t OVERFLOW_BIT = 4;  // The FIFO overflow bit of the interrupt status
+    static constexpr uint16_t FIFO_SIZE = 1024; // The size of the MPU's FIFO in bytes
+
+    /**
+     * Primary constructor
+     *
+     * @param device - The device to read from
+     * @param packetSize - The size of a DMP packet in bytes
+     */
+    FIFOReader(Device &device, const uint16_t &packetSize) : device(device),
+                                                            packetSize(packetSize) {}
+
+    // Default destructor
+    ~FIFOReader() = default;
+
+    // Delete copy-constructor and assignment-op
+    FIFOReader(const FIFOReader &) = delete;
+
+    FIFOReader &operator=(const FIFOReader &) = delete;
+
+    /**
+     * Read every complete packet currently in the FIFO. If the FIFO overflowed or holds a partial
+     * packet, its contents can no longer be aligned to packets, so it is reset instead
+     *
+     * @param buffer - A buffer of at least packetSize bytes to read each packet into
+     * @param handler - Called with the buffer and the number of packets still to be read for each
+     *                  packet read, oldest first
+     * @return The number of packets read
+     */
+    template<typename Handler>
+    size_t drain(uint8_t *buffer, Handler handler) {
+        uint8_t status = device.getIntStatus();
+        uint16_t count = device.getFIFOCount();
+
+        if ((status & (1 << OVERFLOW_BIT)) != 0 || count >= FIFO_SIZE ||
+            count % packetSize != 0) {
+            device.resetFIFO();
+            ++resets;
+            return 0;
+        }
+
+        size_t packets = 0;
+        while (count >= packetSize) {
+            device.getFIFOBytes(buffer, packetSize);
+            count -= packetSize;
+            handler(buffer, count / packetSize);
+            ++packets;
+        }
+
+        return packets;
+    }
+
+    /**
+     * Get the number of times the FIFO was reset because it overflowed or was misaligned
+     *
+     * @return The number of resets
+     */
+    uint32_t getResets() const noexcept {
+        return resets;
+    }
+
+private:
+    // Member variables
+    Device &device; // The device to read from
+    uint16_t packetSize;    // The size of a DMP packet in bytes
+    uint32_t resets = 0;    // The number of FIFO resets
+};
+
+#endif // FIFOREADER_H
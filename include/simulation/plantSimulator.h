@@ -0,0 +1,181 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#ifndef PLANTSIMULATOR_H
+#define PLANTSIMULATOR_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <random>
+#include "mechanism/imuSample.h"
+
+/**
+ * The physical properties of the eyeball and its drive. The defaults model the Pololu 34:1 37D
+ * gearmotor at 12 V driving omni-wheels under a small sphere
+ */
+struct PlantParameters {
+    // Motors
+    double supplyVoltage;   // The voltage across a motor at full duty cycle in V
+    double resistance;  // The motor's winding resistance in Ω
+    double torqueConstant;  // The motor's torque (and back-EMF) constant in Nm/A (V·s/rad)
+    double rotorInertia;    // The motor rotor's moment of inertia in kg·m²
+    double gearRatio;   // The gearbox reduction
+    double gearEfficiency;  // The fraction of the motor's torque that reaches the wheel
+    double deadband;    // The duty cycle fraction below which the motor does not move
+
+    // Geometry
+    double wheelRadius; // The omni-wheel's radius in m
+    double sphereRadius;    // The eyeball's radius in m
+    double sphereInertia;   // The eyeball's moment of inertia in kg·m²
+    double contactElevation;    // The angle of the wheels' contact points below the equator in rad
+    double damping; // The viscous friction on the eyeball in Nm·s/rad
+
+    // Sensors
+    uint16_t encoderCPR;    // The encoder counts per motor shaft revolution (full quad)
+    uint32_t IMUPeriod; // The time between IMU samples in µs
+    uint32_t IMULatency;    // The mean delay between taking and receiving an IMU sample in µs
+    uint32_t IMUJitter; // The maximum deviation from the mean delay in µs
+    double IMUNoise;    // The standard deviation of the IMU's error about each axis in rad
+
+    // Simulation
+    uint32_t step;  // The integration step in µs
+};
+
+/**
+ * The eyeball as built: the Pololu 34:1 motors with a 48 CPR encoder, 24 mm omni-wheels at 45°
+ * under a 50 mm sphere, and IMU samples every 10 ms that arrive 5-10 ms late
+ */
+constexpr PlantParameters DEFAULT_PLANT = {12.0, 2.2, 0.0116, 1.0e-6, 34.0, 0.4, 0.05,
+                                           0.024, 0.05, 3.0e-4, 0.785398, 1.0e-4,
+                                           48, 10000, 7500, 2500, 0.002,
+                                           100};
+
+/**
+ * Which HAL channels a simulated motor is wired to
+ */
+struct SimulatedMotor {
+    uint8_t directionPin;   // The motor's IN2 pin (IN1 is the PWM channel)
+    uint8_t PWMChannel; // The motor's PWM channel
+    uint8_t counterUnit;    // The counter unit of the motor's encoder
+};
+
+/**
+ * A host-side digital twin of the eyeball. The eyeball is a rigid sphere turned by three DC motors
+ * through omni-wheels that do not slip. It is driven entirely through the host HAL: each step it
+ * reads the duty cycles and direction pins the MotorHandler wrote, integrates the motors and the
+ * sphere, adds the wheels' quantized encoder counts to the counter units and publishes noisy IMU
+ * samples once their simulated BLE latency has passed. It also advances the simulated clock, so
+ * the control loop sees time move exactly as the plant does.
+ *
+ * Everything runs in simulated time on the calling thread, so a run is repeatable for a given
+ * seed and runs as fast as the host can integrate it
+ */
+class PlantSimulator {
+public:
+    /**
+     * Primary constructor. The eyeball starts at rest in the identity orientation
+     *
+     * @param parameters - The physical properties of the eyeball
+     * @param motors - The HAL channels of each motor
+     * @param seed - The seed for the sensor noise and latency
+     */
+    PlantSimulator(const PlantParameters &parameters, const std::array<SimulatedMotor, 3> &motors,
+                   const uint32_t &seed);
+
+    // Default destructor
+    ~PlantSimulator() = default;
+
+    // Delete copy-constructor and assignment-op
+    PlantSimulator(const PlantSimulator &) = delete;
+
+    PlantSimulator &operator=(const PlantSimulator &) = delete;
+
+    /**
+     * Put the eyeball at rest in an orientation and drop any IMU samples still in flight
+     *
+     * @param orientation - The orientation
+     */
+    void reset(const Quaternion &orientation);
+
+    /**
+     * Simulate the eyeball for a period of time, advancing the simulated clock with it
+     *
+     * @param us - The time to simulate in µs
+     */
+    void advance(const uint32_t &us);
+
+    /**
+     * Get the eyeball's true orientation
+     *
+     * @return The orientation
+     */
+    Quaternion getOrientation() const noexcept;
+
+    /**
+     * Get the eyeball's angular velocity in the world frame
+     *
+     * @return The angular velocity in rad/s
+     */
+    std::array<double, 3> getAngularVelocity() const noexcept;
+
+    /**
+     * Get the time simulated since construction
+     *
+     * @return The time in µs
+     */
+    uint64_t getTime() const noexcept;
+
+private:
+    /**
+     * Integrate one step
+     *
+     * @param dt - The step in s
+     */
+    void integrate(const double &dt);
+
+    /**
+     * Take an IMU sample of the eyeball and queue it for delivery
+     */
+    void sampleIMU();
+
+    /**
+     * Publish the IMU samples whose delivery time has passed
+     */
+    void deliverIMU();
+
+    /**
+     * Get the mean current through a motor over a PWM period, from the DRV8871 truth table for
+     * the levels of its driver's inputs
+     *
+     * @param motor - The motor
+     * @param backEMF - The motor's back-EMF in V
+     * @return The current in A
+     */
+    double readCurrent(const SimulatedMotor &motor, const double &backEMF) const;
+
+    /**
+     * An IMU sample waiting for its delivery time
+     */
+    struct PendingSample {
+        uint64_t deliveryTime;  // When the sample is received in µs
+        IMUSample sample;   // The sample
+    };
+
+    // Member variables
+    PlantParameters parameters; // The physical properties of the eyeball
+    std::array<SimulatedMotor, 3> motors;   // The HAL channels of each motor
+    std::array<std::array<double, 3>, 3> axes;  // The eyeball rotation that turns each wheel
+    std::array<std::array<double, 3>, 3> inverseInertia;    // The inverse of the total inertia
+    std::array<double, 4> orientation;  // The orientation quaternion {w, x, y, z}
+    std::array<double, 3> angularVelocity;  // The angular velocity in rad/s
+    std::array<double, 3> encoderRemainders;    // The partial encoder counts of each motor
+    std::deque<PendingSample> pendingSamples;   // The IMU samples in flight, oldest first
+    std::mt19937 generator; // The generator for the sensor noise and latency
+    uint64_t time;  // The simulated time in µs
+    uint64_t nextSampleTime;    // When the next IMU sample is taken in µs
+    uint32_t sequence;  // The sequence number of the next IMU sample
+};
+
+#endif // PLANTSIMULATOR_H
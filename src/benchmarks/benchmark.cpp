@@ -0,0 +1,7 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "benchmarks/benchmark.h"
+
+volatile float benchmarkSink = 0.0f;
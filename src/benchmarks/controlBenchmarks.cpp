@@ -0,0 +1,67 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "benchmarks/controlBenchmarks.h"
+#include "control/attitude.h"
+#include "control/kinematics.h"
+
+// The number of inputs cycled through, so the compiler cannot fold the calls into constants
+static constexpr size_t INPUT_COUNT = 64;
+
+// The number of IMU samples differentiated, as in ControlAlgoImpl
+static constexpr size_t VELOCITY_SAMPLES = 4;
+
+/**
+ * Get the rotation about an axis
+ */
+static Quat axisAngle(const Vec3 &axis, const float &angle) {
+    float s = sinf(angle / 2.0f);
+    return quatNormalize({cosf(angle / 2.0f), axis.x * s, axis.y * s, axis.z * s});
+}
+
+void runControlBenchmarks(const uint32_t &iterations, BenchmarkClock now, const char *unit) {
+    // Build the inputs: orientations with setpoints a small step apart and 10 ms of IMU samples
+    // turning at 1 rad/s
+    static Quat currents[INPUT_COUNT];
+    static Quat setpoints[INPUT_COUNT];
+    static Quat previousSetpoints[INPUT_COUNT];
+    static IMUSample samples[INPUT_COUNT][VELOCITY_SAMPLES];
+
+    for (size_t i(0); i < INPUT_COUNT; ++i) {
+        float angle = static_cast<float>(i) / INPUT_COUNT;
+        Vec3 axis = {cosf(angle * 6.0f), sinf(angle * 6.0f), 0.0f};
+        currents[i] = axisAngle(axis, angle);
+        previousSetpoints[i] = axisAngle(axis, angle + 0.05f);
+        setpoints[i] = axisAngle(axis, angle + 0.053f);
+
+        for (size_t j(0); j < VELOCITY_SAMPLES; ++j) {
+            samples[i][j].quaternion = toQuaternion(axisAngle(axis, angle - 0.01f * j));
+            samples[i][j].deviceTimestamp = 100000 - 10000 * j;
+        }
+    }
+
+    // Check the velocity estimate recovers the 1 rad/s
+    Vec3 velocity = {};
+    estimateAngularVelocity(samples[1], VELOCITY_SAMPLES, velocity);
+    Log.noticeln("Benchmark - Estimated angular speed (1 rad/s expected): %F rad/s",
+                 sqrtf(vecDot(velocity, velocity)));
+
+    benchmark("commandAngularVelocity", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return commandAngularVelocity(currents[i], setpoints[i], previousSetpoints[i], 0.001f,
+                                      8.0f, 6.0f).x;
+    });
+
+    benchmark("estimateAngularVelocity", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        Vec3 velocity = {};
+        estimateAngularVelocity(samples[i], VELOCITY_SAMPLES, velocity);
+        return velocity.x;
+    });
+
+    benchmark("Kinematics::inverse", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return DEFAULT_KINEMATICS.inverse(quatVector(currents[i])).x;
+    });
+}
@@ -0,0 +1,35 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "benchmarks/logBenchmarks.h"
+#include "logging/deferredLog.h"
+
+// The message timed, as the encoders' verbose message with one more argument
+static const char *FORMAT = "\tEncoder Counts:\t%d\t%d\t%d (%F)";
+
+void runLogBenchmarks(const uint32_t &iterations, BenchmarkClock now, const char *unit) {
+    // Write out any waiting messages first, so only the timed ones pass through the ring buffer.
+    // Each is taken back out right away so the buffer never fills
+    DeferredLog *log = DeferredLog::instance();
+    log->drain();
+    static LogRecord record;
+
+    benchmark("deferLog (4 arguments) + pop", iterations, now, unit,
+              [log](const uint32_t &iteration) {
+        deferLog(LOG_LEVEL_VERBOSE, FORMAT, iteration, iteration + 1, iteration + 2,
+                 static_cast<float>(iteration) * 0.5f);
+        log->pop(record);
+        return static_cast<float>(record.arguments[0]);
+    });
+
+    // The part of the drain that does not depend on the output's speed
+    static char line[LOG_LINE_SIZE];
+    record = {FORMAT, LOG_LEVEL_VERBOSE, 4, {{0, 0, 0, 0}}};
+    benchmark("DeferredLog::format (4 arguments)", iterations, now, unit,
+              [](const uint32_t &iteration) {
+        record.arguments[0] = iteration;
+        record.arguments[1] = iteration * 7;
+        return static_cast<float>(DeferredLog::format(record, line, sizeof(line)));
+    });
+}
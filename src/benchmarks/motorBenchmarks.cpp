@@ -0,0 +1,83 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "benchmarks/motorBenchmarks.h"
+#include "hal/gpio.h"
+#include "hal/pwm.h"
+#include "mechanism/motorHandler.h"
+
+// The number of inputs cycled through, so the compiler cannot fold the calls into constants
+static constexpr size_t INPUT_COUNT = 64;
+
+void runMotorBenchmarks(const std::array<std::array<uint8_t, 2>, 3> &motorPins,
+                        const uint32_t &iterations, BenchmarkClock now, const char *unit) {
+    // Build the inputs: forward speeds below full scale, the same speeds with alternating signs
+    // so every call reverses the motors, and the same speeds as commands with the wheels turning
+    static std::array<std::array<uint8_t, 2>, 3> pins;
+    static std::array<int16_t, 3> speeds[INPUT_COUNT];
+    static std::array<int16_t, 3> reversals[INPUT_COUNT];
+    static std::array<float, 3> commands[INPUT_COUNT];
+    static std::array<float, 3> wheelSpeeds[INPUT_COUNT];
+    pins = motorPins;
+    int16_t maxSpeed = MotorHandler::instance()->getMaxSpeed();
+
+    for (size_t i(0); i < INPUT_COUNT; ++i) {
+        for (size_t j(0); j < speeds[i].size(); ++j) {
+            speeds[i][j] = static_cast<int16_t>(1 + (i * 7 + j * 13) % maxSpeed);
+            reversals[i][j] = i % 2 == 0 ? speeds[i][j] : static_cast<int16_t>(-speeds[i][j]);
+            commands[i][j] = static_cast<float>(speeds[i][j]) / maxSpeed;
+            wheelSpeeds[i][j] = 20.0f * commands[i][j];
+        }
+    }
+
+    benchmark("gpioWrite + pwmWrite per motor", iterations, now, unit,
+              [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        for (size_t j(0); j < pins.size(); ++j) {
+            gpioWrite(pins[j][0], false);
+            pwmWrite(j, speeds[i][j]);
+        }
+        return static_cast<float>(speeds[i][0]);
+    });
+
+    benchmark("gpioWriteMask + pwmStage + pwmCommit", iterations, now, unit,
+              [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        uint64_t low = 0;
+        for (size_t j(0); j < pins.size(); ++j) {
+            low |= 1ULL << pins[j][0];
+            pwmStage(j, speeds[i][j]);
+        }
+        gpioWriteMask(0, low);
+        pwmCommit(0b111);
+        return static_cast<float>(speeds[i][0]);
+    });
+
+    // The window in which the batched outputs change
+    benchmark("pwmCommit (3 channels)", iterations, now, unit, [](const uint32_t &iteration) {
+        pwmCommit(0b111);
+        return static_cast<float>(iteration);
+    });
+
+    benchmark("MotorHandler::setMotorSpeeds", iterations, now, unit,
+              [](const uint32_t &iteration) {
+        return static_cast<float>(
+                MotorHandler::instance()->setMotorSpeeds(speeds[iteration % INPUT_COUNT])[0]);
+    });
+
+    // Most of these calls hold the motors in their deadtime
+    benchmark("MotorHandler::setMotorSpeeds (reversing)", iterations, now, unit,
+              [](const uint32_t &iteration) {
+        return static_cast<float>(
+                MotorHandler::instance()->setMotorSpeeds(reversals[iteration % INPUT_COUNT])[0]);
+    });
+
+    benchmark("MotorHandler::setMotorCommands", iterations, now, unit,
+              [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return MotorHandler::instance()->setMotorCommands(commands[i], wheelSpeeds[i]).applied[0];
+    });
+
+    MotorHandler::instance()->setMotorSpeeds({0, 0, 0});
+}
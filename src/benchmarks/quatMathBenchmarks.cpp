@@ -0,0 +1,195 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "benchmarks/quatMathBenchmarks.h"
+#include "control/quatmath.h"
+
+// The number of inputs cycled through, so the compiler cannot fold the calls into constants
+static constexpr size_t INPUT_COUNT = 64;
+
+/**
+ * Get a repeatable pseudo-random float in [-1, 1]
+ */
+static float nextRandom(uint32_t &state) {
+    state = state * 1664525UL + 1013904223UL;
+    return static_cast<float>(state >> 8) / 8388608.0f - 1.0f;
+}
+
+/**
+ * The textbook slerp on helper_3dmath, calling acos and sin every time
+ */
+static Quaternion referenceSlerp(Quaternion from, Quaternion to, const float &t) {
+    float cosHalf = from.w * to.w + from.x * to.x + from.y * to.y + from.z * to.z;
+    if (cosHalf < 0.0f) {
+        to = Quaternion(-to.w, -to.x, -to.y, -to.z);
+        cosHalf = -cosHalf;
+    }
+
+    float half = acosf(fminf(cosHalf, 1.0f));
+    float sinHalf = sinf(half);
+    if (sinHalf < 1.0e-6f) {
+        return from;
+    }
+
+    float a = sinf((1.0f - t) * half) / sinHalf;
+    float b = sinf(t * half) / sinHalf;
+    return Quaternion(a * from.w + b * to.w, a * from.x + b * to.x, a * from.y + b * to.y,
+                      a * from.z + b * to.z).getNormalized();
+}
+
+/**
+ * The rotation vector from one orientation to another on helper_3dmath (axis-angle via acos)
+ */
+static VectorFloat referenceAngularError(Quaternion from, Quaternion to) {
+    Quaternion error = from.getConjugate().getProduct(to);
+    if (error.w < 0.0f) {
+        error = Quaternion(-error.w, -error.x, -error.y, -error.z);
+    }
+
+    float angle = 2.0f * acosf(fminf(error.w, 1.0f));
+    float sinHalf = sqrtf(fmaxf(1.0f - error.w * error.w, 0.0f));
+    float scale = sinHalf < 1.0e-6f ? 2.0f : angle / sinHalf;
+    return VectorFloat(error.x * scale, error.y * scale, error.z * scale);
+}
+
+/**
+ * Rotate a vector on helper_3dmath as q * v * conj(q)
+ */
+static VectorFloat referenceRotate(Quaternion q, const VectorFloat &v) {
+    Quaternion p = q.getProduct(Quaternion(0.0f, v.x, v.y, v.z)).getProduct(q.getConjugate());
+    return VectorFloat(p.x, p.y, p.z);
+}
+
+void runQuatMathBenchmarks(const uint32_t &iterations, BenchmarkClock now, const char *unit) {
+    // Build the inputs: random orientations, a nearby and a distant orientation for each, slightly
+    // unnormalized copies and random vectors
+    static Quat orientations[INPUT_COUNT];
+    static Quat nearby[INPUT_COUNT];
+    static Quat distant[INPUT_COUNT];
+    static Quat unnormalized[INPUT_COUNT];
+    static Vec3 vectors[INPUT_COUNT];
+    static Quat batch[INPUT_COUNT];
+    uint32_t state = 1;
+
+    for (size_t i(0); i < INPUT_COUNT; ++i) {
+        orientations[i] = quatNormalize({nextRandom(state), nextRandom(state), nextRandom(state),
+                                         nextRandom(state)});
+        Quat small = quatNormalize({1.0f, 0.01f * nextRandom(state), 0.01f * nextRandom(state),
+                                    0.01f * nextRandom(state)});
+        nearby[i] = quatMultiply(orientations[i], small);
+        distant[i] = quatNormalize({nextRandom(state), nextRandom(state), nextRandom(state),
+                                    nextRandom(state)});
+        unnormalized[i] = quatScale(orientations[i], 1.0f + 0.05f * nextRandom(state));
+        vectors[i] = {nextRandom(state), nextRandom(state), nextRandom(state)};
+    }
+
+    // Check the kernels agree with helper_3dmath
+    float worst = 0.0f;
+    for (size_t i(0); i < INPUT_COUNT; ++i) {
+        Quaternion a = toQuaternion(orientations[i]);
+        Quaternion b = toQuaternion(distant[i]);
+        Quaternion product = a.getProduct(b);
+        Quat fastProduct = quatMultiply(orientations[i], distant[i]);
+        worst = fmaxf(worst, fabsf(product.w - fastProduct.w) + fabsf(product.z - fastProduct.z));
+
+        Quaternion normalized = toQuaternion(unnormalized[i]).getNormalized();
+        Quat fastNormalized = quatNormalize(unnormalized[i]);
+        worst = fmaxf(worst, fabsf(normalized.w - fastNormalized.w));
+
+        VectorFloat v(vectors[i].x, vectors[i].y, vectors[i].z);
+        VectorFloat rotated = referenceRotate(a, v);
+        Vec3 fastRotated = quatRotate(orientations[i], vectors[i]);
+        worst = fmaxf(worst, fabsf(rotated.x - fastRotated.x) + fabsf(rotated.z - fastRotated.z));
+
+        Quaternion slerped = referenceSlerp(a, toQuaternion(nearby[i]), 0.3f);
+        Quat fastSlerped = quatSlerp(orientations[i], nearby[i], 0.3f);
+        worst = fmaxf(worst, fabsf(slerped.w - fastSlerped.w) + fabsf(slerped.x - fastSlerped.x));
+
+        VectorFloat error = referenceAngularError(a, b);
+        Vec3 fastError = quatAngularError(orientations[i], distant[i]);
+        worst = fmaxf(worst, fabsf(error.x - fastError.x) + fabsf(error.y - fastError.y));
+    }
+    Log.noticeln("Benchmark - Largest difference from helper_3dmath: %F", worst);
+
+    benchmark("helper_3dmath getProduct", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        Quaternion a = toQuaternion(orientations[i]);
+        return a.getProduct(toQuaternion(distant[i])).z;
+    });
+    benchmark("quatMultiply", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatMultiply(orientations[i], distant[i]).z;
+    });
+
+    benchmark("helper_3dmath getNormalized", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return toQuaternion(unnormalized[i]).getNormalized().z;
+    });
+    benchmark("quatNormalize", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatNormalize(unnormalized[i]).z;
+    });
+    benchmark("quatRenormalize", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatRenormalize(unnormalized[i]).z;
+    });
+
+    benchmark("helper_3dmath rotate", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return referenceRotate(toQuaternion(orientations[i]),
+                               VectorFloat(vectors[i].x, vectors[i].y, vectors[i].z)).z;
+    });
+    benchmark("quatRotate", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatRotate(orientations[i], vectors[i]).z;
+    });
+
+    benchmark("textbook slerp (small angle)", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return referenceSlerp(toQuaternion(orientations[i]), toQuaternion(nearby[i]), 0.3f).z;
+    });
+    benchmark("quatSlerp (small angle)", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatSlerp(orientations[i], nearby[i], 0.3f).z;
+    });
+    benchmark("textbook slerp (large angle)", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return referenceSlerp(toQuaternion(orientations[i]), toQuaternion(distant[i]), 0.3f).z;
+    });
+    benchmark("quatSlerp (large angle)", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatSlerp(orientations[i], distant[i], 0.3f).z;
+    });
+    benchmark("quatStep (small angle)", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatStep(orientations[i], nearby[i], 0.003f).z;
+    });
+
+    benchmark("helper_3dmath angular error", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return referenceAngularError(toQuaternion(orientations[i]), toQuaternion(nearby[i])).z;
+    });
+    benchmark("quatAngularError", iterations, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        return quatAngularError(orientations[i], nearby[i]).z;
+    });
+
+    // The batch kernels are timed per item
+    uint32_t batches = iterations / INPUT_COUNT > 0 ? iterations / INPUT_COUNT : 1;
+    benchmark("quatMultiplyBatch (per item)", batches, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        quatMultiplyBatch(orientations, distant, batch, INPUT_COUNT);
+        return batch[i].z;
+    }, INPUT_COUNT);
+
+    // Normalizing unit quaternions costs the same, so the batch is normalized in place repeatedly
+    for (size_t i(0); i < INPUT_COUNT; ++i) {
+        batch[i] = unnormalized[i];
+    }
+    benchmark("quatNormalizeBatch (per item)", batches, now, unit, [](const uint32_t &iteration) {
+        size_t i = iteration % INPUT_COUNT;
+        quatNormalizeBatch(batch, INPUT_COUNT);
+        return batch[i].z;
+    }, INPUT_COUNT);
+}
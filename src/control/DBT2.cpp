@@ -1,70 +1,70 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #include "control/DBT2.h"
 
+// The default demonstration sequence
+static constexpr SequenceStep DEFAULT_SEQUENCE[] = {
+        // First run each motor forward individually
+        {{1, 0, 0}, 1000},
+        {{0, 1, 0}, 1000},
+        {{0, 0, 1}, 1000},
+        {{0, 0, 0}, 1000},
+
+        // Second run each motor backward individually
+        {{-1, 0, 0}, 1000},
+        {{0, -1, 0}, 1000},
+        {{0, 0, -1}, 1000},
+        {{0, 0, 0}, 1000},
+
+        // Third experiment with pairs of motors
+        {{1, 1, 0}, 1000},
+        {{0, 1, 1}, 1000},
+        {{1, 0, 1}, 1000},
+        {{0, 0, 0}, 1000}
+};
+
+// Set static variables
+const SequenceStep *DBT2::sequence = DEFAULT_SEQUENCE;
+size_t DBT2::sequenceLength = sizeof(DEFAULT_SEQUENCE) / sizeof(DEFAULT_SEQUENCE[0]);
+SequenceMode DBT2::sequenceMode = SequenceMode::Loop;
+
 DBT2::DBT2() : ControlAlgoImpl() {
-    Log.traceln("dbt2 Created");
+    DLOG_TRACE("dbt2 Created");
 }
 
-Quaternion DBT2::setTargetQuaternion() {
-    //todo update
-    Log.traceln("dbt2 target set");
-    return Quaternion();
+void DBT2::setSequence(const SequenceStep *steps, const size_t &length, const SequenceMode &mode)
+noexcept {
+    sequence = steps;
+    sequenceLength = length;
+    sequenceMode = mode;
 }
 
-void DBT2::PID() {
-    Log.traceln("executing DBT2 PID");
-    std::array<int16_t, 3> speeds;
-
-    // First run each motor forward individually
-    speeds = {1, 0, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
-
-    speeds = {0, 1, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
-
-    speeds = {0, 0, 1};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
-
-    speeds = {0, 0, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
-
-    // Second run each motor backward individually
-    speeds = {1, 0, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
-
-    speeds = {0, 1, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
-
-    speeds = {0, 0, 1};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
-
-    speeds = {0, 0, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
+void DBT2::enter() {
+    ControlAlgoImpl::enter();
+    DLOG_TRACE("dbt2 sequence started");
+    sequencer.load(sequence, sequenceLength, sequenceMode);
+    sequencer.start(millis());
+}
 
-    // Third experiment with pairs of motors
-    speeds = {1, 1, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
+void DBT2::exit() {
+    DLOG_TRACE("dbt2 sequence stopped");
+    sequencer.stop();
 
-    speeds = {0, 1, 1};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
+    // Stop at once rather than ramping down
+    MotorHandler::instance()->setMotorSpeeds({0, 0, 0});
+    ControlAlgoImpl::exit();
+}
 
-    speeds = {1, 0, 1};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-    delay(1000);
+Quat DBT2::setTargetQuaternion() {
+    //todo update
+    return QUAT_IDENTITY;
+}
 
-    speeds = {0, 0, 0};
-    MotorHandler::instance()->setMotorSpeeds(speeds);
-}
\ No newline at end of file
+void DBT2::PID() {
+    // Command the motors every tick so their ramps progress. The speeds are fractions of full
+    // scale
+    sequencer.update(millis());
+    MotorHandler::instance()->setMotorCommands(sequencer.getSpeeds(), measureWheelSpeeds());
+}
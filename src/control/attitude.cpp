@@ -0,0 +1,44 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "control/attitude.h"
+
+Vec3 commandAngularVelocity(const Quat &current, const Quat &setpoint, const Quat &previousSetpoint,
+                            const float &period, const float &gain, const float &maxSpeed)
+                            noexcept {
+    Quat error = quatError(current, setpoint);
+    Vec3 velocity = vecScale(quatLog(error), gain);
+
+    // The setpoint's velocity is in its own frame. The error rotates it into the body frame
+    if (period > 0.0f) {
+        Vec3 feedForward = vecScale(quatLog(quatError(previousSetpoint, setpoint)), 1.0f / period);
+        velocity = vecAdd(velocity, quatRotate(error, feedForward));
+    }
+
+    float speedSquared = vecDot(velocity, velocity);
+    if (speedSquared > maxSpeed * maxSpeed) {
+        velocity = vecScale(velocity, maxSpeed * fastInverseSqrt(speedSquared));
+    }
+
+    return velocity;
+}
+
+bool estimateAngularVelocity(const IMUSample *samples, const size_t &count, Vec3 &velocity)
+noexcept {
+    if (count < 2) {
+        return false;
+    }
+
+    const IMUSample &newest = samples[0];
+    const IMUSample &oldest = samples[count - 1];
+    uint32_t interval = newest.deviceTimestamp - oldest.deviceTimestamp;
+    if (interval == 0 || interval > 0x7FFFFFFF) {
+        return false;
+    }
+
+    Quat rotation = quatError(quatNormalize(toQuat(oldest.quaternion)),
+                              quatNormalize(toQuat(newest.quaternion)));
+    velocity = vecScale(quatLog(rotation), 1.0e6f / static_cast<float>(interval));
+    return true;
+}
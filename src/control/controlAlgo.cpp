@@ -1,11 +1,13 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #include "control/controlAlgo.h"
 
-ControlAlgo::~ControlAlgo() { delete bridge; }
-
 void ControlAlgo::execute() const { bridge->execute(); }
 
-ControlAlgo::ControlAlgo(ControlAlgoImpl *impl) : bridge(impl) {}
\ No newline at end of file
+void ControlAlgo::enter() const { bridge->enter(); }
+
+void ControlAlgo::exit() const { bridge->exit(); }
+
+ControlAlgo::ControlAlgo(ControlAlgoImpl *impl) : bridge(impl) {}
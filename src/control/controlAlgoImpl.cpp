@@ -1,58 +1,126 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/26/2024
+// Last Modified: 10/16/2026
 
 #include "control/controlAlgoImpl.h"
 
+// Set static variables
+float ControlAlgoImpl::maxAngularSpeed = 3.0f;
+float ControlAlgoImpl::attitudeGain = 8.0f;
+Kinematics ControlAlgoImpl::kinematics = DEFAULT_KINEMATICS;
+VelocityGains ControlAlgoImpl::velocityGains = DEFAULT_VELOCITY_GAINS;
+
 void ControlAlgoImpl::execute() {
-    setTargetQuaternion();
-    setCurrentQuaternion();
-    slerp();
+    targetQuat = setTargetQuaternion();
+    currentQuat = setCurrentQuaternion();
+    setpointQuat = slerp();
     calculateAngularVelocity();
     applyInverseKinematics();
     PID();
 }
 
-Quaternion ControlAlgoImpl::setCurrentQuaternion() {
-    return ClientHandler::instance()->getQuaternion();
+void ControlAlgoImpl::enter() {
+    setpointValid = false;
+
+    for (auto &controller : velocityControllers) {
+        controller.reset();
+    }
 }
 
-Quaternion ControlAlgoImpl::slerp() {
-    // Normalize the quats
-    currentQuat.normalize();
-    targetQuat.normalize();
+void ControlAlgoImpl::exit() {}
 
-    // Compute the dot product of the quats
-    float dot = (currentQuat.w * targetQuat.w) + (currentQuat.x * targetQuat.x) + (currentQuat.y
-            * targetQuat.y) + (currentQuat.z * targetQuat.z);
+void ControlAlgoImpl::setMaxAngularSpeed(const float &speed) {
+    if (!(speed > 0.0f)) {
+        throw std::logic_error("ControlAlgoImpl::setMaxAngularSpeed - Speed must be positive");
+    }
 
-    // Calculate the interpolation factor, t
-    float currentDistance = 1.0f - fabs(dot);
-    float t = (initialDistance - currentDistance) / initialDistance;
-    t = constrain(t, 0.0f, 1.0f);
+    maxAngularSpeed = speed;
+}
 
-    // If negative negate teh target to take the shorter path
-    if (dot < 0.0f) {
-        targetQuat = targetQuat;
-        dot = -dot;
+void ControlAlgoImpl::setAttitudeGain(const float &gain) {
+    if (!(gain > 0.0f)) {
+        throw std::logic_error("ControlAlgoImpl::setAttitudeGain - Gain must be positive");
     }
 
-    dot = constrain(dot, 0.0f, 1.0f);
+    attitudeGain = gain;
+}
+
+void ControlAlgoImpl::setDriveGeometry(const DriveGeometry &geometry) {
+    Kinematics drive(geometry);
+    if (!drive.isValid()) {
+        throw std::logic_error("ControlAlgoImpl::setDriveGeometry - The drive cannot turn about "
+                               "every axis");
+    }
 
-    float omega = acos(dot);
-    return {};
+    kinematics = drive;
+}
+
+void ControlAlgoImpl::setVelocityGains(const VelocityGains &gains) {
+    if (!(gains.proportional >= 0.0f) || !(gains.integral >= 0.0f) ||
+        !(gains.derivative >= 0.0f) || !(gains.feedForward >= 0.0f) ||
+        !(gains.derivativeFilter >= 0.0f)) {
+        throw std::logic_error("ControlAlgoImpl::setVelocityGains - Gains must not be negative");
+    }
+
+    velocityGains = gains;
+}
+
+Quat ControlAlgoImpl::setCurrentQuaternion() {
+    return quatNormalize(toQuat(consumeIMUSample().quaternion));
+}
+
+Quat ControlAlgoImpl::slerp() {
+    uint32_t now = micros();
+
+    // Start from where the eye is
+    if (!setpointValid) {
+        setpointQuat = currentQuat;
+        setpointValid = true;
+        lastTick = now;
+    }
+
+    tickPeriod = static_cast<float>(now - lastTick) * 1.0e-6f;
+    lastTick = now;
+    previousSetpoint = setpointQuat;
+
+    return quatStep(setpointQuat, quatNormalize(targetQuat), maxAngularSpeed * tickPeriod);
 }
 
 void ControlAlgoImpl::calculateAngularVelocity() {
-    //todo why am i even calculating angular velo? How do i know what i need to get from quat to
-    // velo
+    angularVelocityCommand = commandAngularVelocity(currentQuat, setpointQuat, previousSetpoint,
+                                                    tickPeriod, attitudeGain,
+                                                    COMMAND_HEADROOM * maxAngularSpeed);
 }
 
 void ControlAlgoImpl::applyInverseKinematics() {
-    // todo whats the math to go from the above to motor commands?
+    wheelSpeedCommand = kinematics.inverse(quatRotate(currentQuat, angularVelocityCommand));
+}
+
+std::array<float, 3> ControlAlgoImpl::measureWheelSpeeds() noexcept {
+    const EncoderState &encoders = EncoderHandler::instance()->getState();
+    std::array<float, 3> speeds = {};
+    for (size_t i(0); i < speeds.size(); ++i) {
+        speeds[i] = encoders.velocities[i] * kinematics.getRadiansPerCount();
+    }
+
+    return speeds;
 }
 
 void ControlAlgoImpl::PID() {
-    // todo figure out how to PID for motors (angular velo? position? etc. Will likely need
-    //  encoder data at some point)
-}
\ No newline at end of file
+    float targets[3] = {wheelSpeedCommand.x, wheelSpeedCommand.y, wheelSpeedCommand.z};
+    std::array<float, 3> measured = measureWheelSpeeds();
+    std::array<float, 3> duties = {};
+
+    for (size_t i(0); i < duties.size(); ++i) {
+        duties[i] = velocityControllers[i].update(targets[i], measured[i], tickPeriod,
+                                                  velocityGains);
+    }
+
+    // Hold the integrators of the wheels the motors could not follow
+    MotorOutput output = MotorHandler::instance()->setMotorCommands(duties, measured);
+    for (size_t i(0); i < duties.size(); ++i) {
+        if (output.saturated[i]) {
+            velocityControllers[i].saturate(output.applied[i]);
+        }
+    }
+}
@@ -1,39 +1,97 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #include "control/factory.h"
+#include <new>
 
-ControlAlgo Factory::makeControlAlgo(const std::array<uint8_t, 3> &switchInput) {
-    Log.traceln("Factory::makeControlAlgo - Begin");
+// Set static variables
+std::aligned_storage<sizeof(DBT2), alignof(DBT2)>::type Factory::dbt2Storage;
+std::aligned_storage<sizeof(PathFollowing), alignof(PathFollowing)>::type
+        Factory::pathFollowingStorage;
+std::aligned_storage<sizeof(Joystick), alignof(Joystick)>::type Factory::joystickStorage;
+std::aligned_storage<sizeof(Sentient), alignof(Sentient)>::type Factory::sentientStorage;
+DBT2 *Factory::dbt2 = nullptr;
+PathFollowing *Factory::pathFollowing = nullptr;
+Joystick *Factory::joystick = nullptr;
+Sentient *Factory::sentient = nullptr;
 
+Factory::Factory() : mode(ControlMode::None), active(nullptr) {}
+
+ControlAlgo &Factory::makeControlAlgo(const std::array<uint8_t, 3> &switchInput) {
+    ControlMode selected = parseSwitchInput(switchInput);
+
+    // Keep running the active algo unless the selection changed
+    if (selected == mode) {
+        return active;
+    }
+
+    DLOG_TRACE("Factory::makeControlAlgo - Switching modes");
+    if (mode != ControlMode::None) {
+        active.exit();
+    }
+
+    switch (selected) {
+        case ControlMode::DBT2:
+            DLOG_TRACE("Making DBT2");
+            active = makeDBT2();
+            break;
+        case ControlMode::PathFollowing:
+            DLOG_TRACE("Making PathFollowing");
+            active = makePathFollowing();
+            break;
+        case ControlMode::Joystick:
+            DLOG_TRACE("Making Joystick");
+            active = makeJoystick();
+            break;
+        default:
+            DLOG_TRACE("Making Sentient");
+            active = makeSentient();
+            break;
+    }
+
+    mode = selected;
+    active.enter();
+    return active;
+}
+
+ControlMode Factory::getMode() const noexcept {
+    return mode;
+}
+
+ControlMode Factory::parseSwitchInput(const std::array<uint8_t, 3> &switchInput) noexcept {
     if (switchInput[0] == 1) {
-        Log.traceln("Making DBT2");
-        return makeDBT2();
+        return ControlMode::DBT2;
     } else if (switchInput[1] == 1) {
-        Log.traceln("Making PathFollowing");
-        return makePathFollowing();
+        return ControlMode::PathFollowing;
     } else if (switchInput[2] == 1) {
-        Log.traceln("Making Joystick");
-        return makeJoystick();
+        return ControlMode::Joystick;
     } else {
-        Log.traceln("Making Sentient");
-        return makeSentient();
+        return ControlMode::Sentient;
     }
 }
 
 ControlAlgo Factory::makeDBT2() {
-   return ControlAlgo(new DBT2());
+   return ControlAlgo(construct(dbt2, &dbt2Storage));
 }
 
 ControlAlgo Factory::makePathFollowing() {
-    return ControlAlgo(new PathFollowing());
+    return ControlAlgo(construct(pathFollowing, &pathFollowingStorage));
 }
 
 ControlAlgo Factory::makeJoystick() {
-    return ControlAlgo(new Joystick());
+    return ControlAlgo(construct(joystick, &joystickStorage));
 }
 
 ControlAlgo Factory::makeSentient() {
-    return ControlAlgo(new Sentient());
-}
\ No newline at end of file
+    return ControlAlgo(construct(sentient, &sentientStorage));
+}
+
+template<typename T>
+T *Factory::construct(T *&instance, void *storage) {
+    if (instance == nullptr) {
+        instance = new(storage) T();
+    }
+
+    return instance;
+}
@@ -1,15 +1,15 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/27/2024
+// Last Modified: 10/16/2026
 
 #include "control/joystick.h"
 
 Joystick::Joystick() : ControlAlgoImpl() {
-    Log.traceln("joystick Created");
+    DLOG_TRACE("joystick Created");
 }
 
-Quaternion Joystick::setTargetQuaternion() {
+Quat Joystick::setTargetQuaternion() {
     //todo update
-    Log.traceln("joystick executed");
-    return Quaternion();
+    DLOG_TRACE("joystick executed");
+    return QUAT_IDENTITY;
 }
\ No newline at end of file
@@ -1,15 +1,15 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/27/2024
+// Last Modified: 10/16/2026
 
 #include "control/pathFollowing.h"
 
 PathFollowing::PathFollowing() : ControlAlgoImpl() {
-    Log.traceln("pathfollowing Created");
+    DLOG_TRACE("pathfollowing Created");
 }
 
-Quaternion PathFollowing::setTargetQuaternion() {
+Quat PathFollowing::setTargetQuaternion() {
     //todo
-    Log.traceln("pathfollowing executed");
-    return Quaternion();
+    DLOG_TRACE("pathfollowing executed");
+    return QUAT_IDENTITY;
 }
\ No newline at end of file
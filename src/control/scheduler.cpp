@@ -0,0 +1,130 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "control/scheduler.h"
+#include <stdexcept>
+#include "hal/clock.h"
+#include "hal/tickTimer.h"
+
+// Set static variables
+Scheduler *Scheduler::inst = nullptr;
+bool Scheduler::initialized = false;
+
+Scheduler::~Scheduler() noexcept {
+    tickTimerStop();
+    inst = nullptr;
+}
+
+Scheduler *Scheduler::instance() {
+    if (inst == nullptr) {
+        inst = new Scheduler();
+    }
+
+    return inst;
+}
+
+void Scheduler::initialize(const uint32_t &RATE, const uint8_t &TIMER, Callback callback) {
+    DLOG_TRACE("Scheduler::initialize - Begin");
+
+    // Only initialize once
+    if (initialized) {
+        throw std::runtime_error("Scheduler::initialize can only be called once");
+    }
+
+    // Ensure params are valid
+    if (RATE == 0 || RATE > 10000) {
+        throw std::logic_error("Scheduler::initialize - Invalid RATE");
+    }
+
+    if (TIMER >= TICK_TIMER_COUNT) {
+        throw std::logic_error("Scheduler::initialize - Invalid TIMER");
+    }
+
+    if (callback == nullptr) {
+        throw std::logic_error("Scheduler::initialize - Invalid callback");
+    }
+
+    period = 1000000 / RATE;
+    timerNumber = TIMER;
+    this->callback = callback;
+
+    initialized = true;
+    DLOG_INFO("Scheduler::initialize - Scheduler initialized successfully");
+    DLOG_TRACE("Scheduler::initialize - End");
+}
+
+void Scheduler::tick(const uint32_t &now, const uint32_t &pending) {
+    // Ticks that were never serviced are deadline misses
+    if (pending > 1) {
+        statistics.deadlineMisses += pending - 1;
+    }
+
+    // Measure how far the interval deviated from the expected period(s)
+    if (!firstTick) {
+        uint32_t interval = now - lastTick;
+        uint32_t expected = period * (pending > 0 ? pending : 1);
+        uint32_t jitter = interval > expected ? interval - expected : expected - interval;
+
+        if (jitter > statistics.worstJitter) {
+            statistics.worstJitter = jitter;
+        }
+    }
+    firstTick = false;
+    lastTick = now;
+
+    // Run and time the callback
+    callback();
+    uint32_t executionTime = clockMicros() - now;
+
+    statistics.lastExecutionTime = executionTime;
+    if (executionTime > statistics.worstExecutionTime) {
+        statistics.worstExecutionTime = executionTime;
+    }
+
+    // Overrunning the period also misses the next deadline
+    if (executionTime > period) {
+        ++statistics.deadlineMisses;
+    }
+
+    ++statistics.ticks;
+}
+
+SchedulerStatistics Scheduler::getStatistics() const noexcept {
+    return statistics;
+}
+
+void Scheduler::resetStatistics() noexcept {
+    statistics = {};
+    firstTick = true;
+}
+
+uint32_t Scheduler::getPeriod() const noexcept {
+    return period;
+}
+
+void Scheduler::loop() {
+    if (!initialized) {
+        throw std::runtime_error("Scheduler::loop - Scheduler is not initialized");
+    }
+
+    if (!tickTimerStart(timerNumber, period)) {
+        throw std::runtime_error("Scheduler::loop - Failed to start the tick timer");
+    }
+    DLOG_INFO("Scheduler::loop - Running at a period of %u us", period);
+
+    while (true) {
+        try {
+            // Block until the timer fires. The count includes any ticks that were not serviced
+            uint32_t pending = tickTimerWait();
+
+            if (pending > 0) {
+                tick(clockMicros(), pending);
+            }
+        } catch (const std::exception &ex) {
+            DLOG_DIRECT(LOG_LEVEL_ERROR, "Scheduler::Loop execution failed - %s", ex.what());
+        } catch (...) {
+            DLOG_ERROR("Scheduler::Loop execution failed - Unknown Error");
+        }
+    }
+}
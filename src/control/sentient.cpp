@@ -1,15 +1,15 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/27/2024
+// Last Modified: 10/16/2026
 
 #include "control/sentient.h"
 
 Sentient::Sentient() : ControlAlgoImpl() {
-    Log.traceln("Sentient Created");
+    DLOG_TRACE("Sentient Created");
 }
 
-Quaternion Sentient::setTargetQuaternion() {
+Quat Sentient::setTargetQuaternion() {
     //todo update
-    Log.traceln("Sentient executed");
-    return {};
+    DLOG_TRACE("Sentient executed");
+    return QUAT_IDENTITY;
 }
\ No newline at end of file
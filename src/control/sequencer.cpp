@@ -0,0 +1,66 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "control/sequencer.h"
+
+void Sequencer::load(const SequenceStep *steps, const size_t &length, const SequenceMode &mode)
+noexcept {
+    stop();
+    this->steps = steps;
+    this->length = steps != nullptr ? length : 0;
+    this->mode = mode;
+}
+
+void Sequencer::start(const uint32_t &now) noexcept {
+    if (length == 0) {
+        stop();
+        return;
+    }
+
+    index = 0;
+    stepStart = now;
+    running = true;
+    speeds = steps[0].speeds;
+    changed = true;
+}
+
+void Sequencer::stop() noexcept {
+    changed = running || speeds != std::array<float, 3>{0, 0, 0};
+    running = false;
+    speeds = {0, 0, 0};
+}
+
+bool Sequencer::update(const uint32_t &now) noexcept {
+    // Advance past every step that has elapsed. Bounded by the table length so a table of
+    // zero-duration steps cannot spin forever
+    for (size_t i(0); running && i < length && now - stepStart >= steps[index].duration; ++i) {
+        stepStart += steps[index].duration;
+
+        if (++index >= length) {
+            if (mode == SequenceMode::Loop) {
+                index = 0;
+            } else {
+                stop();
+                break;
+            }
+        }
+
+        if (steps[index].speeds != speeds) {
+            speeds = steps[index].speeds;
+            changed = true;
+        }
+    }
+
+    bool result = changed;
+    changed = false;
+    return result;
+}
+
+const std::array<float, 3> &Sequencer::getSpeeds() const noexcept {
+    return speeds;
+}
+
+bool Sequencer::isRunning() const noexcept {
+    return running;
+}
@@ -0,0 +1,60 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "control/velocityController.h"
+
+// The largest duty the integrator may hold. The driver cannot apply more than full scale, so a
+// larger integral would only add windup
+static constexpr float INTEGRAL_LIMIT = 1.0f;
+
+void VelocityController::reset() noexcept {
+    integral = 0.0f;
+    lastIncrement = 0.0f;
+    output = 0.0f;
+    started = false;
+}
+
+float VelocityController::update(const float &target, const float &measured, const float &period,
+                                 const VelocityGains &gains) noexcept {
+    // Seed the filter so the first derivative is 0
+    if (!started) {
+        filteredMeasurement = measured;
+        started = true;
+    }
+
+    float error = target - measured;
+    float derivative = 0.0f;
+    lastIncrement = 0.0f;
+
+    if (period > 0.0f) {
+        // Integrate, keeping the integrator within what the driver can apply
+        float previousIntegral = integral;
+        integral += gains.integral * error * period;
+        integral = integral > INTEGRAL_LIMIT ? INTEGRAL_LIMIT :
+                   integral < -INTEGRAL_LIMIT ? -INTEGRAL_LIMIT : integral;
+        lastIncrement = integral - previousIntegral;
+
+        // Differentiate the low-pass filtered measurement
+        float previousMeasurement = filteredMeasurement;
+        filteredMeasurement += (measured - filteredMeasurement) * period /
+                               (gains.derivativeFilter + period);
+        derivative = (filteredMeasurement - previousMeasurement) / period;
+    }
+
+    output = gains.feedForward * target + gains.proportional * error + integral -
+             gains.derivative * derivative;
+    return output;
+}
+
+void VelocityController::saturate(const float &applied) noexcept {
+    // Only undo an integration that drove the output further past the limit
+    if (lastIncrement * (output - applied) > 0.0f) {
+        integral -= lastIncrement;
+        lastIncrement = 0.0f;
+    }
+}
+
+float VelocityController::getIntegral() const noexcept {
+    return integral;
+}
@@ -0,0 +1,18 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Arduino.h>
+#include "hal/clock.h"
+
+uint32_t clockMicros() {
+    return micros();
+}
+
+uint32_t clockMillis() {
+    return millis();
+}
+
+void clockDelay(const uint32_t &ms) {
+    delay(ms);
+}
@@ -0,0 +1,34 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Arduino.h>
+#include <soc/gpio_reg.h>
+#include "hal/gpio.h"
+
+void gpioOutput(const uint8_t &pin) {
+    pinMode(pin, OUTPUT);
+}
+
+void gpioInput(const uint8_t &pin, const bool &pullUp) {
+    pinMode(pin, pullUp ? INPUT_PULLUP : INPUT);
+}
+
+void gpioWrite(const uint8_t &pin, const bool &level) {
+    digitalWrite(pin, level ? HIGH : LOW);
+}
+
+void gpioWriteMask(const uint64_t &high, const uint64_t &low) {
+    // The set and clear registers only change the pins whose bits are set. Pins 32 - 39 have
+    // their own registers, which are skipped when none of them change
+    REG_WRITE(GPIO_OUT_W1TS_REG, static_cast<uint32_t>(high));
+    REG_WRITE(GPIO_OUT_W1TC_REG, static_cast<uint32_t>(low));
+    if (((high | low) >> 32) != 0) {
+        REG_WRITE(GPIO_OUT1_W1TS_REG, static_cast<uint32_t>(high >> 32));
+        REG_WRITE(GPIO_OUT1_W1TC_REG, static_cast<uint32_t>(low >> 32));
+    }
+}
+
+bool gpioRead(const uint8_t &pin) {
+    return digitalRead(pin) == HIGH;
+}
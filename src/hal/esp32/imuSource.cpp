@@ -0,0 +1,10 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "hal/imuSource.h"
+#include "mechanism/clientHandler.h"
+
+IMUSample consumeIMUSample() {
+    return ClientHandler::instance()->consumeSample();
+}
@@ -0,0 +1,147 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Arduino.h>
+#include <driver/ledc.h>
+#include <soc/ledc_struct.h>
+#include "hal/pwm.h"
+
+/**
+ * The settings of an LEDC timer
+ */
+struct TimerSettings {
+    uint32_t frequency; // The frequency of the timer in Hz (0 if unused)
+    uint8_t resolution; // The resolution of the timer in bits
+};
+
+// The resolution of each channel, for the full duty cycle
+static uint8_t resolutions[PWM_CHANNEL_COUNT] = {};
+
+// The timer of each channel, and the settings of each timer of the high and low speed groups
+static ledc_timer_t timers[PWM_CHANNEL_COUNT] = {};
+static TimerSettings timerSettings[LEDC_SPEED_MODE_MAX][LEDC_TIMER_MAX] = {};
+
+/**
+ * Get the value of the duty register for a duty cycle. As in ledcWrite, the full duty cycle is
+ * raised by one so the output stays high
+ *
+ * @param channel - The channel
+ * @param duty - The duty cycle
+ * @return The duty cycle to write
+ */
+static uint32_t registerDuty(const uint8_t &channel, const uint32_t &duty) {
+    return duty == (1UL << resolutions[channel]) - 1 && duty != 1 ? duty + 1 : duty;
+}
+
+bool pwmSetup(const uint8_t &channel, const uint32_t &frequency, const uint8_t &resolution) {
+    if (channel >= PWM_CHANNEL_COUNT) {
+        return false;
+    }
+
+    // Channels 0 - 7 are the high speed group and 8 - 15 the low speed group. Channels of a group
+    // with the same frequency and resolution share a timer, so their periods line up and duties
+    // committed together switch in the same period (ledcSetup gives every 2 channels a timer)
+    auto group = static_cast<ledc_mode_t>(channel / 8);
+    TimerSettings *settings = timerSettings[group];
+    uint8_t timer = 0;
+    while (timer < LEDC_TIMER_MAX && settings[timer].frequency != 0 &&
+           (settings[timer].frequency != frequency || settings[timer].resolution != resolution)) {
+        ++timer;
+    }
+
+    if (timer >= LEDC_TIMER_MAX) {
+        return false;
+    }
+
+    if (settings[timer].frequency == 0) {
+        ledc_timer_config_t config = {};
+        config.speed_mode = group;
+        config.duty_resolution = static_cast<ledc_timer_bit_t>(resolution);
+        config.timer_num = static_cast<ledc_timer_t>(timer);
+        config.freq_hz = frequency;
+        config.clk_cfg = LEDC_AUTO_CLK;
+        if (ledc_timer_config(&config) != ESP_OK) {
+            return false;
+        }
+        settings[timer] = {frequency, resolution};
+    }
+
+    resolutions[channel] = resolution;
+    timers[channel] = static_cast<ledc_timer_t>(timer);
+    return true;
+}
+
+void pwmAttach(const uint8_t &pin, const uint8_t &channel) {
+    if (channel >= PWM_CHANNEL_COUNT) {
+        return;
+    }
+
+    // Route the channel to the pin, clocked by the timer pwmSetup chose
+    ledc_channel_config_t config = {};
+    config.gpio_num = pin;
+    config.speed_mode = static_cast<ledc_mode_t>(channel / 8);
+    config.channel = static_cast<ledc_channel_t>(channel % 8);
+    config.intr_type = LEDC_INTR_DISABLE;
+    config.timer_sel = timers[channel];
+    config.duty = 0;
+    config.hpoint = 0;
+    ledc_channel_config(&config);
+}
+
+void pwmWrite(const uint8_t &channel, const uint32_t &duty) {
+    if (channel >= PWM_CHANNEL_COUNT) {
+        return;
+    }
+
+    auto group = static_cast<ledc_mode_t>(channel / 8);
+    auto groupChannel = static_cast<ledc_channel_t>(channel % 8);
+    ledc_set_duty(group, groupChannel, registerDuty(channel, duty));
+    ledc_update_duty(group, groupChannel);
+}
+
+void pwmStage(const uint8_t &channel, const uint32_t &duty) {
+    if (channel >= PWM_CHANNEL_COUNT) {
+        return;
+    }
+
+    // The duty register has 4 fractional bits
+    uint32_t value = registerDuty(channel, duty);
+    LEDC.channel_group[channel / 8].channel[channel % 8].duty.duty = value << 4;
+}
+
+void pwmCommit(const uint16_t &channels) {
+    uint32_t remaining = channels;
+    while (remaining != 0) {
+        uint8_t channel = __builtin_ctz(remaining);
+        remaining &= remaining - 1;
+
+        // The new duty takes over at the end of the current period. The low speed channels also
+        // have to be told to update
+        auto &registers = LEDC.channel_group[channel / 8].channel[channel % 8];
+        registers.conf0.sig_out_en = 1;
+        registers.conf1.duty_start = 1;
+        if (channel >= 8) {
+            registers.conf0.low_speed_update = 1;
+        }
+    }
+}
+
+void pwmHold(const uint16_t &channels) {
+    uint32_t remaining = channels;
+    while (remaining != 0) {
+        uint8_t channel = __builtin_ctz(remaining);
+        remaining &= remaining - 1;
+
+        // A disabled output goes to its idle level immediately. The full duty is latched at the
+        // end of the period, so the channel stays high when it is next committed
+        auto &registers = LEDC.channel_group[channel / 8].channel[channel % 8];
+        registers.conf0.idle_lv = 1;
+        registers.conf0.sig_out_en = 0;
+        registers.duty.duty = registerDuty(channel, (1UL << resolutions[channel]) - 1) << 4;
+        registers.conf1.duty_start = 1;
+        if (channel >= 8) {
+            registers.conf0.low_speed_update = 1;
+        }
+    }
+}
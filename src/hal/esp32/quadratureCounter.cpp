@@ -0,0 +1,102 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Arduino.h>
+#include <driver/pcnt.h>
+#include "hal/counterExtension.h"
+#include "hal/quadratureCounter.h"
+
+// The software extension of each unit's 16-bit counter
+static CounterExtension extensions[COUNTER_UNIT_COUNT];
+
+/**
+ * Read a unit's 16-bit counter
+ *
+ * @param unit - The counter unit
+ * @param raw - Set to the counter's value
+ * @return True if the counter could be read
+ */
+static bool readRaw(const uint8_t &unit, int16_t &raw) {
+    return pcnt_get_counter_value(static_cast<pcnt_unit_t>(unit), &raw) == ESP_OK;
+}
+
+bool counterAttach(const uint8_t &unit, const uint8_t &pinA, const uint8_t &pinB) {
+    if (unit >= COUNTER_UNIT_COUNT) {
+        return false;
+    }
+
+    pinMode(pinA, INPUT_PULLUP);
+    pinMode(pinB, INPUT_PULLUP);
+
+    // Full quad: each channel counts both edges of one signal, in the direction set by the other
+    pcnt_config_t config = {};
+    config.unit = static_cast<pcnt_unit_t>(unit);
+    config.counter_h_lim = COUNTER_LIMIT;
+    config.counter_l_lim = -COUNTER_LIMIT;
+
+    config.channel = PCNT_CHANNEL_0;
+    config.pulse_gpio_num = pinA;
+    config.ctrl_gpio_num = pinB;
+    config.pos_mode = PCNT_COUNT_DEC;
+    config.neg_mode = PCNT_COUNT_INC;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_REVERSE;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
+
+    config.channel = PCNT_CHANNEL_1;
+    config.pulse_gpio_num = pinB;
+    config.ctrl_gpio_num = pinA;
+    config.lctrl_mode = PCNT_MODE_REVERSE;
+    config.hctrl_mode = PCNT_MODE_KEEP;
+    if (pcnt_unit_config(&config) != ESP_OK) {
+        return false;
+    }
+
+    // Reject glitches shorter than 250 APB cycles (~3 us)
+    pcnt_set_filter_value(config.unit, 250);
+    pcnt_filter_enable(config.unit);
+
+    // The limit events also gate the counter's reset at the limits, so they stay enabled (the
+    // unit config disables them). Their interrupt stays masked, as the wraps are found by sampling
+    if (pcnt_event_enable(config.unit, PCNT_EVT_H_LIM) != ESP_OK ||
+        pcnt_event_enable(config.unit, PCNT_EVT_L_LIM) != ESP_OK) {
+        return false;
+    }
+    pcnt_intr_disable(config.unit);
+
+    pcnt_counter_pause(config.unit);
+    pcnt_counter_clear(config.unit);
+    pcnt_counter_resume(config.unit);
+    extensions[unit].write(0, 0);
+    return true;
+}
+
+int64_t counterRead(const uint8_t &unit) {
+    int16_t raw;
+    if (unit >= COUNTER_UNIT_COUNT || !readRaw(unit, raw)) {
+        return unit < COUNTER_UNIT_COUNT ? extensions[unit].get() : 0;
+    }
+
+    return extensions[unit].update(raw);
+}
+
+bool counterClear(const uint8_t &unit) {
+    // The counter keeps running, so no edge is lost while it is cleared
+    int16_t raw;
+    if (unit >= COUNTER_UNIT_COUNT || !readRaw(unit, raw)) {
+        return false;
+    }
+
+    extensions[unit].write(0, raw);
+    return true;
+}
+
+void counterWrite(const uint8_t &unit, const int64_t &count) {
+    int16_t raw;
+    if (unit < COUNTER_UNIT_COUNT && readRaw(unit, raw)) {
+        extensions[unit].write(count, raw);
+    }
+}
@@ -0,0 +1,52 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Arduino.h>
+#include "hal/tickTimer.h"
+
+static hw_timer_t *timer = nullptr; // The running hardware timer
+static TaskHandle_t taskHandle = nullptr;   // The task notified by the timer
+
+/**
+ * Interrupt service routine for the hardware timer. Notifies the waiting task
+ */
+static void IRAM_ATTR onTimer() {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(taskHandle, &higherPriorityTaskWoken);
+
+    if (higherPriorityTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+bool tickTimerStart(const uint8_t &number, const uint32_t &period) {
+    if (timer != nullptr || number >= TICK_TIMER_COUNT || period == 0) {
+        return false;
+    }
+
+    // Start the timer with 1 µs resolution (80 MHz APB clock / 80)
+    taskHandle = xTaskGetCurrentTaskHandle();
+    timer = timerBegin(number, 80, true);
+    if (timer == nullptr) {
+        return false;
+    }
+
+    timerAttachInterrupt(timer, &onTimer, true);
+    timerAlarmWrite(timer, period, true);
+    timerAlarmEnable(timer);
+    return true;
+}
+
+void tickTimerStop() {
+    if (timer != nullptr) {
+        timerAlarmDisable(timer);
+        timerEnd(timer);
+        timer = nullptr;
+    }
+}
+
+uint32_t tickTimerWait() {
+    // The notification value counts the ticks given since it was last taken
+    return ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
@@ -0,0 +1,104 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <cstdio>
+#include <Arduino.h>
+#include <ArduinoLog.h>
+
+// The global instances the Arduino core and ArduinoLog provide on target
+HardwareSerial Serial;
+Logging Log;
+
+// The prefix of each level
+static const char *LEVEL_PREFIXES[] = {"", "F: ", "E: ", "W: ", "I: ", "T: ", "V: "};
+
+void Logging::begin(const int &level, Print *output, const bool &showLevel) {
+    this->level = constrain(level, LOG_LEVEL_SILENT, LOG_LEVEL_VERBOSE);
+    this->showLevel = showLevel;
+}
+
+void Logging::print(const int &messageLevel, const bool &newline, const char *msg, ...) {
+    if (messageLevel > level || messageLevel <= LOG_LEVEL_SILENT) {
+        return;
+    }
+
+    if (showLevel) {
+        fputs(LEVEL_PREFIXES[messageLevel], stdout);
+    }
+
+    // Translate ArduinoLog's format specifiers to printf's
+    va_list args;
+    va_start(args, msg);
+    for (const char *c = msg; *c != '\0'; ++c) {
+        if (*c != '%') {
+            fputc(*c, stdout);
+            continue;
+        }
+
+        switch (*++c) {
+            case '\0':
+                --c;
+                break;
+            case 's':
+            case 'S':
+                fputs(va_arg(args, const char *), stdout);
+                break;
+            case 'c':
+                fputc(va_arg(args, int), stdout);
+                break;
+            case 'd':
+            case 'i':
+                printf("%d", va_arg(args, int));
+                break;
+            case 'l':
+                printf("%ld", va_arg(args, long));
+                break;
+            case 'u':
+                printf("%u", va_arg(args, unsigned int));
+                break;
+            case 'x':
+                printf("%x", va_arg(args, unsigned int));
+                break;
+            case 'X':
+                printf("0x%x", va_arg(args, unsigned int));
+                break;
+            case 'b':
+            case 'B': {
+                unsigned int value = va_arg(args, unsigned int);
+                if (*c == 'B') {
+                    fputs("0b", stdout);
+                }
+                int bit = 31;
+                while (bit > 0 && ((value >> bit) & 1) == 0) {
+                    --bit;
+                }
+                for (; bit >= 0; --bit) {
+                    fputc((value >> bit) & 1 ? '1' : '0', stdout);
+                }
+                break;
+            }
+            case 't':
+                fputc(va_arg(args, int) ? 'T' : 'F', stdout);
+                break;
+            case 'T':
+                fputs(va_arg(args, int) ? "true" : "false", stdout);
+                break;
+            case 'D':
+            case 'F':
+                printf("%f", va_arg(args, double));
+                break;
+            case 'p':
+                printf("%p", va_arg(args, void *));
+                break;
+            default:
+                fputc(*c, stdout);
+                break;
+        }
+    }
+    va_end(args);
+
+    if (newline) {
+        fputc('\n', stdout);
+    }
+}
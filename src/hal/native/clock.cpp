@@ -0,0 +1,52 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <chrono>
+#include <thread>
+#include "hal/clock.h"
+#include "hal/native/hostHAL.h"
+
+// The start of the steady clock
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+// The simulated clock
+static bool simulated = false;
+static uint64_t simulatedTime = 0;  // The simulated time in µs
+
+/**
+ * Get the time since startup in µs from whichever clock is in use
+ */
+static uint64_t now() {
+    if (simulated) {
+        return simulatedTime;
+    }
+
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+uint32_t clockMicros() {
+    return static_cast<uint32_t>(now());
+}
+
+uint32_t clockMillis() {
+    return static_cast<uint32_t>(now() / 1000);
+}
+
+void clockDelay(const uint32_t &ms) {
+    if (simulated) {
+        simulatedTime += static_cast<uint64_t>(ms) * 1000;
+    } else {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+    }
+}
+
+void hostClockSimulate(const bool &simulate) {
+    simulated = simulate;
+    simulatedTime = 0;
+}
+
+void hostClockAdvance(const uint32_t &us) {
+    simulatedTime += us;
+}
@@ -0,0 +1,41 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "hal/gpio.h"
+#include "hal/native/hostHAL.h"
+
+// The level of each pin
+static bool levels[GPIO_PIN_COUNT] = {};
+
+void gpioOutput(const uint8_t &pin) {}
+
+void gpioInput(const uint8_t &pin, const bool &pullUp) {
+    if (pin < GPIO_PIN_COUNT) {
+        levels[pin] = pullUp;
+    }
+}
+
+void gpioWrite(const uint8_t &pin, const bool &level) {
+    if (pin < GPIO_PIN_COUNT) {
+        levels[pin] = level;
+    }
+}
+
+void gpioWriteMask(const uint64_t &high, const uint64_t &low) {
+    // Visit only the pins that change, setting wins if a pin is in both masks
+    uint64_t pins = (high | low) & ((1ULL << GPIO_PIN_COUNT) - 1);
+    while (pins != 0) {
+        uint8_t pin = __builtin_ctzll(pins);
+        levels[pin] = (high >> pin) & 1;
+        pins &= pins - 1;
+    }
+}
+
+bool gpioRead(const uint8_t &pin) {
+    return pin < GPIO_PIN_COUNT && levels[pin];
+}
+
+void hostGPIOSet(const uint8_t &pin, const bool &level) {
+    gpioWrite(pin, level);
+}
@@ -0,0 +1,20 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "hal/imuSource.h"
+#include "hal/native/hostHAL.h"
+#include "mechanism/sampleHistory.h"
+
+// The published samples
+static SampleHistory<IMUSample, 64> history;
+
+IMUSample consumeIMUSample() {
+    IMUSample latest = {};
+    history.latest(latest);
+    return latest;
+}
+
+void hostPublishIMUSample(const IMUSample &sample) {
+    history.push(sample);
+}
@@ -0,0 +1,54 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Preferences.h>
+#include <cstring>
+#include <map>
+#include <vector>
+
+// The stored bytes of every key, by namespace and key
+static std::map<std::string, std::map<std::string, std::vector<uint8_t>>> storage;
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel) {
+    if (name == nullptr || name[0] == '\0' || !this->name.empty()) {
+        return false;
+    }
+
+    this->name = name;
+    this->readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end() {
+    name.clear();
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t length) {
+    if (name.empty() || readOnly || key == nullptr || value == nullptr || length == 0) {
+        return 0;
+    }
+
+    const auto *bytes = static_cast<const uint8_t *>(value);
+    storage[name][key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytes(const char *key, void *buffer, size_t maxLength) {
+    if (name.empty() || key == nullptr || buffer == nullptr) {
+        return 0;
+    }
+
+    auto space = storage.find(name);
+    if (space == storage.end()) {
+        return 0;
+    }
+
+    auto entry = space->second.find(key);
+    if (entry == space->second.end() || entry->second.size() > maxLength) {
+        return 0;
+    }
+
+    memcpy(buffer, entry->second.data(), entry->second.size());
+    return entry->second.size();
+}
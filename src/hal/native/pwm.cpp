@@ -0,0 +1,64 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "hal/pwm.h"
+#include "hal/native/hostHAL.h"
+
+// The state of each channel
+static uint32_t duties[PWM_CHANNEL_COUNT] = {};
+static uint32_t staged[PWM_CHANNEL_COUNT] = {};
+static uint8_t resolutions[PWM_CHANNEL_COUNT] = {};
+
+bool pwmSetup(const uint8_t &channel, const uint32_t &frequency, const uint8_t &resolution) {
+    if (channel >= PWM_CHANNEL_COUNT || frequency == 0 || resolution < 1 || resolution > 16) {
+        return false;
+    }
+
+    resolutions[channel] = resolution;
+    duties[channel] = 0;
+    staged[channel] = 0;
+    return true;
+}
+
+void pwmAttach(const uint8_t &pin, const uint8_t &channel) {}
+
+void pwmWrite(const uint8_t &channel, const uint32_t &duty) {
+    if (channel < PWM_CHANNEL_COUNT) {
+        duties[channel] = duty;
+        staged[channel] = duty;
+    }
+}
+
+void pwmStage(const uint8_t &channel, const uint32_t &duty) {
+    if (channel < PWM_CHANNEL_COUNT) {
+        staged[channel] = duty;
+    }
+}
+
+void pwmCommit(const uint16_t &channels) {
+    uint32_t remaining = channels;
+    while (remaining != 0) {
+        uint8_t channel = __builtin_ctz(remaining);
+        duties[channel] = staged[channel];
+        remaining &= remaining - 1;
+    }
+}
+
+void pwmHold(const uint16_t &channels) {
+    uint32_t remaining = channels;
+    while (remaining != 0) {
+        uint8_t channel = __builtin_ctz(remaining);
+        duties[channel] = (1UL << resolutions[channel]) - 1;
+        staged[channel] = duties[channel];
+        remaining &= remaining - 1;
+    }
+}
+
+uint32_t hostPWMRead(const uint8_t &channel) {
+    return channel < PWM_CHANNEL_COUNT ? duties[channel] : 0;
+}
+
+uint8_t hostPWMResolution(const uint8_t &channel) {
+    return channel < PWM_CHANNEL_COUNT ? resolutions[channel] : 0;
+}
@@ -0,0 +1,57 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <atomic>
+#include "hal/counterExtension.h"
+#include "hal/quadratureCounter.h"
+#include "hal/native/hostHAL.h"
+
+// The simulated 16-bit PCNT counter of each unit. Atomic so a simulation thread can drive them
+static std::atomic<int16_t> registers[COUNTER_UNIT_COUNT] = {};
+
+// The software extension of each unit's counter, as on the ESP32
+static CounterExtension extensions[COUNTER_UNIT_COUNT];
+
+bool counterAttach(const uint8_t &unit, const uint8_t &pinA, const uint8_t &pinB) {
+    if (unit >= COUNTER_UNIT_COUNT) {
+        return false;
+    }
+
+    registers[unit] = 0;
+    extensions[unit].write(0, 0);
+    return true;
+}
+
+int64_t counterRead(const uint8_t &unit) {
+    return unit < COUNTER_UNIT_COUNT ? extensions[unit].update(registers[unit].load()) : 0;
+}
+
+bool counterClear(const uint8_t &unit) {
+    if (unit >= COUNTER_UNIT_COUNT) {
+        return false;
+    }
+
+    extensions[unit].write(0, registers[unit].load());
+    return true;
+}
+
+void counterWrite(const uint8_t &unit, const int64_t &count) {
+    if (unit < COUNTER_UNIT_COUNT) {
+        extensions[unit].write(count, registers[unit].load());
+    }
+}
+
+void hostCounterAdd(const uint8_t &unit, const int64_t &delta) {
+    if (unit >= COUNTER_UNIT_COUNT) {
+        return;
+    }
+
+    // Like the PCNT, the counter resets to 0 whenever it reaches ±COUNTER_LIMIT on the way, which
+    // leaves the remainder of the sum (truncated toward zero)
+    int16_t value = registers[unit].load();
+    int16_t next;
+    do {
+        next = static_cast<int16_t>((value + delta) % COUNTER_LIMIT);
+    } while (!registers[unit].compare_exchange_weak(value, next));
+}
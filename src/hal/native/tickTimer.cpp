@@ -0,0 +1,51 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <condition_variable>
+#include <mutex>
+#include "hal/tickTimer.h"
+#include "hal/native/hostHAL.h"
+
+// The ticks raised by the host HAL and not yet waited for
+static std::mutex mutex;
+static std::condition_variable raised;
+static bool running = false;
+static uint32_t pending = 0;
+
+bool tickTimerStart(const uint8_t &timer, const uint32_t &period) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (running || timer >= TICK_TIMER_COUNT || period == 0) {
+        return false;
+    }
+
+    running = true;
+    pending = 0;
+    return true;
+}
+
+void tickTimerStop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    running = false;
+}
+
+uint32_t tickTimerWait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    raised.wait(lock, []() { return pending > 0; });
+
+    uint32_t ticks = pending;
+    pending = 0;
+    return ticks;
+}
+
+void hostTickRaise(const uint32_t &ticks) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running) {
+            return;
+        }
+        pending += ticks;
+    }
+
+    raised.notify_one();
+}
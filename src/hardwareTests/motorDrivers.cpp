@@ -1,24 +1,40 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #include <Arduino.h>
+#include <ArduinoLog.h>
 #include <array>
-
-struct MotorDriver {
-    uint8_t pwmPin; // PWM signal pin connected to IN1
-    uint8_t directionPin;   // Direction signal pin connected to IN2
-};
-
-// Configuration variables - set these to match the hardware setup
+#include "control/kinematics.h"
+#include "mechanism/encoderHandler.h"
+#include "mechanism/motorCalibration.h"
+#include "mechanism/motorCharacterizer.h"
+#include "mechanism/motorHandler.h"
+#include "logging/deferredLog.h"
+
+// Configuration variables - set these to match the hardware setup. CHARACTERIZE measures each
+// motor, tunes the velocity loops and stores the profile in NVS for the mechanism to load.
+// Otherwise each motor is cycled forward and backward at full speed. The motors turn either way,
+// so lift the wheels off the eyeball (or leave them on it to include its inertia)
 constexpr uint8_t FIRST_DRIVER_PWM_PIN = 0;
 constexpr uint8_t FIRST_DRIVER_DIRECTION_PIN = 0;
 constexpr uint8_t SECOND_DRIVER_PWM_PIN = 0;
 constexpr uint8_t SECOND_DRIVER_DIRECTION_PIN = 0;
 constexpr uint8_t THIRD_DRIVER_PWM_PIN = 0;
 constexpr uint8_t THIRD_DRIVER_DIRECTION_PIN = 0;
+constexpr uint8_t FIRST_ENCODER_PIN_A = 0;
+constexpr uint8_t FIRST_ENCODER_PIN_B = 0;
+constexpr uint8_t SECOND_ENCODER_PIN_A = 0;
+constexpr uint8_t SECOND_ENCODER_PIN_B = 0;
+constexpr uint8_t THIRD_ENCODER_PIN_A = 0;
+constexpr uint8_t THIRD_ENCODER_PIN_B = 0;
 constexpr uint32_t PWM_FREQUENCY = 20000;
 constexpr uint8_t PWM_RESOLUTION = 8;
+constexpr uint32_t DIRECTION_DEADTIME = 500;
+constexpr bool CHARACTERIZE = true; // If the motors are characterized rather than cycled
+constexpr uint32_t CONTROL_PERIOD = 1000;   // The time between characterization ticks in us
+constexpr CharacterizationSettings CHARACTERIZATION = DEFAULT_CHARACTERIZATION;
+constexpr DriveGeometry DRIVE_GEOMETRY = DEFAULT_DRIVE; // For the encoders' counts per revolution
 constexpr uint32_t BAUD_RATE = 115200;
 
 // Program Variables
@@ -28,65 +44,112 @@ constexpr std::array<std::array<uint8_t, 2>, 3> motorPins = {FIRST_DRIVER_DIRECT
                                                              SECOND_DRIVER_PWM_PIN,
                                                              THIRD_DRIVER_DIRECTION_PIN,
                                                              THIRD_DRIVER_PWM_PIN};
-std::array<MotorDriver, 3> drivers;
-std::array<int16_t, 3> motorSpeeds = {0, 0, 0};
-
-void setMotorSpeeds(const std::array<int16_t, 3> &speeds) {
-    uint16_t maxDutyCycle = (1 << PWM_RESOLUTION) - 1;
-
-    for (size_t i(0); i < speeds.size(); ++i) {
-        // Determine dutyCycle and direction
-        uint16_t dutyCycle = abs(constrain(speeds[i], -maxDutyCycle, maxDutyCycle));
-        uint8_t direction = speeds[i] >= 0 ? LOW : HIGH;
-
-        // Set the pins
-        digitalWrite(drivers[i].directionPin, direction);
-        ledcWrite(i, dutyCycle);
+constexpr std::array<std::array<uint8_t, 2>, 3> encoderPins = {FIRST_ENCODER_PIN_A,
+                                                               FIRST_ENCODER_PIN_B,
+                                                               SECOND_ENCODER_PIN_A,
+                                                               SECOND_ENCODER_PIN_B,
+                                                               THIRD_ENCODER_PIN_A,
+                                                               THIRD_ENCODER_PIN_B};
+MotorCharacterizer characterizer(CHARACTERIZATION,
+                                 Kinematics(DRIVE_GEOMETRY).getRadiansPerCount());
+uint32_t nextTick = 0;  // When the next characterization tick is due in us
+bool initialized = false;   // If the handlers initialized, so the motors can be driven
+
+/**
+ * Log the characterization, tune the velocity loops from it and store the profile
+ */
+void finishCharacterization() {
+    if (!characterizer.succeeded()) {
+        Log.errorln("Characterization failed. Check the wiring and that the wheels are free");
+        return;
     }
-}
 
-int16_t max() {
-    return (1 << PWM_RESOLUTION) - 1;
+    MotorCalibration calibration = {characterizer.getModels(),
+                                    deriveVelocityGains(characterizer.getModels(),
+                                                        CHARACTERIZATION)};
+    Log.noticeln("Velocity Gains - Kp: %F Ki: %F Kd: %F FF: %F", calibration.gains.proportional,
+                 calibration.gains.integral, calibration.gains.derivative,
+                 calibration.gains.feedForward);
+
+    if (saveMotorCalibration(calibration)) {
+        Log.noticeln("Calibration profile stored in NVS");
+    } else {
+        Log.errorln("Failed to store the calibration profile");
+    }
 }
 
-int16_t min() {
-    return -1 * ((1 << PWM_RESOLUTION) - 1);
+/**
+ * Drive each motor forward then backward at full speed, with a pause in between
+ */
+void cycleMotors() {
+    MotorHandler *motorHandler = MotorHandler::instance();
+    int16_t maxSpeed = motorHandler->getMaxSpeed();
+
+    for (size_t i(0); i < motorPins.size(); ++i) {
+        for (int16_t speed : {maxSpeed, static_cast<int16_t>(-maxSpeed)}) {
+            std::array<int16_t, 3> speeds = {0, 0, 0};
+            speeds[i] = speed;
+            motorHandler->setMotorSpeeds(speeds);
+            delay(1000);
+
+            motorHandler->setMotorSpeeds({0, 0, 0});
+            delay(1000);
+        }
+    }
 }
 
 void setup() {
     Serial.begin(BAUD_RATE);
+    Log.begin(LOG_LEVEL_NOTICE, &Serial, true);
+
+    try {
+        EncoderHandler::instance()->initialize(encoderPins);
+        MotorHandler::instance()->initialize(motorPins, PWM_FREQUENCY, PWM_RESOLUTION,
+                                             DIRECTION_DEADTIME);
+        initialized = true;
+    } catch (const std::exception &ex) {
+        Log.errorln("Failed to initialize the handlers - %s", ex.what());
+    }
+    DeferredLog::instance()->drain();
 
-    for (size_t i(0); i < drivers.size(); ++i) {
-        // Set direction pin values
-        drivers[i].directionPin = motorPins[i][0];
-        pinMode(drivers[i].directionPin, OUTPUT);
-        digitalWrite(drivers[i].directionPin, LOW);
-
-        // Set pwm pin
-        drivers[i].pwmPin = motorPins[i][1];
-        ledcSetup(i, PWM_FREQUENCY, PWM_RESOLUTION);
-        ledcAttachPin(drivers[i].pwmPin, i);
-        ledcWrite(i, 0);
+    // Without the handlers the motors cannot be driven, so there is nothing to test
+    if (!initialized) {
+        Log.errorln("The motors will not be driven. Check the pins and restart");
+        return;
+    }
+
+    if (CHARACTERIZE) {
+        Log.noticeln("Characterizing the motors");
+        nextTick = micros();
+        characterizer.start(nextTick);
     }
 }
 
 void loop() {
-    // make things move forward backward and test pwm variation
-
-    // Move forward at full
-    motorSpeeds = {max(), 0, 0};
-    setMotorSpeeds(motorSpeeds);
-    delay(1000);
+    if (!initialized) {
+        return;
+    }
 
-    motorSpeeds = {0, 0, 0};
-    setMotorSpeeds(motorSpeeds);
-    delay(1000);
+    if (!CHARACTERIZE) {
+        cycleMotors();
+        return;
+    }
 
-    motorSpeeds = {min(), 0, 0};
-    setMotorSpeeds(motorSpeeds);
-    delay(1000);
+    // Tick at CONTROL_PERIOD, as the control loop would
+    uint32_t now = micros();
+    if (static_cast<int32_t>(now - nextTick) < 0) {
+        return;
+    }
+    nextTick += CONTROL_PERIOD;
+
+    EncoderHandler::instance()->update();
+    static bool running = true;
+    if (running && !characterizer.update(now)) {
+        running = false;
+        DeferredLog::instance()->drain();
+        finishCharacterization();
+    }
 
-    motorSpeeds = {0, 0, 0};
-    setMotorSpeeds(motorSpeeds);
-    delay(1000);
-}
\ No newline at end of file
+    // Write out the characterizer's messages between ticks
+    DeferredLog::instance()->drain();
+}
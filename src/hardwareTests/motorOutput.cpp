@@ -0,0 +1,64 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include "benchmarks/motorBenchmarks.h"
+#include "mechanism/motorHandler.h"
+#include "logging/deferredLog.h"
+
+// Configuration variables - set these to match the hardware setup. The motors turn while the
+// outputs are timed, so lift the wheels off the eyeball
+constexpr uint8_t FIRST_DRIVER_PWM_PIN = 0;
+constexpr uint8_t FIRST_DRIVER_DIRECTION_PIN = 0;
+constexpr uint8_t SECOND_DRIVER_PWM_PIN = 0;
+constexpr uint8_t SECOND_DRIVER_DIRECTION_PIN = 0;
+constexpr uint8_t THIRD_DRIVER_PWM_PIN = 0;
+constexpr uint8_t THIRD_DRIVER_DIRECTION_PIN = 0;
+constexpr uint32_t PWM_FREQUENCY = 20000;
+constexpr uint8_t PWM_RESOLUTION = 8;
+constexpr uint32_t DIRECTION_DEADTIME = 500;
+constexpr uint32_t BENCHMARK_ITERATIONS = 10000; // The number of calls to time per output
+constexpr uint32_t BAUD_RATE = 115200;
+
+// Program Variables
+constexpr std::array<std::array<uint8_t, 2>, 3> motorPins = {FIRST_DRIVER_DIRECTION_PIN,
+                                                             FIRST_DRIVER_PWM_PIN,
+                                                             SECOND_DRIVER_DIRECTION_PIN,
+                                                             SECOND_DRIVER_PWM_PIN,
+                                                             THIRD_DRIVER_DIRECTION_PIN,
+                                                             THIRD_DRIVER_PWM_PIN};
+bool initialized = false;   // If the MotorHandler initialized, so the outputs can be timed
+
+/**
+ * Get the CPU cycle count for timing benchmarks
+ *
+ * @return The cycle count (wraps every ~17 s at 240 MHz)
+ */
+uint32_t cycles() {
+    return ESP.getCycleCount();
+}
+
+void setup() {
+    Serial.begin(BAUD_RATE);
+    Log.begin(LOG_LEVEL_NOTICE, &Serial, true);
+
+    try {
+        MotorHandler::instance()->initialize(motorPins, PWM_FREQUENCY, PWM_RESOLUTION,
+                                             DIRECTION_DEADTIME);
+        initialized = true;
+    } catch (const std::exception &ex) {
+        Log.errorln("Failed to initialize MotorHandler - %s", ex.what());
+    }
+    DeferredLog::instance()->drain();
+}
+
+void loop() {
+    if (!initialized) {
+        return;
+    }
+
+    runMotorBenchmarks(motorPins, BENCHMARK_ITERATIONS, cycles, "cycles");
+    delay(5000);
+}
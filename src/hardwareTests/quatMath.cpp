@@ -0,0 +1,34 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include "benchmarks/controlBenchmarks.h"
+#include "benchmarks/logBenchmarks.h"
+#include "benchmarks/quatMathBenchmarks.h"
+
+// Configuration variables
+constexpr uint32_t BENCHMARK_ITERATIONS = 10000; // The number of calls to time per kernel
+constexpr uint32_t BAUD_RATE = 115200;
+
+/**
+ * Get the CPU cycle count for timing benchmarks
+ *
+ * @return The cycle count (wraps every ~17 s at 240 MHz)
+ */
+uint32_t cycles() {
+    return ESP.getCycleCount();
+}
+
+void setup() {
+    Serial.begin(BAUD_RATE);
+    Log.begin(LOG_LEVEL_NOTICE, &Serial, true);
+}
+
+void loop() {
+    runQuatMathBenchmarks(BENCHMARK_ITERATIONS, cycles, "cycles");
+    runControlBenchmarks(BENCHMARK_ITERATIONS, cycles, "cycles");
+    runLogBenchmarks(BENCHMARK_ITERATIONS, cycles, "cycles");
+    delay(5000);
+}
@@ -0,0 +1,203 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "logging/deferredLog.h"
+#include <algorithm>
+#include <cstdio>
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE must be a power of 2");
+
+// Set static inst to null
+DeferredLog *DeferredLog::inst = nullptr;
+
+DeferredLog::~DeferredLog() noexcept { inst = nullptr; }
+
+DeferredLog *DeferredLog::instance() {
+    if (inst == nullptr) {
+        inst = new DeferredLog();
+    }
+
+    return inst;
+}
+
+bool DeferredLog::push(const LogRecord &record) noexcept {
+    // Claim the slot at the tail. A slot whose sequence is behind the tail still holds a message
+    // from the last lap, so the buffer is full
+    uint32_t position = tail.load(std::memory_order_relaxed);
+    Slot *slot;
+    while (true) {
+        slot = &slots[position & (LOG_RING_SIZE - 1)];
+        int32_t lag = static_cast<int32_t>(slot->sequence.load(std::memory_order_acquire) -
+                                           position);
+
+        if (lag == 0) {
+            if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    // Publish the message to the drain
+    slot->record = record;
+    slot->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool DeferredLog::pop(LogRecord &record) noexcept {
+    Slot &slot = slots[head & (LOG_RING_SIZE - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+        return false;
+    }
+
+    // Free the slot for the producers' next lap
+    record = slot.record;
+    slot.sequence.store(head + LOG_RING_SIZE, std::memory_order_release);
+    ++head;
+    return true;
+}
+
+size_t DeferredLog::drain() {
+    uint32_t totalDropped = dropped.load(std::memory_order_relaxed);
+    if (totalDropped != reportedDropped) {
+        Log.warningln("DeferredLog - Dropped %u messages", totalDropped - reportedDropped);
+        reportedDropped = totalDropped;
+    }
+
+    char line[LOG_LINE_SIZE];
+    LogRecord record = {};
+    size_t written = 0;
+    while (pop(record)) {
+        format(record, line, sizeof(line));
+        logDirect(record.level, "%s", line);
+        ++written;
+    }
+
+    return written;
+}
+
+void DeferredLog::loop(const uint32_t &interval) {
+    while (true) {
+        drain();
+        delay(interval);
+    }
+}
+
+uint32_t DeferredLog::getDropped() const noexcept {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+size_t DeferredLog::format(const LogRecord &record, char *buffer, const size_t &size) noexcept {
+    if (size == 0) {
+        return 0;
+    }
+
+    size_t length = 0;
+    size_t argument = 0;
+    auto append = [&](const char *text, const size_t &n) {
+        size_t copied = std::min(n, size - 1 - length);
+        memcpy(buffer + length, text, copied);
+        length += copied;
+    };
+
+    for (const char *c = record.format; *c != '\0' && length < size - 1; ++c) {
+        if (*c != '%') {
+            append(c, 1);
+            continue;
+        }
+
+        char specifier = *++c;
+        if (specifier == '\0') {
+            break;
+        }
+        if (specifier == '%') {
+            append(c, 1);
+            continue;
+        }
+
+        // A message with too few arguments prints the rest of its specifiers as they are
+        if (argument >= record.count) {
+            char text[2] = {'%', specifier};
+            append(text, 2);
+            continue;
+        }
+
+        uint32_t word = record.arguments[argument++];
+        char text[40];
+        int n = 0;
+        switch (specifier) {
+            case 'd':
+            case 'i':
+            case 'l':
+                n = snprintf(text, sizeof(text), "%ld",
+                             static_cast<long>(static_cast<int32_t>(word)));
+                break;
+            case 'u':
+                n = snprintf(text, sizeof(text), "%lu", static_cast<unsigned long>(word));
+                break;
+            case 'x':
+                n = snprintf(text, sizeof(text), "%lx", static_cast<unsigned long>(word));
+                break;
+            case 'X':
+                // As ArduinoLog, 16 bits padded to 4 digits
+                n = snprintf(text, sizeof(text), "0x%04lX",
+                             static_cast<unsigned long>(word & 0xFFFF));
+                break;
+            case 'b':
+            case 'B': {
+                if (specifier == 'B') {
+                    text[n++] = '0';
+                    text[n++] = 'b';
+                }
+                int bit = 31;
+                while (bit > 0 && ((word >> bit) & 1) == 0) {
+                    --bit;
+                }
+                for (; bit >= 0; --bit) {
+                    text[n++] = (word >> bit) & 1 ? '1' : '0';
+                }
+                break;
+            }
+            case 'c':
+                text[n++] = static_cast<char>(word);
+                break;
+            case 't':
+                text[n++] = word != 0 ? 'T' : 'F';
+                break;
+            case 'T':
+                n = snprintf(text, sizeof(text), "%s", word != 0 ? "true" : "false");
+                break;
+            case 'D':
+            case 'F': {
+                // To 6 decimals, as the measurements deferred need more than ArduinoLog's 2
+                float value;
+                memcpy(&value, &word, sizeof(value));
+                n = snprintf(text, sizeof(text), "%f", static_cast<double>(value));
+                break;
+            }
+            default:
+                // Strings and pointers cannot be deferred
+                n = snprintf(text, sizeof(text), "%%%c?", specifier);
+                break;
+        }
+
+        append(text, static_cast<size_t>(std::min(std::max(n, 0),
+                                                  static_cast<int>(sizeof(text)) - 1)));
+    }
+
+    buffer[length] = '\0';
+    return length;
+}
+
+DeferredLog::DeferredLog() noexcept: tail(0), head(0), dropped(0), reportedDropped(0) {
+    // Slot i is first pushed at position i
+    for (size_t i(0); i < slots.size(); ++i) {
+        slots[i].sequence.store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+        slots[i].record = {};
+    }
+}
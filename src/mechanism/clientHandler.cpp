@@ -1,49 +1,93 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/2024
+// Last Modified: 10/16/2026
 
 #include "mechanism/clientHandler.h"
 
+/**
+ * Called when a write to a cached handle completes. Writes are rejected if a handle no longer
+ * belongs to the expected attribute
+ */
+static int onCachedWrite(uint16_t conn, const ble_gatt_error *error, ble_gatt_attr *attr,
+                         void *arg) {
+    if (error != nullptr && error->status != 0 && error->status != BLE_HS_ENOTCONN) {
+        ClientHandler::postEvent(ConnectionEvent::CacheRejected);
+    }
+
+    return 0;
+}
+
+/**
+ * Send a write to an attribute handle of the client's server without waiting for the response.
+ * A rejection is reported to the connection task by onCachedWrite
+ */
+static bool writeHandle(NimBLEClient &client, const uint16_t &handle, const uint8_t *data,
+                        const uint16_t &length) {
+    return ble_gattc_write_flat(client.getConnHandle(), handle, data, length, onCachedWrite,
+                                nullptr) == 0;
+}
+
 void ClientCallbacks::onConnect(NimBLEClient *connectedClient) {
-    Log.infoln("Connected to the server");
-    connectedClient->updateConnParams(120, 120, 0, 60); //todo figure this out
+    DLOG_INFO("Connected to the server");
+}
+
+void ClientCallbacks::onMTUChange(NimBLEClient *client, uint16_t MTU) {
+    DLOG_INFO("MTU changed to %d", MTU);
+}
+
+bool ClientCallbacks::onConnParamsUpdateRequest(NimBLEClient *client, const ble_gap_upd_params
+*params) {
+    if (params->itvl_min > ClientHandler::linkProfile.maxInterval) {
+        DLOG_WARNING("The server requested a slower connection interval (%d.%d ms)",
+                     params->itvl_min * 125 / 100, params->itvl_min * 125 % 100);
+    }
+
+    return true;
 }
 
 void ClientCallbacks::onDisconnect(NimBLEClient *disconnectedClient, int reason) {
-    Log.warningln("Disconnected from the server (code %d). Starting scan", reason);
-    NimBLEDevice::getScan()->start(ClientHandler::scanTime);
+    DLOG_WARNING("Disconnected from the server (code %d)", reason);
+    ClientHandler::postEvent(ConnectionEvent::Disconnected);
 }
 
 void ScanCallbacks::onResult(NimBLEAdvertisedDevice *advertisedDevice) {
-    Log.trace("Advertised Device found: ");
-    Log.traceln(advertisedDevice->toString().c_str());
+    DLOG_DIRECT(LOG_LEVEL_TRACE, "Advertised Device found: %s",
+                advertisedDevice->toString().c_str());
 
     // Check if the device has the correct service UUID
     if (advertisedDevice->isAdvertisingService(NimBLEUUID(ClientHandler::serviceUUID))) {
-        Log.traceln("Found a server with the correct service");
-        NimBLEDevice::getScan()->stop();
-        ClientHandler::advDevice = advertisedDevice;
-        ClientHandler::doConnect = true;
+        DLOG_TRACE("Found a server with the correct service");
+        ClientHandler::postEvent(ConnectionEvent::DeviceFound, advertisedDevice->getAddress());
     }
 
-    Log.traceln("onResult end");
+    DLOG_TRACE("onResult end");
 }
 
 void ScanCallbacks::onScanEnd(NimBLEScanResults results) {
-    Log.traceln("ScanCallbacks::onScanEnd - Scan ended");
+    DLOG_TRACE("ScanCallbacks::onScanEnd - Scan ended");
+    ClientHandler::postEvent(ConnectionEvent::ScanEnded);
 }
 
 // Set static variables
-NimBLEAdvertisedDevice *ClientHandler::advDevice = nullptr;
 std::string ClientHandler::serviceUUID = "";
 uint32_t ClientHandler::scanTime = 5 * 1000;
-bool ClientHandler::doConnect = false;
 ClientHandler *ClientHandler::inst = nullptr;
 ClientCallbacks ClientHandler::clientCallback;
 ScanCallbacks ClientHandler::scanCallback;
 bool ClientHandler::initialized = false;
+QueueHandle_t ClientHandler::events = nullptr;
+GATTCache ClientHandler::cache;
+CachedSubscription<NimBLEClient> ClientHandler::cachedSubscription(cache, CACHE_TIMEOUT);
+std::atomic<uint16_t> ClientHandler::connHandle{BLE_HS_CONN_HANDLE_NONE};
+std::atomic<uint16_t> ClientHandler::IMUHandle{0};
 std::string ClientHandler::IMUCharacteristicUUID = "";
-Quaternion ClientHandler::quaternion;
+IMUEncoding ClientHandler::encoding = IMUEncoding::Float32;
+LinkProfile ClientHandler::linkProfile = LOW_LATENCY_LINK;
+SampleHistory<IMUSample, ClientHandler::HISTORY_SIZE> ClientHandler::history;
+LinkStatistics ClientHandler::arrivalStatistics = {};
+SampleChannel<LinkStatistics> ClientHandler::publishedStatistics;
+std::atomic<uint32_t> ClientHandler::age{0};
+std::atomic<uint32_t> ClientHandler::maxAge{0};
 
 ClientHandler::~ClientHandler() { inst = nullptr; }
 
@@ -57,141 +101,439 @@ ClientHandler *ClientHandler::instance() {
 
 void ClientHandler::initialize(const std::string &SERVICE_UUID, const std::string
 &IMU_CHARACTERISTIC_UUID, const std::string &DEVICE_NAME, const uint8_t &SCAN_TIME,
-                               const uint32_t &SCAN_WINDOW, const uint32_t &SCAN_INTERVAL) {
-    Log.traceln("ClientHandler::initialize - Begin");
+                               const uint32_t &SCAN_WINDOW, const uint32_t &SCAN_INTERVAL,
+                               const IMUEncoding &ENCODING, const LinkProfile &LINK_PROFILE,
+                               const bool &PERSIST_HANDLES) {
+    DLOG_TRACE("ClientHandler::initialize - Begin");
 //todo fix static initialize
     // Set UUIDs
     serviceUUID = SERVICE_UUID;
     IMUCharacteristicUUID = IMU_CHARACTERISTIC_UUID;
+    encoding = ENCODING;
+    linkProfile = LINK_PROFILE;
     // Check and set scan time
     scanTime = SCAN_TIME;
 
+    // Create the event queue and queue the first scan
+    events = xQueueCreate(EVENT_QUEUE_LENGTH, sizeof(ConnectionMessage));
+    if (events == nullptr) {
+        throw std::runtime_error("Failed to create the connection event queue");
+    }
+
     // Initialize the BLE Device
     NimBLEDevice::init(DEVICE_NAME);
+    applyLinkProfile(linkProfile);
+
+    // IMU notifications are taken straight from the GAP events so they work with cached handles
+    cache.setPersistent(PERSIST_HANDLES);
+    if (!NimBLEDevice::setCustomGapHandler(gapHandler)) {
+        throw std::runtime_error("Failed to register the GAP handler");
+    }
 
-    // Configure and start scan
+    // Configure the scan
     NimBLEScan *scanner = NimBLEDevice::getScan();
     scanner->setScanCallbacks(&scanCallback);
     scanner->setInterval(SCAN_INTERVAL);
     scanner->setWindow(SCAN_WINDOW);
     scanner->setActiveScan(true);
-    scanner->start(SCAN_TIME);
-    Log.traceln("ClientHandler::initialize - End");
+
+    postEvent(ConnectionEvent::Start);
+    DLOG_TRACE("ClientHandler::initialize - End");
 }
 
-void
-ClientHandler::notifyCallback(NimBLERemoteCharacteristic *remoteCharacteristic, uint8_t *pData,
-                              size_t length,
-                              bool isNotify) {
-    //todo add a buffer?
-    if (remoteCharacteristic->getUUID() == BLEUUID(IMUCharacteristicUUID) && isNotify) {
-        if (length == 16) {
-            memcpy(&quaternion.w, &pData[0], sizeof(float));
-            memcpy(&quaternion.x, &pData[4], sizeof(float));
-            memcpy(&quaternion.y, &pData[8], sizeof(float));
-            memcpy(&quaternion.z, &pData[12], sizeof(float));
+int ClientHandler::gapHandler(ble_gap_event *event, void *arg) {
+    // Only IMU notifications are handled here. Everything else is left to NimBLE
+    if (event->type != BLE_GAP_EVENT_NOTIFY_RX || event->notify_rx.indication ||
+        event->notify_rx.conn_handle != connHandle.load(std::memory_order_relaxed) ||
+        event->notify_rx.attr_handle != IMUHandle.load(std::memory_order_relaxed)) {
+        return 0;
+    }
 
-            Log.verboseln("\tQuat:\t%D\t%D\t%D\t%D", quaternion.w, quaternion.x, quaternion.y,
-                          quaternion.z);
+    cachedSubscription.notify();
+    uint8_t packet[IMU_PACKET_MAX_SIZE];
+    uint16_t length = 0;
+    if (ble_hs_mbuf_to_flat(event->notify_rx.om, packet, sizeof(packet), &length) == 0) {
+        receivePacket(packet, length);
+    } else {
+        DLOG_WARNING("ClientHandler::gapHandler - IMU packet too large");
+    }
 
-        } else {
-            Log.warningln("ClientHandler::notifyCallback - Unexpected data length received");
+    return 0;
+}
+
+void ClientHandler::receivePacket(const uint8_t *data, const size_t &length) {
+    IMUPacketDecoder decoder(data, length);
+
+    if (decoder.isValid()) {
+        uint32_t arrival = micros();
+        IMUPacketSample packetSample;
+
+        // Every sample in the batch arrived together but keeps its own device timestamp
+        while (decoder.next(packetSample)) {
+            IMUSample received;
+            received.quaternion = packetSample.quaternion;
+            received.timestamp = arrival;
+            received.sequence = packetSample.sequence;
+            received.deviceTimestamp = packetSample.timestamp;
+
+            // Publish the whole sample at once so readers never see a partial update
+            recordSample(received);
+
+            DLOG_VERBOSE("\tQuat:\t%D\t%D\t%D\t%D", received.quaternion.w,
+                         received.quaternion.x, received.quaternion.y, received.quaternion.z);
         }
     } else {
-        Log.warningln("ClientHandler::notifyCallback - Unexpected characteristic or trigger");
+        DLOG_WARNING("ClientHandler::receivePacket - Invalid IMU packet received");
     }
 }
 
-const Quaternion &ClientHandler::getQuaternion() const {
-    return quaternion;
+Quaternion ClientHandler::getQuaternion() const {
+    return getSample().quaternion;
+}
+
+IMUSample ClientHandler::getSample() const {
+    IMUSample latest = {};
+    history.latest(latest);
+    return latest;
+}
+
+IMUSample ClientHandler::consumeSample() {
+    IMUSample latest = {};
+
+    if (history.latest(latest)) {
+        uint32_t sampleAge = micros() - latest.timestamp;
+        age.store(sampleAge, std::memory_order_relaxed);
+
+        if (sampleAge > maxAge.load(std::memory_order_relaxed)) {
+            maxAge.store(sampleAge, std::memory_order_relaxed);
+        }
+    }
+
+    return latest;
+}
+
+size_t ClientHandler::getSamples(IMUSample *samples, const size_t &n) const {
+    return history.lastN(samples, n);
+}
+
+size_t ClientHandler::getSamples(const uint32_t &duration, IMUSample *samples, const size_t &n)
+const {
+    return history.window(micros(), duration, samples, n);
+}
+
+LinkStatistics ClientHandler::getLinkStatistics() const {
+    LinkStatistics statistics = publishedStatistics.read();
+    statistics.age = age.load(std::memory_order_relaxed);
+    statistics.maxAge = maxAge.load(std::memory_order_relaxed);
+    return statistics;
 }
 
 void ClientHandler::loop() {
     while (true) {
         try {
-
-            if (doConnect) {
-                if (connectToServer()) {
-                    Log.traceln("Successfully connected to the server");
-                    doConnect = false;
+            ConnectionMessage message = {};
+
+            // Sleep until an event arrives. A backoff ends when the wait times out
+            if (xQueueReceive(events, &message, getTimeout()) == pdTRUE) {
+                handleEvent(message);
+            } else if (state == ConnectionState::Backoff) {
+                // Retry the last server unless it has failed too often
+                if (!peerAddress.isNull() && attempts <= FAST_RECONNECT_ATTEMPTS) {
+                    attemptConnection();
                 } else {
-                    Log.traceln("Failed to connect to the server");
+                    startScan();
                 }
+            } else if (state == ConnectionState::Subscribed &&
+                       cachedSubscription.expired(millis())) {
+                // The server accepted the cached handles but never notified, so its GATT table
+                // changed
+                DLOG_WARNING("No notifications on the cached handles. Rediscovering the IMU "
+                             "characteristic");
+                rediscover();
             }
-            delay(10);
         } catch (const std::exception &ex) {
-            Log.errorln("ClientHandler::Loop execution failed - %s", ex.what());
+            DLOG_DIRECT(LOG_LEVEL_ERROR, "ClientHandler::Loop execution failed - %s", ex.what());
         } catch (...) {
-            Log.errorln("ClientHandler::Loop execution failed - Unknown Error");
+            DLOG_ERROR("ClientHandler::Loop execution failed - Unknown Error");
+        }
+    }
+}
+
+void ClientHandler::postEvent(const ConnectionEvent &event, const NimBLEAddress &address) {
+    if (events == nullptr) {
+        return;
+    }
+
+    ConnectionMessage message = {event, address};
+    if (xQueueSend(events, &message, 0) != pdTRUE) {
+        DLOG_WARNING("ClientHandler::postEvent - Event queue full. Dropped event %d",
+                     static_cast<uint8_t>(event));
+    }
+}
+
+ConnectionStatistics ClientHandler::getConnectionStatistics() const {
+    return publishedConnection.read();
+}
+
+void ClientHandler::handleEvent(const ConnectionMessage &message) {
+    switch (message.event) {
+        case ConnectionEvent::Start:
+            startScan();
+            break;
+
+        case ConnectionEvent::DeviceFound:
+            // Only the first result of a scan is used
+            if (state == ConnectionState::Scanning) {
+                NimBLEDevice::getScan()->stop();
+                peerAddress = message.address;
+                attemptConnection();
+            }
+            break;
+
+        case ConnectionEvent::ScanEnded:
+            // A timed scan found nothing. Wait before scanning again
+            if (state == ConnectionState::Scanning) {
+                ++attempts;
+                setState(ConnectionState::Backoff);
+            }
+            break;
+
+        case ConnectionEvent::CacheRejected:
+            // The server's GATT table changed. Forget the handles and discover them again
+            if (state == ConnectionState::Subscribed) {
+                DLOG_WARNING("Cached handles rejected. Rediscovering the IMU characteristic");
+                cachedSubscription.reject();
+                rediscover();
+            }
+            break;
+
+        case ConnectionEvent::Disconnected:
+            IMUHandle = 0;
+            cachedSubscription.cancel();
+
+            // Failed attempts disconnect on their own and are already backing off
+            if (state == ConnectionState::Subscribed) {
+                disconnectTime = millis();
+                reconnecting = true;
+                ++connectionStatistics.disconnects;
+
+                // Go straight back to the server that was just lost
+                attemptConnection();
+            }
+            break;
+    }
+}
+
+void ClientHandler::startScan() {
+    setState(ConnectionState::Scanning);
+    DLOG_INFO("Scanning for the server");
+
+    if (!NimBLEDevice::getScan()->start(scanTime)) {
+        DLOG_ERROR("ClientHandler::startScan - Failed to start the scan");
+        ++attempts;
+        setState(ConnectionState::Backoff);
+    }
+}
+
+void ClientHandler::attemptConnection() {
+    setState(ConnectionState::Connecting);
+    NimBLEClient *client = connectToServer();
+
+    if (client != nullptr) {
+        setState(ConnectionState::Discovering);
+
+        // Skip discovery if the server's handles are known
+        if (subscribeCached(client) || subscribeToIMU(client)) {
+            attempts = 0;
+            ++connectionStatistics.connects;
+
+            if (reconnecting) {
+                reconnecting = false;
+                connectionStatistics.reconnectTime = millis() - disconnectTime;
+                if (connectionStatistics.reconnectTime > connectionStatistics.maxReconnectTime) {
+                    connectionStatistics.maxReconnectTime = connectionStatistics.reconnectTime;
+                }
+                DLOG_INFO("Reconnected in %u ms", connectionStatistics.reconnectTime);
+            }
+
+            setState(ConnectionState::Subscribed);
+            return;
+        }
+
+        client->disconnect();
+    }
+
+    ++attempts;
+    ++connectionStatistics.failures;
+    setState(ConnectionState::Backoff);
+}
+
+void ClientHandler::rediscover() {
+    IMUHandle = 0;
+
+    NimBLEClient *client = NimBLEDevice::getClientByPeerAddress(peerAddress);
+    setState(ConnectionState::Discovering);
+    if (client != nullptr && client->isConnected() && subscribeToIMU(client)) {
+        setState(ConnectionState::Subscribed);
+    } else {
+        if (client != nullptr) {
+            client->disconnect();
         }
+        ++attempts;
+        ++connectionStatistics.failures;
+        setState(ConnectionState::Backoff);
     }
 }
 
-bool ClientHandler::connectToServer() {
-    Log.traceln("ClientHandler::connectToServer - Begin");
+void ClientHandler::setState(const ConnectionState &next) {
+    if (next == ConnectionState::Backoff) {
+        // Double the delay with each failure and randomize the upper half so clients that failed
+        // together do not retry together
+        uint8_t exponent = attempts > 1 ? attempts - 1 : 0;
+        uint32_t delay = exponent < 16 ? BACKOFF_MIN << exponent : BACKOFF_MAX;
+        delay = delay < BACKOFF_MAX ? delay : BACKOFF_MAX;
+        backoffDelay = delay / 2 + random(delay / 2 + 1);
+        backoffStart = millis();
+        DLOG_INFO("Retrying in %u ms", backoffDelay);
+    }
+
+    state = next;
+    connectionStatistics.state = next;
+    publishedConnection.write(connectionStatistics);
+}
+
+TickType_t ClientHandler::getTimeout() const {
+    if (state == ConnectionState::Subscribed && cachedSubscription.isPending()) {
+        return pdMS_TO_TICKS(cachedSubscription.remaining(millis()));
+    }
+
+    if (state != ConnectionState::Backoff) {
+        return portMAX_DELAY;
+    }
+
+    uint32_t elapsed = millis() - backoffStart;
+    return elapsed < backoffDelay ? pdMS_TO_TICKS(backoffDelay - elapsed) : 0;
+}
+
+void ClientHandler::recordSample(const IMUSample &received) {
+    IMUSample previous = {};
+    bool hasPrevious = history.latest(previous);
+    int32_t gap = static_cast<int32_t>(received.sequence - previous.sequence);
+
+    // Ignore duplicates
+    if (hasPrevious && gap == 0) {
+        return;
+    }
+
+    history.push(received);
+
+    LinkStatistics &statistics = arrivalStatistics;
+    ++statistics.received;
+
+    // A sequence that goes backwards means the server restarted
+    if (hasPrevious && gap > 0) {
+        // Count the samples skipped in the sequence
+        statistics.dropped += gap - 1;
+
+        // Smooth the interval between samples on the device (1/16 gain as in RFC 3550)
+        int32_t interval = static_cast<int32_t>(received.deviceTimestamp -
+                                                previous.deviceTimestamp) / gap;
+        if (statistics.interval == 0) {
+            statistics.interval = interval;
+        }
+        statistics.interval += (interval - static_cast<int32_t>(statistics.interval)) / 16;
+
+        // The jitter is the variation in transit time (RFC 3550)
+        int32_t deviation = abs(static_cast<int32_t>((received.timestamp - previous.timestamp) -
+                                                     (received.deviceTimestamp -
+                                                      previous.deviceTimestamp)));
+        statistics.jitter += (deviation - static_cast<int32_t>(statistics.jitter)) / 16;
+
+        if (static_cast<uint32_t>(deviation) > statistics.maxJitter) {
+            statistics.maxJitter = deviation;
+        }
+    }
+
+    publishedStatistics.write(statistics);
+}
+
+NimBLEClient *ClientHandler::connectToServer() {
+    DLOG_TRACE("ClientHandler::connectToServer - Begin");
 
     // Ptrs for the method
     NimBLEClient *client = nullptr;
-    NimBLERemoteService *remoteService = nullptr;
-    NimBLERemoteCharacteristic *remoteIMUCharacteristic = nullptr;
 
     // Check if there is a client to reuse
-    Log.traceln("ClientHandler::connectToServer - Checking for client reuse");
+    DLOG_TRACE("ClientHandler::connectToServer - Checking for client reuse");
     if (NimBLEDevice::getCreatedClientCount()) {
-        client = NimBLEDevice::getClientByPeerAddress(advDevice->getAddress());
+        client = NimBLEDevice::getClientByPeerAddress(peerAddress);
 
         if (client) {   // Already know the device
-            if (!client->connect(advDevice, false)) {
-                Log.errorln("ClientHandler::connectToServer - Reconnect failed");
-                return false;
+            if (!client->connect(peerAddress, false)) {
+                DLOG_ERROR("ClientHandler::connectToServer - Reconnect failed");
+                return nullptr;
             }
-            Log.traceln("ClientHandler::connectToServer - Reconnect success");
+            DLOG_TRACE("ClientHandler::connectToServer - Reconnect success");
         } else {    // Don't know the device
             client = NimBLEDevice::getDisconnectedClient();
         }
     }
 
     // If there is no client to reuse, create a new one
-    Log.traceln("ClientHandler::connectToServer - Creating a client if there is no reuse");
+    DLOG_TRACE("ClientHandler::connectToServer - Creating a client if there is no reuse");
     if (!client) {
         if (NimBLEDevice::getCreatedClientCount() >= NIMBLE_MAX_CONNECTIONS) {
-            Log.errorln("ClientHandler::connectToServer - Max clients reached. No connections "
-                        "available");
-            return false;
+            DLOG_ERROR("ClientHandler::connectToServer - Max clients reached. No connections "
+                       "available");
+            return nullptr;
         }
 
         // Create the client and set callbacks
         client = NimBLEDevice::createClient();
         client->setClientCallbacks(&clientCallback, false);
-        Log.traceln("New Client created");
+        DLOG_TRACE("New Client created");
 
-        // Set connection params
-        client->setConnectionParams(12, 12, 0, 51); //todo figure this out
+        // Connect with the profile's parameters so the link is fast from the first event
+        client->setConnectionParams(linkProfile.minInterval, linkProfile.maxInterval,
+                                    linkProfile.latency, linkProfile.timeout);
         client->setConnectTimeout(5 * 1000);
 
         // See if the created client connected
-        if (!client->connect(advDevice)) {
+        if (!client->connect(peerAddress)) {
             NimBLEDevice::deleteClient(client);
-            Log.errorln("ClientHandler::connectToServer - Failed to connect. Deleted client");
-            return false;
+            DLOG_ERROR("ClientHandler::connectToServer - Failed to connect. Deleted client");
+            return nullptr;
         }
     }
 
     // Ensure client is connected
-    Log.traceln("ClientHandler::connectToServer - Ensuring client is connected");
+    DLOG_TRACE("ClientHandler::connectToServer - Ensuring client is connected");
     if (!client->isConnected()) {
-        if (!client->connect(advDevice)) {
-            Log.errorln("ClientHandler::connectToServer - Failed to connect");
-            return false;
+        if (!client->connect(peerAddress)) {
+            DLOG_ERROR("ClientHandler::connectToServer - Failed to connect");
+            return nullptr;
         }
     }
-    Log.info("Connected to: ");
-    Log.infoln(client->getPeerAddress().toString().c_str());
-    Log.trace("RSSI: ");
-    Log.traceln("%d", client->getRssi());
+    DLOG_DIRECT(LOG_LEVEL_INFO, "Connected to: %s", client->getPeerAddress().toString().c_str());
+    DLOG_TRACE("RSSI: %d", client->getRssi());
+
+    // Ask for the rest of the profile (data length and PHY) and report what was agreed
+    tuneConnection(client->getConnHandle(), linkProfile);
+    logLinkParameters(readLinkParameters(client->getConnInfo()), linkProfile);
+
+    DLOG_TRACE("ClientHandler::connectToServer - End");
+    return client;
+}
+
+bool ClientHandler::subscribeToIMU(NimBLEClient *client) {
+    DLOG_TRACE("ClientHandler::subscribeToIMU - Begin");
+
+    // Ptrs for the method
+    NimBLERemoteService *remoteService = nullptr;
+    NimBLERemoteCharacteristic *remoteIMUCharacteristic = nullptr;
 
     // Check the characteristics for the correct properties
-    Log.traceln("ClientHandler::connectToServer - Checking the characteristics");
+    DLOG_TRACE("ClientHandler::subscribeToIMU - Checking the characteristics");
     remoteService = client->getService(serviceUUID);
     if (remoteService) {
         remoteIMUCharacteristic = remoteService->getCharacteristic(IMUCharacteristicUUID);
@@ -199,27 +541,71 @@ bool ClientHandler::connectToServer() {
         if (remoteIMUCharacteristic) {
             // Make sure read is supported
             if (!remoteIMUCharacteristic->canRead()) {
-                Log.errorln("ClientHandler::connectToServer - IMU Characteristic does not support "
-                            "read");
-                client->disconnect();
+                DLOG_ERROR("ClientHandler::subscribeToIMU - IMU Characteristic does not support "
+                           "read");
                 return false;
             }
 
-            // Make sure notify is supported and subscribe
+            // Make sure notify is supported and subscribe. The notifications are received by
+            // gapHandler rather than a NimBLE callback
+            connHandle = client->getConnHandle();
+            IMUHandle = remoteIMUCharacteristic->getHandle();
             if (remoteIMUCharacteristic->canNotify()) {
-                if (!remoteIMUCharacteristic->subscribe(true, notifyCallback)) {
-                    Log.errorln("ClientHandler::connectToServer - Failed to subscribe to IMU "
-                                "Characteristic");
-                    client->disconnect();
+                if (!remoteIMUCharacteristic->subscribe(true, nullptr)) {
+                    DLOG_ERROR("ClientHandler::subscribeToIMU - Failed to subscribe to IMU "
+                               "Characteristic");
                     return false;
                 }
             }
+
+            // Remember the handles for the next connection
+            NimBLERemoteDescriptor *CCCD = remoteIMUCharacteristic->getDescriptor(NimBLEUUID(
+                    static_cast<uint16_t>(0x2902)));
+            if (CCCD != nullptr) {
+                cache.store(GATTCache::addressKey(peerAddress, peerAddress.getType()),
+                            {remoteIMUCharacteristic->getHandle(), CCCD->getHandle()});
+            }
+
+            // Request the encoding. Packets name their own encoding, so if the server cannot
+            // switch the floats it sends are still decoded
+            auto encodingID = static_cast<uint8_t>(encoding);
+            if (!remoteIMUCharacteristic->canWrite() ||
+                !remoteIMUCharacteristic->writeValue(&encodingID, 1, true)) {
+                DLOG_WARNING("ClientHandler::subscribeToIMU - Failed to request the IMU "
+                             "encoding");
+            }
+        } else {
+            DLOG_ERROR("ClientHandler::subscribeToIMU - IMU Characteristic not found");
+            return false;
         }
     } else {
-        Log.errorln("ClientHandler::connectToServer - Service not found");
+        DLOG_ERROR("ClientHandler::subscribeToIMU - Service not found");
         return false;
     }
 
-    Log.traceln("ClientHandler::connectToServer - End");
+    DLOG_TRACE("ClientHandler::subscribeToIMU - End");
     return true;
-}
\ No newline at end of file
+}
+
+bool ClientHandler::subscribeCached(NimBLEClient *client) {
+    GATTHandles handles = {};
+    if (!cache.lookup(GATTCache::addressKey(peerAddress, peerAddress.getType()), handles)) {
+        return false;
+    }
+
+    DLOG_TRACE("ClientHandler::subscribeCached - Subscribing with cached handles");
+    connHandle = client->getConnHandle();
+    IMUHandle = handles.IMUValue;
+
+    // Enable notifications and request the encoding without waiting for the responses. The
+    // handles are dropped if the server rejects them or never notifies
+    if (!cachedSubscription.subscribe(*client, GATTCache::addressKey(peerAddress,
+                                                                     peerAddress.getType()),
+                                      handles, static_cast<uint8_t>(encoding), millis())) {
+        DLOG_WARNING("ClientHandler::subscribeCached - Failed to write with cached handles");
+        IMUHandle = 0;
+        return false;
+    }
+
+    return true;
+}
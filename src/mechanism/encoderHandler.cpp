@@ -1,8 +1,10 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/19/2024
+// Last Modified: 10/16/2026
 
 #include "mechanism/encoderHandler.h"
+#include "hal/clock.h"
+#include "hal/quadratureCounter.h"
 
 // Set static inst to null and initialized to false
 EncoderHandler *EncoderHandler::inst = nullptr;
@@ -11,7 +13,7 @@ bool EncoderHandler::initialized = false;
 EncoderHandler::~EncoderHandler() noexcept { inst = nullptr; }
 
 void EncoderHandler::initialize(const std::array<std::array<uint8_t, 2>, 3> &pins) {
-    Log.traceln("EncoderHandler::initialize - Begin");
+    DLOG_TRACE("EncoderHandler::initialize - Begin");
 
     // Only initialize once
     if (initialized) {
@@ -28,19 +30,16 @@ void EncoderHandler::initialize(const std::array<std::array<uint8_t, 2>, 3> &pin
     }
 
     // Attach and make sure its successful
-    ESP32Encoder::useInternalWeakPullResistors = puType::up;
-    try {
-        for (size_t i(0); i < encoders.size(); ++i) {
-            encoders[i].attachFullQuad(pins[i][0], pins[i][1]);
-            encoders[i].clearCount();
+    for (size_t i(0); i < units.size(); ++i) {
+        units[i] = i;
+        if (!counterAttach(units[i], pins[i][0], pins[i][1])) {
+            throw std::runtime_error("EncoderHandler::initialize - Failed to attach an encoder");
         }
-    } catch (...) {
-        throw;
     }
 
     initialized = true;
-    Log.infoln("EncoderHandler::initialize - EncoderHandler initialized successfully");
-    Log.traceln("EncoderHandler::initialize - End");
+    DLOG_INFO("EncoderHandler::initialize - EncoderHandler initialized successfully");
+    DLOG_TRACE("EncoderHandler::initialize - End");
 }
 
 EncoderHandler *EncoderHandler::instance() {
@@ -51,46 +50,64 @@ EncoderHandler *EncoderHandler::instance() {
     return inst;
 }
 
-const std::array<int64_t, 3> &EncoderHandler::getCounts() const noexcept {
-    return counts;
+const EncoderState &EncoderHandler::getState() const noexcept {
+    return state;
 }
 
-void EncoderHandler::loop() {
-    while (true) {
-        EncoderHandler::instance()->updateCounts();
-        delay(100); // todo optimize this
+uint8_t EncoderHandler::addReader() {
+    uint8_t reader = readers.fetch_add(1);
+    if (reader >= MAX_READERS) {
+        throw std::logic_error("EncoderHandler::addReader - All reader indices are reserved");
     }
+
+    return reader;
+}
+
+EncoderState EncoderHandler::getSnapshot(const uint8_t &reader) const noexcept {
+    return snapshots.read(reader);
 }
 
-EncoderHandler::EncoderHandler() : counts{0, 0, 0} {}
+void EncoderHandler::update() noexcept {
+    DLOG_TRACE("EncoderHandler::update - Begin");
 
-void EncoderHandler::updateCounts() noexcept {
-    Log.traceln("EncoderHandler::updateCounts - Begin");
+    // Read the counts back to back so they share the timestamp
+    state.timestamp = clockMicros();
+    for (size_t i(0); i < units.size(); ++i) {
+        state.counts[i] = counterRead(units[i]);
+    }
 
-    for (size_t i(0); i < encoders.size(); ++i) {
-        counts[i] = encoders[i].getCount();
+    for (size_t i(0); i < estimators.size(); ++i) {
+        state.velocities[i] = estimators[i].update(state.counts[i], state.timestamp);
     }
+    ++state.version;
+    snapshots.write(state);
 
-    Log.verboseln("\tEncoder Counts:\t%d\t%d\t%d", counts[0], counts[1], counts[2]);
-    Log.traceln("EncoderHandler::updateCounts - End");
+    DLOG_VERBOSE("\tEncoder Counts:\t%d\t%d\t%d", static_cast<int32_t>(state.counts[0]),
+                 static_cast<int32_t>(state.counts[1]), static_cast<int32_t>(state.counts[2]));
+    DLOG_TRACE("EncoderHandler::update - End");
 }
 
+EncoderHandler::EncoderHandler() : units{0, 1, 2}, state{}, readers(0) {}
+
 void EncoderHandler::resetCounts() noexcept {
-    Log.traceln("EncoderHandler::resetCounts - Begin");
+    DLOG_TRACE("EncoderHandler::resetCounts - Begin");
 
-    for (size_t i(0); i < encoders.size(); ++i) {
-        int64_t temp = counts[i];
-        uint8_t result = encoders[i].clearCount();
+    for (size_t i(0); i < units.size(); ++i) {
+        int64_t temp = state.counts[i];
 
         // Ensure reset was successful
-        if (result != 0) {
-            Log.warningln("EncoderHandler::resetCounts - clearCount failed. Resetting counts");
-            encoders[i].setCount(temp);
+        if (!counterClear(units[i])) {
+            DLOG_WARNING("EncoderHandler::resetCounts - clearCount failed. Resetting counts");
+            counterWrite(units[i], temp);
         } else {
-            counts[i] = 0;
+            state.counts[i] = 0;
         }
+
+        // The jump in the count is not motion
+        estimators[i].reset(state.counts[i], clockMicros());
     }
 
-    Log.verboseln("\tEncoder Counts:\t%d\t%d\t%d", counts[0], counts[1], counts[2]);
-    Log.traceln("EncoderHandler::resetCounts - End");
+    DLOG_VERBOSE("\tEncoder Counts:\t%d\t%d\t%d", static_cast<int32_t>(state.counts[0]),
+                 static_cast<int32_t>(state.counts[1]), static_cast<int32_t>(state.counts[2]));
+    DLOG_TRACE("EncoderHandler::resetCounts - End");
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "mechanism/gattCache.h"
+#include <Preferences.h>
+
+// The NVS namespace and key of the cache
+static const char *NVS_NAMESPACE = "gattCache";
+static const char *NVS_KEY = "handles";
+
+GATTCache::GATTCache() noexcept: entry{}, persistent(false) {}
+
+void GATTCache::setPersistent(const bool &persistent) {
+    this->persistent = persistent;
+
+    if (persistent) {
+        Preferences preferences;
+        Entry stored = {};
+        if (preferences.begin(NVS_NAMESPACE, true)) {
+            if (preferences.getBytes(NVS_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+                stored.valid) {
+                entry = stored;
+            }
+            preferences.end();
+        }
+    }
+}
+
+bool GATTCache::lookup(const uint64_t &address, GATTHandles &handles) const noexcept {
+    if (!entry.valid || entry.address != address) {
+        return false;
+    }
+
+    handles = entry.handles;
+    return true;
+}
+
+void GATTCache::store(const uint64_t &address, const GATTHandles &handles) {
+    // Skip the NVS write if nothing changed
+    if (entry.valid && entry.address == address && entry.handles.IMUValue == handles.IMUValue &&
+        entry.handles.IMUCCCD == handles.IMUCCCD) {
+        return;
+    }
+
+    entry = {address, handles, true};
+    save();
+}
+
+void GATTCache::invalidate(const uint64_t &address) {
+    if (entry.valid && entry.address == address) {
+        entry.valid = false;
+        save();
+    }
+}
+
+uint64_t GATTCache::addressKey(const uint64_t &address, const uint8_t &type) noexcept {
+    return (address & 0xFFFFFFFFFFFFULL) | (static_cast<uint64_t>(type) << 48);
+}
+
+void GATTCache::save() const {
+    if (!persistent) {
+        return;
+    }
+
+    Preferences preferences;
+    if (preferences.begin(NVS_NAMESPACE, false)) {
+        preferences.putBytes(NVS_KEY, &entry, sizeof(entry));
+        preferences.end();
+    }
+}
@@ -1,6 +1,6 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/25/24
+// Last Modified: 10/16/2026
 
 //================================================================================================//
 
@@ -18,17 +18,24 @@
  *      BLE Client
  *      Encoders
  *      Motors
+ *      Control Loop
  */
 
 //================================================================================================//
 
+// Compile every message of this file in, so LOG_LEVEL alone selects what is shown
+#define LOG_MODULE_LEVEL LOG_LEVEL_VERBOSE
+
 // #include the necessary header files - Do not edit
 #include <Arduino.h>
 #include <ArduinoLog.h>
 #include <array>
 #include "mechanism/clientHandler.h"
 #include "mechanism/encoderHandler.h"
+#include "mechanism/motorCalibration.h"
 #include "control/factory.h"
+#include "control/scheduler.h"
+#include "logging/deferredLog.h"
 
 /*
  * Logging
@@ -42,9 +49,15 @@
  *      4 - LOG_LEVEL_NOTICE     errors, warnings and notices
  *      5 - LOG_LEVEL_TRACE      errors, warnings, notices & traces
  *      6 - LOG_LEVEL_VERBOSE    all
- * Uncomment one of the lines below to select the desired logging level. To remove logging for
- * certain files go into their .h files and uncomment '#define DISABLE_LOGGING'. To completely
- * remove logging, go into the ArduinoLog.h file and uncomment line 38 to define DISABLE_LOGGING.
+ * Uncomment one of the lines below to select the desired logging level.
+ *
+ * The handlers and control algos defer their messages (see logging/deferredLog.h) so writing to
+ * the Serial port never stalls the control loop or a BLE callback. A low priority task writes
+ * them out every LOG_DRAIN_INTERVAL ms. Messages more detailed than a file's compile-time level
+ * are removed from the build entirely. The level is LOG_LEVEL_INFO unless the build sets
+ * -DLOG_COMPILED_LEVEL=<level> in platformio.ini, and a file can set its own by defining
+ * LOG_MODULE_LEVEL before its first #include (as this file does). To completely remove logging,
+ * go into the ArduinoLog.h file and uncomment line 38 to define DISABLE_LOGGING.
  *
  * Set the baud rate for serial communication. This should match the value in the platformio.ini
  * file.
@@ -59,6 +72,11 @@
 // constexpr uint8_t LOG_LEVEL = LOG_LEVEL_TRACE;
 constexpr uint8_t LOG_LEVEL = LOG_LEVEL_VERBOSE;
 constexpr uint32_t BAUD_RATE = 115200;  // The baud rate for serial communication
+constexpr uint32_t LOG_DRAIN_INTERVAL = 10; // The time between writing out deferred messages in ms
+constexpr uint8_t LOG_PRIORITY = 1; // The FreeRTOS priority of the logging task
+
+// Program Variables
+TaskHandle_t logLoopHandle = nullptr;   // Ptr to the logging FreeRTOS task
 
 /*
  * Configure BLE Client
@@ -66,6 +84,9 @@ constexpr uint32_t BAUD_RATE = 115200;  // The baud rate for serial communicatio
  * This section configures the BLE Client by setting the UUIDs and device name. The UUIDs need to
  * match those set in server/server.cpp in order for the client to connect properly. New UUIDs
  * can be generated at https://www.uuidgenerator.net/
+ *
+ * The link profile sets the MTU, data length, PHY and connection interval requested from the
+ * server. The control loop needs each IMU sample within 7.5-15 ms
  */
 
 // Configuration Variables
@@ -78,6 +99,9 @@ const std::string DEVICE_NAME = "Controller";   // The name of the device that t
 constexpr uint8_t SCAN_TIME = 0;        // The duration of a scan in ms (0 is indefinite)
 constexpr uint32_t SCAN_WINDOW = 15;    // The scan window in ms
 constexpr uint32_t SCAN_INTERVAL = 45;  // The scan interval in ms
+constexpr IMUEncoding IMU_ENCODING = IMUEncoding::SmallestThree;    // The quaternion encoding
+constexpr LinkProfile LINK_PROFILE = LOW_LATENCY_LINK;  // The link settings to request
+constexpr bool PERSIST_HANDLES = true;  // If the server's GATT handles are kept in NVS
 
 // Program Variables
 TaskHandle_t clientLoopHandle = nullptr;    // Ptr to the client's FreeRTOS task
@@ -87,7 +111,8 @@ TaskHandle_t clientLoopHandle = nullptr;    // Ptr to the client's FreeRTOS task
  *
  * This section configures the encoders attached to the Pololu 34:1 motor which tracks the
  * shafts' rotation. Set the following pin variables to the corresponding GPIO pins on the ESP32.
- * The yellow wires correspond to Channel A, and white wires Channel B.
+ * The yellow wires correspond to Channel A, and white wires Channel B. The encoders are sampled
+ * at the start of every control loop tick. Other tasks read them through their own reader index.
  */
 
 // Configuration Variables
@@ -105,13 +130,18 @@ constexpr std::array<std::array<uint8_t, 2>, 3> encoderPins = {FIRST_ENCODER_PIN
                                                                SECOND_ENCODER_PIN_B,
                                                                THIRD_ENCODER_PIN_A,
                                                                THIRD_ENCODER_PIN_B};
-TaskHandle_t encoderLoopHandle = nullptr;   // Ptr to the encoder's FreeRTOS task
+uint8_t encoderReader = 0;  // The statistics loop's reader index for encoder snapshots
 
 /*
  * Configure Motors
  *
  * This section configures the motors with the DRV8871 motor drivers. Set the following pin
- * variables to the corresponding GPIO pins on the ESP32. Set the PWM frequency and resolution
+ * variables to the corresponding GPIO pins on the ESP32. Set the PWM frequency and resolution, and
+ * how long a motor brakes before it is reversed (at least 2 PWM periods). Set the duty cycle each
+ * motor needs to overcome static friction, and how fast and hard the motors may be driven (see
+ * mechanism/motorHandler.h). With USE_MOTOR_CALIBRATION, the deadbands and velocity loop gains
+ * measured by the motor driver hardware test (hardwareTests/motorDrivers.cpp) are loaded from NVS
+ * in place of MOTOR_DEADBANDS and VELOCITY_GAINS when a profile is stored
  */
 
 // Configuration Variables
@@ -123,6 +153,10 @@ constexpr uint8_t THIRD_DRIVER_PWM_PIN = 0;
 constexpr uint8_t THIRD_DRIVER_DIRECTION_PIN = 0;
 constexpr uint32_t PWM_FREQUENCY = 20000;   // The frequency of the PWM signal
 constexpr uint8_t PWM_RESOLUTION = 8;   // The resolution of the PWM duty cycle in bits
+constexpr uint32_t DIRECTION_DEADTIME = 500;    // How long a motor brakes before reversing in us
+constexpr std::array<float, 3> MOTOR_DEADBANDS = {0.05f, 0.05f, 0.05f}; // The duty to start moving
+constexpr MotorLimits MOTOR_LIMITS = DEFAULT_MOTOR_LIMITS;  // The slew rate and current limits
+constexpr bool USE_MOTOR_CALIBRATION = true;    // If a stored calibration profile is applied
 
 // Program Variables
 constexpr std::array<std::array<uint8_t, 2>, 3> motorPins = {FIRST_DRIVER_DIRECTION_PIN,
@@ -131,35 +165,181 @@ constexpr std::array<std::array<uint8_t, 2>, 3> motorPins = {FIRST_DRIVER_DIRECT
                                                              SECOND_DRIVER_PWM_PIN,
                                                              THIRD_DRIVER_DIRECTION_PIN,
                                                              THIRD_DRIVER_PWM_PIN};
+std::array<float, 3> motorDeadbands = MOTOR_DEADBANDS;  // The deadbands applied to the motors
+
+/*
+ * Control Loop
+ *
+ * This section configures the scheduler that runs the control algorithms. A hardware timer wakes
+ * the control task at CONTROL_RATE, and the task is pinned to CONTROL_CORE so the BLE stack (core
+ * 0) does not disturb its timing. Deadline misses, jitter and the BLE link statistics are logged
+ * every STATISTICS_INTERVAL ms at the trace level.
+ *
+ * Each tick the setpoint orientation moves toward the control algo's target by at most
+ * MAX_ANGULAR_SPEED, which sets how aggressively the eye moves. The orientation error is turned
+ * into an angular velocity command by ATTITUDE_GAIN, which is turned into wheel speeds using
+ * DRIVE_GEOMETRY (where each wheel touches the eyeball, see control/kinematics.h). Each wheel's
+ * velocity loop then drives its motor to that speed using the encoder counts, with
+ * VELOCITY_GAINS (see control/velocityController.h). If the control algo fails, the motors are
+ * stopped and held until the switches select a different algo.
+ */
+
+// Configuration Variables
+constexpr uint32_t CONTROL_RATE = 1000;    // The rate of the control loop in Hz
+constexpr uint8_t CONTROL_TIMER = 0;    // The hardware timer that drives the control loop (0 - 3)
+constexpr uint8_t CONTROL_CORE = 1;     // The core the control loop runs on
+constexpr uint8_t CONTROL_PRIORITY = 3; // The FreeRTOS priority of the control loop
+constexpr uint32_t STATISTICS_INTERVAL = 1000;  // The time between scheduler statistics in ms
+constexpr uint32_t SWITCH_DEBOUNCE_TIME = 50;   // The time a switch input must be stable in ms
+constexpr float MAX_ANGULAR_SPEED = 3.0f;   // The fastest the setpoint may rotate in rad/s
+constexpr float ATTITUDE_GAIN = 8.0f;   // The angular velocity per rad of error in 1/s
+constexpr DriveGeometry DRIVE_GEOMETRY = DEFAULT_DRIVE; // The geometry of the wheels
+constexpr VelocityGains VELOCITY_GAINS = DEFAULT_VELOCITY_GAINS; // The wheels' velocity loops
+
+// Program Variables
+TaskHandle_t schedulerLoopHandle = nullptr; // Ptr to the scheduler's FreeRTOS task
+VelocityGains velocityGains = VELOCITY_GAINS;   // The gains applied to the velocity loops
 
 //================================================================================================//
 
 /**
- * Restart the ESP32
+ * Restart the ESP32, after the deferred messages have been written out
  */
 void restart() {
+    // Only the logging task may drain the deferred messages once it is running
+    if (logLoopHandle != nullptr) {
+        delay(2 * LOG_DRAIN_INTERVAL);
+    } else {
+        DeferredLog::instance()->drain();
+    }
     Log.fatalln("Fatal error occurred. Restarting the ESP32");
     ESP.restart();
 }
 
 /**
- * A freeRTOS task for the EncoderHandler loop
+ * A freeRTOS task for the ClientHandler loop
  *
  * @param param - Any parameters to be used by the task (none)
  */
-void encoderLoopTask(void *param) {
-    Log.infoln("Starting EncoderHandler loop");
-    EncoderHandler::instance()->loop();
+void clientLoopTask(void *param) {
+    DLOG_INFO("Starting ClientHandler loop");
+    ClientHandler::instance()->loop();
 }
 
 /**
- * A freeRTOS task for the ClientHandler loop
+ * A freeRTOS task that writes out the deferred log messages
  *
  * @param param - Any parameters to be used by the task (none)
  */
-void clientLoopTask(void *param) {
-    Log.infoln("Starting ClientHandler loop");
-    ClientHandler::instance()->loop();
+void logLoopTask(void *param) {
+    DeferredLog::instance()->loop(LOG_DRAIN_INTERVAL);
+}
+
+/**
+ * A freeRTOS task for the Scheduler loop
+ *
+ * @param param - Any parameters to be used by the task (none)
+ */
+void schedulerLoopTask(void *param) {
+    DLOG_INFO("Starting Scheduler loop");
+
+    try {
+        Scheduler::instance()->loop();
+    } catch (const std::exception &ex) {
+        DLOG_DIRECT(LOG_LEVEL_ERROR, "Failed to run the Scheduler loop - %s", ex.what());
+        restart();
+    }
+}
+
+/**
+ * Read and debounce the control switches. A change in the switch input is only reported once it
+ * has been stable for SWITCH_DEBOUNCE_TIME
+ *
+ * @return The debounced switch input
+ */
+std::array<uint8_t, 3> readSwitches() {
+    static std::array<uint8_t, 3> stableInput = {1, 0, 0};  // The last debounced input
+    static std::array<uint8_t, 3> candidateInput = stableInput; // The input being debounced
+    static uint32_t candidateTime = 0;  // When the candidate input was first seen
+
+    // Check the switches //todo read the switch pins (for now just dbt2)
+    std::array<uint8_t, 3> rawInput = {1, 0, 0};
+    uint32_t now = millis();
+
+    if (rawInput != candidateInput) {
+        candidateInput = rawInput;
+        candidateTime = now;
+    } else if (candidateInput != stableInput && now - candidateTime >= SWITCH_DEBOUNCE_TIME) {
+        stableInput = candidateInput;
+    }
+
+    return stableInput;
+}
+
+/**
+ * Stop the motors after the control algo could not be made or executed, and hold them stopped
+ * until the switches select a different algo, so a failing algo is not retried (and logged) every
+ * tick
+ *
+ * @param switches - The switch input the algo failed with
+ */
+std::array<uint8_t, 3> failedSwitches = {}; // The switch input the control algo failed with
+bool controlFailed = false; // If the motors are held stopped after the control algo failed
+void stopControl(const std::array<uint8_t, 3> &switches) {
+    failedSwitches = switches;
+    controlFailed = true;
+    DLOG_WARNING("Stopping the motors until a different control algorithm is selected");
+
+    try {
+        MotorHandler::instance()->setMotorSpeeds({0, 0, 0});
+    } catch (...) {
+        DLOG_ERROR("Failed to stop the motors");
+    }
+}
+
+/**
+ * The control loop executed by the Scheduler every tick. It samples the encoders, checks the
+ * control switches and executes the correct control algorithm
+ */
+Factory factory;   // Factory instance to make control algos
+void controlLoop() {
+    EncoderHandler::instance()->update();
+    std::array<uint8_t, 3> switches = readSwitches();
+
+    // After a failure, wait for a different algo to be selected
+    if (controlFailed) {
+        if (switches == failedSwitches) {
+            return;
+        }
+
+        controlFailed = false;
+        DLOG_NOTICE("Control algorithm selection changed. Resuming control");
+    }
+
+    // Select the correct control algo. It is only swapped when the switches change
+    ControlAlgo *controlAlgo;
+    try {
+        controlAlgo = &factory.makeControlAlgo(switches);
+    } catch (const std::exception &ex) {
+        DLOG_DIRECT(LOG_LEVEL_ERROR, "Failed to create control algorithm - %s", ex.what());
+        stopControl(switches);
+        return;
+    } catch (...) {
+        DLOG_ERROR("Failed to create control algorithm - Unknown Error");
+        stopControl(switches);
+        return;
+    }
+
+    // Execute the control algo
+    try {
+        controlAlgo->execute();
+    } catch (const std::exception &ex) {
+        DLOG_DIRECT(LOG_LEVEL_ERROR, "Failed to execute control algorithm - %s", ex.what());
+        stopControl(switches);
+    } catch (...) {
+        DLOG_ERROR("Failed to execute control algorithm - Unknown Error");
+        stopControl(switches);
+    }
 }
 
 void setup() {
@@ -171,6 +351,7 @@ void setup() {
     // Initialize the EncoderHandler
     try {
         EncoderHandler::instance()->initialize(encoderPins);
+        encoderReader = EncoderHandler::instance()->addReader();
     } catch (const std::exception &ex) {
         Log.errorln("Failed to initialize EncoderHandler - %s", ex.what());
         restart();
@@ -179,19 +360,11 @@ void setup() {
         restart();
     }
 
-    // Create background task for the encoder
-    BaseType_t encoderResult = xTaskCreate(encoderLoopTask, "EncoderHandler::Loop",
-                                           2048, nullptr, 1, &encoderLoopHandle);
-
-    if (encoderResult != pdPASS) {
-        Log.errorln("Failed to create encoderLoopTask");
-        restart();
-    }
-
     // Initialize the BLE Client
     try {
         ClientHandler::instance()->initialize(SERVICE_UUID, IMU_CHARACTERISTIC_UUID, DEVICE_NAME,
-                                              SCAN_TIME, SCAN_WINDOW, SCAN_INTERVAL);
+                                              SCAN_TIME, SCAN_WINDOW, SCAN_INTERVAL,
+                                              IMU_ENCODING, LINK_PROFILE, PERSIST_HANDLES);
     } catch (const std::exception &ex) {
         Log.errorln("Failed to initialize ClientHandler - %s", ex.what());
         restart();
@@ -201,36 +374,98 @@ void setup() {
     }
 
     // Create background task for the client
-    BaseType_t clientResult = xTaskCreate(clientLoopTask, "EncoderHandler::Loop",
-                                    2048, nullptr, 2, &encoderLoopHandle);
+    BaseType_t clientResult = xTaskCreate(clientLoopTask, "ClientHandler::Loop",
+                                    4096, nullptr, 2, &clientLoopHandle);
 
     if (clientResult != pdPASS) {
         Log.errorln("Failed to create clientLoopTask");
         restart();
     }
 
-    //todo init motorhand
-   // MotorHandler::instance()->initialize(motorPins, PWM_FREQUENCY, PWM_RESOLUTION);
+    // Load the calibration profile, if there is one
+    MotorCalibration calibration = {};
+    if (USE_MOTOR_CALIBRATION && loadMotorCalibration(calibration)) {
+        for (size_t i(0); i < motorDeadbands.size(); ++i) {
+            motorDeadbands[i] = calibration.models[i].deadband;
+        }
+        velocityGains = calibration.gains;
+        Log.infoln("Motor calibration profile loaded");
+    }
+
+    // Initialize the MotorHandler
+    try {
+        MotorHandler::instance()->initialize(motorPins, PWM_FREQUENCY, PWM_RESOLUTION,
+                                             DIRECTION_DEADTIME);
+        MotorHandler::instance()->setDeadbands(motorDeadbands);
+        MotorHandler::instance()->setLimits(MOTOR_LIMITS);
+    } catch (const std::exception &ex) {
+        Log.errorln("Failed to initialize MotorHandler - %s", ex.what());
+        restart();
+    } catch (...) {
+        Log.errorln("Failed to initialize MotorHandler - Unknown Error");
+        restart();
+    }
+
+    // Initialize the Scheduler
+    try {
+        ControlAlgoImpl::setMaxAngularSpeed(MAX_ANGULAR_SPEED);
+        ControlAlgoImpl::setAttitudeGain(ATTITUDE_GAIN);
+        ControlAlgoImpl::setDriveGeometry(DRIVE_GEOMETRY);
+        ControlAlgoImpl::setVelocityGains(velocityGains);
+        Scheduler::instance()->initialize(CONTROL_RATE, CONTROL_TIMER, controlLoop);
+    } catch (const std::exception &ex) {
+        Log.errorln("Failed to initialize Scheduler - %s", ex.what());
+        restart();
+    } catch (...) {
+        Log.errorln("Failed to initialize Scheduler - Unknown Error");
+        restart();
+    }
+
+    // Create the control loop task pinned to its own core
+    BaseType_t schedulerResult = xTaskCreatePinnedToCore(schedulerLoopTask, "Scheduler::Loop",
+                                                         4096, nullptr, CONTROL_PRIORITY,
+                                                         &schedulerLoopHandle, CONTROL_CORE);
+
+    if (schedulerResult != pdPASS) {
+        Log.errorln("Failed to create schedulerLoopTask");
+        restart();
+    }
+
+    // Create the task that writes out the deferred messages. From here on it is the only writer
+    // to the Serial port, so the rest of the program defers its messages too
+    BaseType_t logResult = xTaskCreate(logLoopTask, "DeferredLog::Loop", 4096, nullptr,
+                                       LOG_PRIORITY, &logLoopHandle);
+
+    if (logResult != pdPASS) {
+        Log.errorln("Failed to create logLoopTask");
+        restart();
+    }
 }
 
 /**
- * This is the main loop for the program. It checks the control switches and executes the correct
- * control algorithm
+ * This is the main loop for the program. The control loop runs in the Scheduler's task, so this
+ * only reports the scheduler's timing, BLE link and connection statistics and the encoders
  */
-Factory factory;   // Factory instance to make control algos
 void loop() {
-    // Check the switches //todo eventually this will be dynamic w debounce (for now just dbt2)
-    std::array<uint8_t, 3> switchInput = {1, 0, 0};
+    SchedulerStatistics statistics = Scheduler::instance()->getStatistics();
+    DLOG_TRACE("Scheduler - Ticks: %u Misses: %u Worst Jitter: %u us Worst Execution: %u us",
+               statistics.ticks, statistics.deadlineMisses, statistics.worstJitter,
+               statistics.worstExecutionTime);
 
-    try {
-        // Create the correct control algo
-        ControlAlgo controlAlgo = factory.makeControlAlgo(switchInput);
+    LinkStatistics link = ClientHandler::instance()->getLinkStatistics();
+    DLOG_TRACE("Link - Received: %u Dropped: %u Interval: %u us Jitter: %u us (max %u us) Age: "
+               "%u us (max %u us)", link.received, link.dropped, link.interval, link.jitter,
+               link.maxJitter, link.age, link.maxAge);
 
-        // Execute the control algo
-        controlAlgo.execute();
-    } catch (const std::exception &ex) {
-        Log.errorln("Failed to create or execute control algorithm - %s", ex.what());
-    } catch (...) {
-        Log.errorln("Failed to create or execute control algorithm - Unknown Error");
-    }
+    ConnectionStatistics connection = ClientHandler::instance()->getConnectionStatistics();
+    DLOG_TRACE("Connection - State: %d Connects: %u Failures: %u Disconnects: %u Reconnect: %u "
+               "ms (max %u ms)", static_cast<uint8_t>(connection.state), connection.connects,
+               connection.failures, connection.disconnects, connection.reconnectTime,
+               connection.maxReconnectTime);
+
+    EncoderState encoders = EncoderHandler::instance()->getSnapshot(encoderReader);
+    DLOG_TRACE("Encoders - Counts: %l %l %l Version: %u Time: %u us",
+               static_cast<int32_t>(encoders.counts[0]), static_cast<int32_t>(encoders.counts[1]),
+               static_cast<int32_t>(encoders.counts[2]), encoders.version, encoders.timestamp);
+    delay(STATISTICS_INTERVAL);
 }
\ No newline at end of file
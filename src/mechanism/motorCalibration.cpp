@@ -0,0 +1,50 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "mechanism/motorCalibration.h"
+#include <Preferences.h>
+
+// The NVS namespace and key of the profile
+static const char *NVS_NAMESPACE = "motorCal";
+static const char *NVS_KEY = "profile";
+
+// The layout of the stored profile. Raise it whenever MotorCalibration changes
+static constexpr uint32_t PROFILE_VERSION = 1;
+
+/**
+ * The profile as stored in NVS
+ */
+struct Entry {
+    uint32_t version;   // The layout the profile was stored with
+    MotorCalibration calibration;   // The profile
+};
+
+bool loadMotorCalibration(MotorCalibration &calibration) {
+    Preferences preferences;
+    if (!preferences.begin(NVS_NAMESPACE, true)) {
+        return false;
+    }
+
+    Entry stored = {};
+    bool valid = preferences.getBytes(NVS_KEY, &stored, sizeof(stored)) == sizeof(stored) &&
+                 stored.version == PROFILE_VERSION;
+    preferences.end();
+
+    if (valid) {
+        calibration = stored.calibration;
+    }
+    return valid;
+}
+
+bool saveMotorCalibration(const MotorCalibration &calibration) {
+    Preferences preferences;
+    if (!preferences.begin(NVS_NAMESPACE, false)) {
+        return false;
+    }
+
+    Entry entry = {PROFILE_VERSION, calibration};
+    bool written = preferences.putBytes(NVS_KEY, &entry, sizeof(entry)) == sizeof(entry);
+    preferences.end();
+    return written;
+}
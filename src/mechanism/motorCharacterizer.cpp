@@ -0,0 +1,208 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "mechanism/motorCharacterizer.h"
+#include "mechanism/encoderHandler.h"
+#include "mechanism/motorHandler.h"
+#include "logging/deferredLog.h"
+
+// The fraction of a step's change in speed reached after one time constant
+static constexpr float RISE_FRACTION = 0.632f;
+
+constexpr float MotorCharacterizer::SWEEP[];
+
+MotorCharacterizer::MotorCharacterizer(const CharacterizationSettings &settings,
+                                       const float &radiansPerCount) noexcept
+        : settings(settings), radiansPerCount(radiansPerCount) {}
+
+void MotorCharacterizer::start(const uint32_t &now) noexcept {
+    motor = 0;
+    models = {};
+    failed = false;
+    afterRest = Stage::RampForward;
+    enter(Stage::Rest, now);
+}
+
+bool MotorCharacterizer::update(const uint32_t &now) {
+    if (stage == Stage::Done) {
+        return false;
+    }
+
+    float elapsed = static_cast<float>(now - stageStart) * 1.0e-6f;
+    float speed = EncoderHandler::instance()->getState().velocities[motor] * radiansPerCount;
+
+    switch (stage) {
+        case Stage::RampForward:
+        case Stage::RampReverse: {
+            // Ramp until the wheel turns. A motor that does not move by the limit fails the run
+            float duty = settings.rampRate * elapsed;
+            size_t direction = stage == Stage::RampForward ? 0 : 1;
+            if (fabsf(speed) >= settings.startSpeed || duty > settings.rampLimit) {
+                breakaways[direction] = duty;
+                failed = failed || duty > settings.rampLimit;
+                afterRest = direction == 0 ? Stage::RampReverse : Stage::Sweep;
+                enter(Stage::Rest, now);
+            } else {
+                drive(direction == 0 ? duty : -duty);
+            }
+            break;
+        }
+
+        case Stage::Sweep:
+            if (sampleCount < samples.size()) {
+                samples[sampleCount] = speed;
+                sampleTimes[sampleCount] = now;
+                ++sampleCount;
+            }
+
+            if (elapsed * 1000.0f >= static_cast<float>(settings.stepTime)) {
+                finishStep();
+                if (++step < SWEEP_STEPS) {
+                    stageStart = now;
+                    sampleCount = 0;
+                    drive(SWEEP[step]);
+                } else {
+                    fitModel();
+                    afterRest = ++motor < models.size() ? Stage::RampForward : Stage::Done;
+                    if (afterRest == Stage::Done) {
+                        --motor;
+                    }
+                    enter(Stage::Rest, now);
+                }
+            }
+            break;
+
+        case Stage::Rest:
+            // Coast for at least a step until the wheel has stopped
+            if (elapsed * 1000.0f >= static_cast<float>(settings.stepTime) &&
+                fabsf(speed) < settings.startSpeed) {
+                enter(afterRest, now);
+            }
+            break;
+
+        case Stage::Done:
+            break;
+    }
+
+    return stage != Stage::Done;
+}
+
+bool MotorCharacterizer::succeeded() const noexcept {
+    return stage == Stage::Done && !failed;
+}
+
+const std::array<MotorModel, 3> &MotorCharacterizer::getModels() const noexcept {
+    return models;
+}
+
+void MotorCharacterizer::drive(const float &duty) {
+    MotorHandler *motorHandler = MotorHandler::instance();
+    std::array<int16_t, 3> speeds = {};
+    speeds[motor] = static_cast<int16_t>(lroundf(duty * motorHandler->getMaxSpeed()));
+    motorHandler->setMotorSpeeds(speeds);
+}
+
+void MotorCharacterizer::enter(const Stage &next, const uint32_t &now) {
+    stage = next;
+    stageStart = now;
+
+    switch (stage) {
+        case Stage::Sweep:
+            step = 0;
+            sampleCount = 0;
+            drive(SWEEP[0]);
+            break;
+
+        case Stage::Done:
+            MotorHandler::instance()->setMotorSpeeds({0, 0, 0});
+            break;
+
+        default:
+            drive(0.0f);
+            break;
+    }
+}
+
+void MotorCharacterizer::finishStep() {
+    // The steady speed is the mean over the last third of the step
+    float sum = 0.0f;
+    size_t count = 0;
+    uint32_t steadyStart = stageStart + settings.stepTime * 2000 / 3;
+    for (size_t i(0); i < sampleCount; ++i) {
+        if (static_cast<int32_t>(sampleTimes[i] - steadyStart) >= 0) {
+            sum += samples[i];
+            ++count;
+        }
+    }
+    steadySpeeds[step] = count > 0 ? sum / static_cast<float>(count) : 0.0f;
+
+    // Time the step from the last steady speed (rest for the first). A reversal passes through
+    // the deadband and the direction deadtime, so it is not first order and is skipped
+    riseTimes[step] = 0.0f;
+    float duty = SWEEP[step];
+    float lastDuty = step > 0 ? SWEEP[step - 1] : 0.0f;
+    if (duty * lastDuty < 0.0f) {
+        return;
+    }
+
+    float from = step > 0 ? steadySpeeds[step - 1] : 0.0f;
+    float change = steadySpeeds[step] - from;
+    for (size_t i(0); i < sampleCount && fabsf(change) > settings.startSpeed; ++i) {
+        if ((samples[i] - from) / change >= RISE_FRACTION) {
+            riseTimes[step] = static_cast<float>(sampleTimes[i] - stageStart) * 1.0e-6f;
+            break;
+        }
+    }
+}
+
+void MotorCharacterizer::fitModel() {
+    // Least squares of the steady speed against the duty cycle, both ways at once
+    float sumDuty = 0.0f;
+    float sumSpeed = 0.0f;
+    float sumDutySquared = 0.0f;
+    float sumProduct = 0.0f;
+    float riseSum = 0.0f;
+    size_t rises = 0;
+
+    for (size_t i(0); i < SWEEP_STEPS; ++i) {
+        float duty = fabsf(SWEEP[i]);
+        float speed = SWEEP[i] < 0.0f ? -steadySpeeds[i] : steadySpeeds[i];
+        sumDuty += duty;
+        sumSpeed += speed;
+        sumDutySquared += duty * duty;
+        sumProduct += duty * speed;
+
+        if (riseTimes[i] > 0.0f) {
+            riseSum += riseTimes[i];
+            ++rises;
+        }
+    }
+
+    float n = static_cast<float>(SWEEP_STEPS);
+    float denominator = n * sumDutySquared - sumDuty * sumDuty;
+    MotorModel &model = models[motor];
+    model.deadband = (breakaways[0] + breakaways[1]) / 2.0f;
+    model.gain = (n * sumProduct - sumDuty * sumSpeed) / denominator;
+    model.timeConstant = rises > 0 ? riseSum / static_cast<float>(rises) : 0.0f;
+    failed = failed || !(model.gain > 0.0f) || !(model.timeConstant > 0.0f);
+
+    DLOG_NOTICE("MotorCharacterizer - Motor %u Deadband: %F Gain: %F rad/s Time Constant: %F s",
+                static_cast<uint32_t>(motor), model.deadband, model.gain, model.timeConstant);
+}
+
+VelocityGains deriveVelocityGains(const std::array<MotorModel, 3> &models,
+                                  const CharacterizationSettings &settings) noexcept {
+    float gain = 0.0f;
+    float timeConstant = 0.0f;
+    for (const auto &model : models) {
+        gain += model.gain / static_cast<float>(models.size());
+        timeConstant += model.timeConstant / static_cast<float>(models.size());
+    }
+
+    // IMC: Kp = τ / (K (λ + θ)) and Ti = τ, with λ = closedLoopRatio τ
+    float lambda = settings.closedLoopRatio * timeConstant;
+    float proportional = timeConstant / (gain * (lambda + settings.delay));
+    return {proportional, proportional / timeConstant, 0.0f, 1.0f / gain,
+            DEFAULT_VELOCITY_GAINS.derivativeFilter};
+}
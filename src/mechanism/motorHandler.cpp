@@ -1,11 +1,15 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/24/2024
+// Last Modified: 10/16/2026
 
 #include "mechanism/motorHandler.h"
+#include "hal/clock.h"
+#include "hal/gpio.h"
+#include "hal/pwm.h"
 
 // Set static inst to null and initialized to false
 MotorHandler *MotorHandler::inst = nullptr;
+bool MotorHandler::initialized = false;
 
 MotorHandler::~MotorHandler() noexcept { inst = nullptr; }
 
@@ -17,8 +21,8 @@ MotorHandler *MotorHandler::instance() {
     return inst;
 }
 
-void MotorHandler::initialize(const std::array<std::array<uint8_t, 2>, 3> &motorPins, const uint32_t &PWM_FREQUENCY, const uint8_t &PWM_RESOLUTION) {
-    Log.traceln("MotorHandler::initialize - Begin");
+void MotorHandler::initialize(const std::array<std::array<uint8_t, 2>, 3> &motorPins, const uint32_t &PWM_FREQUENCY, const uint8_t &PWM_RESOLUTION, const uint32_t &DIRECTION_DEADTIME) {
+    DLOG_TRACE("MotorHandler::initialize - Begin");
 
     // Can only initialize once
     if (initialized) {
@@ -43,35 +47,199 @@ void MotorHandler::initialize(const std::array<std::array<uint8_t, 2>, 3> &motor
     }
     resolution = PWM_RESOLUTION;
 
+    // A held duty cycle only latches at the end of a period, so brake for 2 periods
+    if (PWM_FREQUENCY == 0 || DIRECTION_DEADTIME < 2000000 / PWM_FREQUENCY) {
+        throw std::logic_error("MotorHandler::initialize - DIRECTION_DEADTIME is shorter than 2 "
+                               "PWM periods");
+    }
+    directionDeadtime = DIRECTION_DEADTIME;
+
     for (size_t i(0); i < drivers.size(); ++i) {
         // Set direction pin values
         drivers[i].directionPin = motorPins[i][0];
-        pinMode(drivers[i].directionPin, OUTPUT);
-        digitalWrite(drivers[i].directionPin, LOW);
+        gpioOutput(drivers[i].directionPin);
+        gpioWrite(drivers[i].directionPin, false);
+        drivers[i].reverse = false;
+        drivers[i].stopped = true;
+        drivers[i].stoppedSince = clockMicros();
+        drivers[i].speed = 0;
 
         // Set pwm pin
         drivers[i].pwmPin = motorPins[i][1];
-        ledcSetup(i, PWM_FREQUENCY, PWM_RESOLUTION);
-        ledcAttachPin(drivers[i].pwmPin, i);
-        ledcWrite(i, 0);
+        if (!pwmSetup(i, PWM_FREQUENCY, PWM_RESOLUTION)) {
+            throw std::runtime_error("MotorHandler::initialize - Failed to set up PWM");
+        }
+        pwmAttach(drivers[i].pwmPin, i);
+        pwmWrite(i, 0);
     }
 
+    // Brake every motor, holding IN1 high before IN2 is raised
+    uint64_t directionPins = 0;
+    for (const MotorDriver &driver : drivers) {
+        directionPins |= 1ULL << driver.directionPin;
+    }
+    pwmHold((1 << drivers.size()) - 1);
+    gpioWriteMask(directionPins, 0);
+
     initialized = true;
-    Log.infoln("MotorHandler Initialized successfully");
-    Log.traceln("MotorHandler::initialize - End");
+    DLOG_INFO("MotorHandler Initialized successfully");
+    DLOG_TRACE("MotorHandler::initialize - End");
+}
+
+std::array<int16_t, 3> MotorHandler::setMotorSpeeds(const std::array<int16_t, 3> &speeds) {
+    if (!initialized) {
+        throw std::logic_error("MotorHandler::setMotorSpeeds - MotorHandler is not initialized");
+    }
+
+    int16_t maxDutyCycle = getMaxSpeed();
+    uint32_t now = clockMicros();
+    std::array<int16_t, 3> applied = {};
+    uint64_t high = 0;
+    uint64_t low = 0;
+    uint16_t held = 0;
+    uint16_t driven = 0;
+
+    // Determine every dutyCycle and direction before touching the outputs
+    for (size_t i(0); i < speeds.size(); ++i) {
+        applied[i] = constrain(speeds[i], -maxDutyCycle, maxDutyCycle);
+        bool reverse = applied[i] < 0;
+
+        // Only drive a motor the other way once it has braked for the deadtime
+        if (applied[i] != 0 && reverse != drivers[i].reverse) {
+            if (drivers[i].stopped && now - drivers[i].stoppedSince >= directionDeadtime) {
+                drivers[i].reverse = reverse;
+            } else {
+                applied[i] = 0;
+            }
+        }
+
+        // IN2 is only low while the motor is driven forward. A stopped motor brakes, with IN1
+        // held high before IN2 is raised so it is never driven in reverse
+        bool wasForward = drivers[i].speed > 0;
+        if (applied[i] == 0) {
+            if (!drivers[i].stopped) {
+                drivers[i].stopped = true;
+                drivers[i].stoppedSince = now;
+                held |= 1 << i;
+                if (wasForward) {
+                    high |= 1ULL << drivers[i].directionPin;
+                }
+            }
+        } else {
+            drivers[i].stopped = false;
+            if (!reverse && !wasForward) {
+                low |= 1ULL << drivers[i].directionPin;
+            }
+
+            // With IN2 high, IN1 high brakes and IN1 low drives in reverse, so the reverse duty
+            // cycle is the share of the period IN1 is low
+            pwmStage(i, reverse ? maxDutyCycle + applied[i] : applied[i]);
+            driven |= 1 << i;
+        }
+        drivers[i].speed = applied[i];
+    }
+
+    // Stopping motors are held high before the direction pins change, then the driven motors'
+    // duty cycles switch together
+    if (held != 0) {
+        pwmHold(held);
+    }
+    if ((high | low) != 0) {
+        gpioWriteMask(high, low);
+    }
+    pwmCommit(driven);
+
+    return applied;
 }
 
-void MotorHandler::setMotorSpeeds(const std::array<int16_t, 3> &speeds) {
-    //todo speeds is a percentage of max duty cycle like 0 is 0  1 is max - 1 is min etc)
-    uint16_t maxDutyCycle = (1 << resolution) - 1;
+MotorOutput MotorHandler::setMotorCommands(const std::array<float, 3> &commands,
+                                           const std::array<float, 3> &wheelSpeeds) {
+    if (!initialized) {
+        throw std::logic_error("MotorHandler::setMotorCommands - MotorHandler is not initialized");
+    }
+
+    float maxDutyCycle = getMaxSpeed();
+    uint32_t now = clockMicros();
+    float slew = limits.slewRate * std::min(static_cast<float>(now - lastCommandTime) * 1.0e-6f,
+                                            MAX_SLEW_PERIOD);
+    lastCommandTime = now;
+    MotorOutput output = {};
+    std::array<int16_t, 3> speeds = {};
 
     for (size_t i(0); i < speeds.size(); ++i) {
-        // Determine dutyCycle and direction
-        uint16_t dutyCycle = abs(constrain(speeds[i], -maxDutyCycle, maxDutyCycle));
-        uint8_t direction = speeds[i] >= 0 ? LOW : HIGH;
+        // Clip, then slew from the command that was last applied
+        float command = constrain(commands[i], -1.0f, 1.0f);
+        if (limits.slewRate > 0.0f) {
+            float last = removeDeadband(drivers[i].speed / maxDutyCycle, deadbands[i]);
+            command = constrain(command, last - slew, last + slew);
+        }
+        float duty = compensateDeadband(command, deadbands[i]);
+
+        // Keep the driving current within the limit. The bounds always include 0, so a motor
+        // can always brake, but a spinning one is not driven into reverse until it slows
+        float limited = duty;
+        if (limits.currentLimit > 0.0f) {
+            float backEMF = wheelSpeeds[i] / limits.freeSpeed;
+            limited = constrain(duty, std::min(backEMF - limits.currentLimit, 0.0f),
+                                std::max(backEMF + limits.currentLimit, 0.0f));
+        }
+
+        speeds[i] = static_cast<int16_t>(lroundf(limited * maxDutyCycle));
+        output.applied[i] = command;
+        output.saturated[i] = command != commands[i] || limited != duty;
+        if (limited != duty) {
+            output.applied[i] = removeDeadband(limited, deadbands[i]);
+        }
+    }
+
+    // The deadtime may still hold a motor back
+    std::array<int16_t, 3> applied = setMotorSpeeds(speeds);
+    for (size_t i(0); i < applied.size(); ++i) {
+        if (applied[i] != speeds[i]) {
+            output.applied[i] = removeDeadband(applied[i] / maxDutyCycle, deadbands[i]);
+            output.saturated[i] = true;
+        }
+    }
+
+    return output;
+}
+
+void MotorHandler::setDeadbands(const std::array<float, 3> &motorDeadbands) {
+    for (const float &deadband : motorDeadbands) {
+        if (!(deadband >= 0.0f && deadband < 1.0f)) {
+            throw std::logic_error("MotorHandler::setDeadbands - Deadbands must be in [0, 1)");
+        }
+    }
+
+    deadbands = motorDeadbands;
+}
 
-        // Set the pins
-        digitalWrite(drivers[i].directionPin, direction);
-        ledcWrite(i, dutyCycle);
+void MotorHandler::setLimits(const MotorLimits &motorLimits) {
+    if (!(motorLimits.slewRate >= 0.0f && motorLimits.currentLimit >= 0.0f &&
+          motorLimits.freeSpeed > 0.0f)) {
+        throw std::logic_error("MotorHandler::setLimits - Invalid limits");
     }
-}
\ No newline at end of file
+
+    limits = motorLimits;
+}
+
+int16_t MotorHandler::getMaxSpeed() const noexcept {
+    // The speeds are signed, so a 16 bit duty cycle is limited to what an int16_t holds
+    return resolution >= 16 ? INT16_MAX : static_cast<int16_t>((1 << resolution) - 1);
+}
+
+float MotorHandler::compensateDeadband(const float &command, const float &deadband) noexcept {
+    float magnitude = fabsf(command);
+    magnitude = magnitude * (1.0f - deadband) + deadband * std::min(magnitude / DEADBAND_BLEND,
+                                                                    1.0f);
+    return command < 0.0f ? -magnitude : magnitude;
+}
+
+float MotorHandler::removeDeadband(const float &duty, const float &deadband) noexcept {
+    // Below the blend the map is linear with a steeper slope
+    float magnitude = fabsf(duty);
+    float blendDuty = DEADBAND_BLEND * (1.0f - deadband) + deadband;
+    magnitude = magnitude < blendDuty ? magnitude * DEADBAND_BLEND / blendDuty :
+                (magnitude - deadband) / (1.0f - deadband);
+    return duty < 0.0f ? -magnitude : magnitude;
+}
@@ -0,0 +1,67 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "mechanism/velocityEstimator.h"
+
+void VelocityEstimator::reset(const int64_t &count, const uint32_t &timestamp) noexcept {
+    // The starting sample stands in for an edge, so the first edge has a window
+    head = 0;
+    edges = 1;
+    edgeCounts[head] = count;
+    edgeTimes[head] = timestamp;
+    velocity = 0.0f;
+}
+
+float VelocityEstimator::update(const int64_t &count, const uint32_t &timestamp) noexcept {
+    if (edges == 0) {
+        reset(count, timestamp);
+        return velocity;
+    }
+
+    // Only differences are used, so the µs clock wrapping does not matter
+    if (count == edgeCounts[head]) {
+        // No edge: limit the estimate to one count since the last edge
+        uint32_t elapsed = timestamp - edgeTimes[head];
+        if (elapsed > 0) {
+            float bound = 1.0e6f / static_cast<float>(elapsed);
+            velocity = velocity > bound ? bound : (velocity < -bound ? -bound : velocity);
+        }
+        return velocity;
+    }
+
+    if (timestamp == edgeTimes[head]) {
+        return velocity;
+    }
+
+    head = (head + 1) % EDGES;
+    edgeCounts[head] = count;
+    edgeTimes[head] = timestamp;
+    edges = edges < EDGES ? edges + 1 : EDGES;
+
+    // Reach back until the window spans enough counts, or the next edge would make it too long or
+    // was reached turning the other way
+    size_t start = (head + EDGES - 1) % EDGES;
+    bool forward = count > edgeCounts[start];
+    for (size_t i(2); i < edges; ++i) {
+        int64_t spanned = count - edgeCounts[start];
+        if (spanned >= MIN_COUNTS || spanned <= -MIN_COUNTS) {
+            break;
+        }
+
+        size_t previous = (start + EDGES - 1) % EDGES;
+        if (timestamp - edgeTimes[previous] > MAX_WINDOW ||
+            (edgeCounts[start] > edgeCounts[previous]) != forward) {
+            break;
+        }
+        start = previous;
+    }
+
+    velocity = static_cast<float>(count - edgeCounts[start]) * 1.0e6f /
+               static_cast<float>(timestamp - edgeTimes[start]);
+    return velocity;
+}
+
+float VelocityEstimator::getVelocity() const noexcept {
+    return velocity;
+}
@@ -0,0 +1,1552 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+//================================================================================================//
+
+/*
+ * This is the host build of the eyeball mechanism. It runs the same handlers and control
+ * algorithms as the ESP32 on top of the host HAL, so the control math can be exercised and
+ * benchmarked without a board. The simulated clock keeps each run repeatable.
+ *
+ * The program initializes the handlers, then executes the control loop for CONTROL_ITERATIONS
+ * iterations while publishing a synthetic IMU sample before each one, and reports the time taken
+ * per iteration. It then steps the wheels' velocity loops on the plant simulator, first into
+ * saturation and then down to a reachable speed, and reports how well they track and how far the
+ * integrators wound up. It characterizes each motor on the plant as the motor driver hardware test
+ * would, compares the models with the plant's deadband and reruns the step with the gains tuned
+ * from them. Next it closes the whole loop around the plant for SIMULATION_SCENARIOS scenarios,
+ * each starting from a random orientation, and reports how far the eyeball ended from the identity
+ * orientation and how much faster than real time the simulation ran. It then drives the scheduler
+ * from a simulated tick source and checks its timing statistics, stress tests the IMU sample
+ * channel and history with reader threads racing their writer, reads packets out of a mock MPU FIFO
+ * as the server does, round trips random samples through each IMU packet encoding across a sequence
+ * wrap, subscribes with cached GATT handles through a mock BLE client, checks the software
+ * extension of the 16-bit encoder counters across many wraps, feeds the encoder velocity estimator
+ * synthetic counts at high and low speed, through a stop and through reversals, stress tests the
+ * encoder snapshots with reader threads racing the updates and the deferred log's ring buffer with
+ * threads racing its drain, and finally times the control math kernels, the motor outputs and the
+ * deferred logging. The sections are in the following order:
+ *      Logging
+ *      Encoders
+ *      Motors
+ *      Control Loop
+ *      Velocity Loop
+ *      Characterization
+ *      Simulation
+ *      Scheduler
+ *      Sample Channel
+ *      FIFO Reader
+ *      IMU Packets
+ *      GATT Cache
+ *      Counter Extension
+ *      Velocity Estimator
+ *      Snapshot Stress
+ *      Deferred Log
+ *      Benchmarks
+ */
+
+//================================================================================================//
+
+// #include the necessary header files - Do not edit
+#include <Arduino.h>
+#include <ArduinoLog.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+#include "hal/clock.h"
+#include "hal/counterExtension.h"
+#include "hal/quadratureCounter.h"
+#include "hal/tickTimer.h"
+#include "hal/native/hostHAL.h"
+#include "logging/deferredLog.h"
+#include "mechanism/cachedSubscription.h"
+#include "mechanism/encoderHandler.h"
+#include "mechanism/gattCache.h"
+#include "mechanism/motorCharacterizer.h"
+#include "mechanism/motorHandler.h"
+#include "mechanism/sampleChannel.h"
+#include "mechanism/sampleHistory.h"
+#include "mechanism/velocityEstimator.h"
+#include "protocol/imuPacket.h"
+#include "control/factory.h"
+#include "control/scheduler.h"
+#include "control/velocityController.h"
+#include "benchmarks/controlBenchmarks.h"
+#include "benchmarks/logBenchmarks.h"
+#include "benchmarks/motorBenchmarks.h"
+#include "benchmarks/quatMathBenchmarks.h"
+#include "server/fifoReader.h"
+#include "simulation/plantSimulator.h"
+
+/*
+ * Logging
+ *
+ * This section determines the level of logging within the program. The messages are written to
+ * stdout. See mechanism/main.cpp for the available levels.
+ */
+
+// Configuration Variables
+constexpr uint8_t LOG_LEVEL = LOG_LEVEL_NOTICE; // The level of messages to show
+
+/*
+ * Encoders
+ *
+ * The host counters are not tied to pins, but the pins are still validated
+ */
+
+// Program Variables
+constexpr std::array<std::array<uint8_t, 2>, 3> encoderPins = {0, 1, 2, 3, 4, 5};
+
+/*
+ * Motors
+ *
+ * The host PWM channels record the duty cycle written to them. A motor brakes for
+ * DIRECTION_DEADTIME before it is reversed. The deadbands match the plant's
+ */
+
+// Configuration Variables
+constexpr uint32_t PWM_FREQUENCY = 20000;   // The frequency of the PWM signal
+constexpr uint8_t PWM_RESOLUTION = 8;   // The resolution of the PWM duty cycle in bits
+constexpr uint32_t DIRECTION_DEADTIME = 500;    // How long a motor brakes before reversing in us
+constexpr std::array<float, 3> MOTOR_DEADBANDS = {0.05f, 0.05f, 0.05f}; // The duty to start moving
+constexpr MotorLimits MOTOR_LIMITS = DEFAULT_MOTOR_LIMITS;  // The slew rate and current limits
+
+// Program Variables
+constexpr std::array<std::array<uint8_t, 2>, 3> motorPins = {6, 7, 8, 9, 10, 11};
+
+/*
+ * Control Loop
+ *
+ * This section sets how many iterations of the control loop are run, the simulated period
+ * between them and the switch input that selects the control algo
+ */
+
+// Configuration Variables
+constexpr uint32_t CONTROL_ITERATIONS = 1000000; // The number of control loop iterations
+constexpr uint32_t CONTROL_PERIOD = 1000;   // The simulated time between iterations in µs
+constexpr float MAX_ANGULAR_SPEED = 3.0f;   // The fastest the setpoint may rotate in rad/s
+constexpr float ATTITUDE_GAIN = 8.0f;   // The angular velocity per rad of error in 1/s
+constexpr VelocityGains VELOCITY_GAINS = DEFAULT_VELOCITY_GAINS; // The wheels' velocity loops
+constexpr std::array<uint8_t, 3> CONTROL_SWITCHES = {0, 0, 0};  // The algo to run (Sentient)
+
+// Program Variables
+constexpr std::array<uint8_t, 3> restartSwitches = {1, 0, 0};   // Briefly selected to restart it
+
+/*
+ * Velocity Loop
+ *
+ * This section configures the step test of the wheels' velocity loops. The eyeball is first
+ * spun about VELOCITY_AXIS at VELOCITY_OVERDRIVE, which the motors cannot reach, so the drivers
+ * saturate. After VELOCITY_STEP_TIME it is commanded to VELOCITY_TARGET. With working anti-windup
+ * the wheels slow straight down to the new speed instead of running on while the integrators
+ * unwind
+ */
+
+// Configuration Variables
+constexpr Vec3 VELOCITY_AXIS = {0.6f, 0.0f, 0.8f};  // The axis to spin about (unit length)
+constexpr float VELOCITY_OVERDRIVE = 40.0f; // The unreachable speed of the first step in rad/s
+constexpr float VELOCITY_TARGET = 4.0f; // The speed of the second step in rad/s
+constexpr uint32_t VELOCITY_STEP_TIME = 1000;   // The duration of each step in ms
+constexpr float VELOCITY_TOLERANCE = 0.5f;  // The wheel speed error counted as settled in rad/s
+
+/*
+ * Characterization
+ *
+ * This section configures the characterization of the motors on the plant, with the wheels on
+ * the eyeball. It runs the same MotorCharacterizer as hardwareTests/motorDrivers.cpp, and gives
+ * up after CHARACTERIZATION_TIMEOUT of simulated time
+ */
+
+// Configuration Variables
+constexpr CharacterizationSettings CHARACTERIZATION = DEFAULT_CHARACTERIZATION;
+constexpr uint32_t CHARACTERIZATION_TIMEOUT = 120000;   // The longest to characterize for in ms
+
+/*
+ * Simulation
+ *
+ * This section configures the closed-loop runs against the plant simulator. Each scenario
+ * simulates SIMULATION_TIME of the eyeball with the physical properties in PLANT. The seed makes
+ * the scenarios repeatable
+ */
+
+// Configuration Variables
+constexpr uint32_t SIMULATION_SCENARIOS = 100;  // The number of scenarios to simulate
+constexpr uint32_t SIMULATION_TIME = 5000;  // The simulated duration of each scenario in ms
+constexpr PlantParameters PLANT = DEFAULT_PLANT;    // The physical properties of the eyeball
+constexpr uint32_t SIMULATION_SEED = 1; // The seed for the scenarios
+
+// Program Variables
+constexpr std::array<SimulatedMotor, 3> simulatedMotors = {{{motorPins[0][0], 0, 0},
+                                                            {motorPins[1][0], 1, 1},
+                                                            {motorPins[2][0], 2, 2}}};
+
+/*
+ * Scheduler
+ *
+ * This section configures the check of the scheduler's timing statistics. The scheduler runs at
+ * SCHEDULER_RATE from the host's tick timer. Each of schedulerTicks is raised its interval after
+ * the previous one (standing for as many ticks as it says, so more than 1 means some were missed)
+ * and its callback runs for its execution time. The ticks are on time, late, early, missed,
+ * overrun and late behind the overrun, and the statistics must come out as schedulerExpected
+ */
+
+// Configuration Variables
+constexpr uint32_t SCHEDULER_RATE = 1000;   // The rate of the scheduler in Hz
+constexpr uint8_t SCHEDULER_TIMER = 0;  // The tick timer to use
+
+// Program Variables
+// Each tick is {its interval in µs, the ticks it stands for, its callback's execution time in µs}
+constexpr std::array<std::array<uint32_t, 3>, 7> schedulerTicks = {{{0, 1, 100}, {1000, 1, 100},
+                                                                    {1150, 1, 100}, {850, 1, 100},
+                                                                    {3000, 3, 100},
+                                                                    {1000, 1, 1200},
+                                                                    {1200, 1, 100}}};
+constexpr SchedulerStatistics schedulerExpected = {7, 3, 200, 1200, 100};
+uint32_t schedulerExecution = 0;    // How long the scheduler's callback runs for in µs
+
+/*
+ * Sample Channel
+ *
+ * This section configures the concurrency test of the IMU sample channel and history (the
+ * ClientHandler's seqlocks). SAMPLE_READERS threads read the channel's latest sample and the
+ * history's newest samples as fast as they can while the main thread writes SAMPLE_WRITES samples.
+ * Every field of a sample is derived from its sequence number, so a read that mixes two samples is
+ * detected. The history is kept short so the writer laps its readers often
+ */
+
+// Configuration Variables
+constexpr uint8_t SAMPLE_READERS = 3;   // The number of reader threads
+constexpr uint32_t SAMPLE_WRITES = 4000000; // The samples to race them against (below 2^22)
+constexpr size_t SAMPLE_HISTORY_SIZE = 4;   // The capacity of the history under test
+
+/*
+ * FIFO Reader
+ *
+ * This section configures the check of the server's FIFOReader against a mock MPU FIFO. Packets
+ * of FIFO_PACKET_SIZE bytes, each filled from its own number, are written to the mock FIFO, which
+ * overflows like the MPU's. The reader must hand over several packets per read oldest first, and
+ * reset the FIFO when it holds a partial packet or has overflowed, reading every packet after
+ * that intact again
+ */
+
+// Configuration Variables
+constexpr uint16_t FIFO_PACKET_SIZE = 42;   // The size of a DMP packet in bytes (MotionApps 2.0)
+
+/*
+ * IMU Packets
+ *
+ * This section configures the round trip of IMU samples through the packet format. For each
+ * encoding, IMU_PACKET_SAMPLES random unit quaternions are packed into notifications sized for
+ * IMU_PACKET_MTU and unpacked again. The sequence numbers and timestamps start just below their
+ * wrap, a sample is dropped every IMU_PACKET_GAP samples so packets are cut short, and every
+ * decoded sample must match the one sent to within its encoding's documented error, both in each
+ * component and in the rotation between them
+ */
+
+// Configuration Variables
+constexpr uint32_t IMU_PACKET_SAMPLES = 100000; // The number of samples per encoding
+constexpr uint16_t IMU_PACKET_MTU = 247;    // The ATT MTU to size the packets for
+constexpr uint32_t IMU_PACKET_GAP = 1000;   // The samples between dropped samples
+constexpr uint32_t IMU_PACKET_PERIOD = 5000;    // The longest time between samples in µs
+constexpr uint32_t IMU_PACKET_SEED = 1; // The seed for the samples
+
+// Program Variables
+constexpr std::array<IMUEncoding, 3> imuEncodings = {IMUEncoding::Float32, IMUEncoding::Q14,
+                                                     IMUEncoding::SmallestThree};
+constexpr std::array<float, 3> imuEncodingErrors = {0.0f, 3.1e-5f, 6.5e-5f};    // Per component
+constexpr std::array<float, 3> imuEncodingRotations = {0.0f, 1.3e-4f, 1.5e-4f}; // In rad
+constexpr uint32_t imuPacketStart = UINT32_MAX - IMU_PACKET_SAMPLES / 2;    // Wraps halfway
+
+/*
+ * GATT Cache
+ *
+ * This section configures the check of the client's cached subscription against a mock
+ * NimBLEClient. The mock server notifies every GATT_NOTIFY_PERIOD once its IMU CCCD is written.
+ * The client first discovers the server's handles, then reconnects with the cached handles. The
+ * server then moves its attributes to the second of gattTables, so the cached writes land on
+ * other attributes, are accepted and start no notifications. The cached handles must be dropped
+ * after GATT_TIMEOUT and the client must fall back to discovery. A rejected write must also drop
+ * them, and they must persist across a restart in the host's Preferences
+ */
+
+// Configuration Variables
+constexpr uint32_t GATT_TIMEOUT = 1000; // The wait for a notification on cached handles in ms
+constexpr uint32_t GATT_NOTIFY_PERIOD = 10; // The time between the server's notifications in ms
+
+// Program Variables
+constexpr uint64_t gattAddress = 0xA4CF12345678ULL;
+constexpr std::array<GATTHandles, 2> gattTables = {{{42, 43}, {46, 47}}};   // {IMU value, CCCD}
+
+/*
+ * Counter Extension
+ *
+ * This section configures the check of the encoder counters' software extension. A spare counter
+ * unit is moved by COUNTER_SAMPLES random steps of up to COUNTER_MAX_STEP counts, biased forward
+ * so the count passes the 32-bit range, wrapping its simulated 16-bit counter many times. It is
+ * read after each step, and every read must equal the sum of the steps
+ */
+
+// Configuration Variables
+constexpr uint8_t COUNTER_TEST_UNIT = 3;    // The counter unit to test (not one of the encoders)
+constexpr uint32_t COUNTER_SAMPLES = 1000000;   // The number of steps to read
+
+/*
+ * Velocity Estimator
+ *
+ * This section configures the check of the encoders' velocity estimator. It is fed the counts of
+ * a wheel sampled every ESTIMATOR_PERIOD that turns at one speed for ESTIMATOR_STEP and then at
+ * another, with the clock wrapping at the change:
+ *      At ESTIMATOR_HIGH_SPEED every estimate must be within a count per period of the speed
+ *      At ESTIMATOR_LOW_SPEED and then 5 times faster, every estimate made once the window can
+ *      span only one speed must be within ESTIMATOR_TOLERANCE of it, which holds only if the
+ *      window stays within ESTIMATOR_WINDOW (the estimator's MAX_WINDOW)
+ *      Once a wheel turning at ESTIMATOR_LOW_SPEED stops, the estimate must never grow, nor exceed
+ *      one count over the time since the last edge
+ *      A wheel reversing at ESTIMATOR_HIGH_SPEED must be estimated turning the other way in the
+ *      next period, and one reversing at ESTIMATOR_LOW_SPEED from the first edge after the
+ *      reversal, within ESTIMATOR_TOLERANCE once the window has moved past it
+ */
+
+// Configuration Variables
+constexpr uint32_t ESTIMATOR_PERIOD = 1000; // The time between samples in µs
+constexpr uint32_t ESTIMATOR_STEP = 200000; // How long the wheel turns at the first speed in µs
+constexpr uint32_t ESTIMATOR_WINDOW = 20000;    // The estimator's longest window in µs
+constexpr float ESTIMATOR_HIGH_SPEED = 37300.0f;    // A speed spanning over 16 counts a period
+constexpr float ESTIMATOR_LOW_SPEED = 130.0f;   // A speed with an edge every 7 or 8 periods
+constexpr float ESTIMATOR_TOLERANCE = 0.1f; // The largest error of a low speed estimate
+
+/*
+ * Snapshot Stress
+ *
+ * This section configures the concurrency test of the encoder snapshots. SNAPSHOT_READERS threads
+ * read snapshots as fast as they can while the main thread runs SNAPSHOT_UPDATES updates. Every
+ * update moves each count by its own step, chosen to change both halves of the 64 bit count, so
+ * a snapshot mixing two updates (or two halves of a count) is detected. The steps are too large
+ * for the 16-bit counters to follow, so the counts are written directly
+ */
+
+// Configuration Variables
+constexpr uint8_t SNAPSHOT_READERS = 3; // The number of reader threads (at most 4)
+constexpr uint32_t SNAPSHOT_UPDATES = 1000000;  // The number of updates to race them against
+
+// Program Variables
+constexpr std::array<int64_t, 3> snapshotSteps = {1, 0x100000001LL, -0x300000007LL};
+
+/*
+ * Deferred Log
+ *
+ * This section configures the concurrency test of the deferred log's ring buffer. LOG_PRODUCERS
+ * threads each defer LOG_MESSAGES numbered messages in bursts of LOG_BURST, pausing for
+ * LOG_PAUSE between bursts, while the main thread takes them out. The producers' bursts together
+ * fit in the ring, so the drain keeps up and more than half the messages must come out. Every
+ * message taken out must be intact, each producer's must come out in order, and every message
+ * must be either taken out or counted as dropped
+ */
+
+// Configuration Variables
+constexpr uint8_t LOG_PRODUCERS = 3;    // The number of producer threads
+constexpr uint32_t LOG_MESSAGES = 100000;   // The number of messages each producer defers
+constexpr uint32_t LOG_BURST = 32;  // The messages a producer defers without pausing
+constexpr uint32_t LOG_PAUSE = 20;  // The pause between a producer's bursts in µs
+static_assert(LOG_PRODUCERS * LOG_BURST < LOG_RING_SIZE, "The bursts must fit in the ring");
+
+// Program Variables
+static const char *LOG_STRESS_FORMAT = "Producer %u Message %u (%x)";   // The message deferred
+
+/*
+ * Benchmarks
+ *
+ * This section sets how many times each control math kernel, motor output and logging call is
+ * called when it is timed
+ */
+
+// Configuration Variables
+constexpr uint32_t BENCHMARK_ITERATIONS = 1000000;  // The number of calls to time per kernel
+
+//================================================================================================//
+
+/**
+ * A mock of the MPU6050's FIFO for the FIFOReader. Bytes written past its size are lost and set
+ * the overflow bit of the interrupt status, which clears when it is read, as on the MPU
+ */
+class MockMPU {
+public:
+    /**
+     * Write bytes to the FIFO, as the DMP would
+     *
+     * @param data - The bytes
+     * @param length - The number of bytes
+     */
+    void write(const uint8_t *data, const size_t &length) {
+        for (size_t i(0); i < length; ++i) {
+            if (fifo.size() >= FIFOReader<MockMPU>::FIFO_SIZE) {
+                status |= 1 << FIFOReader<MockMPU>::OVERFLOW_BIT;
+                return;
+            }
+            fifo.push_back(data[i]);
+        }
+    }
+
+    // The device interface the FIFOReader reads through
+    uint8_t getIntStatus() {
+        uint8_t value = status;
+        status = 0;
+        return value;
+    }
+
+    uint16_t getFIFOCount() {
+        return static_cast<uint16_t>(fifo.size());
+    }
+
+    void getFIFOBytes(uint8_t *data, uint8_t length) {
+        for (uint8_t i(0); i < length && !fifo.empty(); ++i) {
+            data[i] = fifo.front();
+            fifo.pop_front();
+        }
+    }
+
+    void resetFIFO() {
+        fifo.clear();
+    }
+
+private:
+    std::deque<uint8_t> fifo;   // The bytes in the FIFO, oldest first
+    uint8_t status = 0; // The interrupt status
+};
+
+/**
+ * Get the host's time for timing benchmarks (the simulated clock does not move while they run)
+ *
+ * @return The time in ns (wraps every ~4.3 s)
+ */
+uint32_t hostNanoseconds() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/**
+ * Build a synthetic IMU sample that slowly rotates the eyeball about the z axis
+ *
+ * @param iteration - The control loop iteration
+ * @return The sample
+ */
+IMUSample syntheticSample(const uint32_t &iteration) {
+    float angle = static_cast<float>(iteration % 6283) / 1000.0f;
+    IMUSample sample = {};
+    sample.quaternion = Quaternion(cosf(angle / 2.0f), 0.0f, 0.0f, sinf(angle / 2.0f));
+    sample.sequence = iteration;
+    sample.timestamp = micros();
+    sample.deviceTimestamp = sample.timestamp;
+    return sample;
+}
+
+/**
+ * Get the wheel speeds the plant is turning at
+ *
+ * @param plant - The plant
+ * @return The speed of each wheel in rad/s
+ */
+Vec3 plantWheelSpeeds(const PlantSimulator &plant) {
+    std::array<double, 3> velocity = plant.getAngularVelocity();
+    return DEFAULT_KINEMATICS.inverse({static_cast<float>(velocity[0]),
+                                       static_cast<float>(velocity[1]),
+                                       static_cast<float>(velocity[2])});
+}
+
+/**
+ * Step the wheels' velocity loops on the plant, as ControlAlgoImpl::PID() drives them, and log
+ * how long the wheels took to settle after leaving saturation, how far they then overshot and
+ * their error once settled
+ *
+ * @param plant - The plant, at rest
+ * @param gains - The velocity loops' gains
+ */
+void stepVelocityLoop(PlantSimulator &plant, const VelocityGains &gains) {
+    std::array<VelocityController, 3> controllers;
+    float period = static_cast<float>(CONTROL_PERIOD) * 1.0e-6f;
+    uint32_t ticks = VELOCITY_STEP_TIME * 1000 / CONTROL_PERIOD;
+    uint32_t saturatedTicks = 0;
+    uint32_t settledTick = ticks;
+    std::array<bool, 3> crossed = {};
+    float overshoot = 0.0f;
+    float settledError = 0.0f;
+
+    for (uint32_t i(0); i < 2 * ticks; ++i) {
+        float speed = i < ticks ? VELOCITY_OVERDRIVE : VELOCITY_TARGET;
+        Vec3 target = DEFAULT_KINEMATICS.inverse(vecScale(VELOCITY_AXIS, speed));
+        float targets[3] = {target.x, target.y, target.z};
+
+        EncoderHandler::instance()->update();
+        const EncoderState &encoders = EncoderHandler::instance()->getState();
+        std::array<float, 3> measured = {};
+        std::array<float, 3> duties = {};
+        for (size_t j(0); j < duties.size(); ++j) {
+            measured[j] = encoders.velocities[j] * DEFAULT_KINEMATICS.getRadiansPerCount();
+            duties[j] = controllers[j].update(targets[j], measured[j], period, gains);
+        }
+
+        MotorOutput output = MotorHandler::instance()->setMotorCommands(duties, measured);
+        for (size_t j(0); j < duties.size(); ++j) {
+            if (output.saturated[j]) {
+                controllers[j].saturate(output.applied[j]);
+                ++saturatedTicks;
+            }
+        }
+
+        plant.advance(CONTROL_PERIOD);
+
+        // Measure against the plant's true speed, free of the encoders' quantization
+        Vec3 actual = plantWheelSpeeds(plant);
+        float errors[3] = {actual.x - target.x, actual.y - target.y, actual.z - target.z};
+        for (size_t j(0); j < duties.size(); ++j) {
+            if (i < ticks) {
+                continue;
+            }
+
+            // The wheels slow down toward the target, so an overshoot is an error below it
+            float below = targets[j] < 0.0f ? errors[j] : -errors[j];
+            crossed[j] = crossed[j] || below >= 0.0f;
+            if (crossed[j]) {
+                overshoot = std::max(overshoot, below);
+            }
+
+            if (fabsf(errors[j]) > VELOCITY_TOLERANCE) {
+                settledTick = i + 1;
+            }
+            if (i >= 2 * ticks - ticks / 5) {
+                settledError = std::max(settledError, fabsf(errors[j]));
+            }
+        }
+    }
+
+    MotorHandler::instance()->setMotorSpeeds({0, 0, 0});
+    Log.noticeln("Velocity loop - Saturated: %u ticks Settling Time: %u ms Overshoot: %F rad/s "
+                 "Settled Error: %F rad/s", saturatedTicks,
+                 (settledTick - ticks) * CONTROL_PERIOD / 1000, overshoot, settledError);
+}
+
+/**
+ * Characterize the motors on the plant, one control tick at a time, and log how the measured
+ * deadbands compare with the plant's
+ *
+ * @param plant - The plant, at rest
+ * @param characterizer - The characterizer to run
+ * @return True if every motor was characterized in time
+ */
+bool characterizeMotors(PlantSimulator &plant, MotorCharacterizer &characterizer) {
+    uint32_t ticks = 0;
+    characterizer.start(clockMicros());
+
+    do {
+        if (++ticks > CHARACTERIZATION_TIMEOUT * 1000 / CONTROL_PERIOD) {
+            Log.errorln("Characterization - Timed out");
+            return false;
+        }
+
+        EncoderHandler::instance()->update();
+        plant.advance(CONTROL_PERIOD);
+    } while (characterizer.update(clockMicros()));
+    DeferredLog::instance()->drain();
+
+    float worstDeadbandError = 0.0f;
+    for (const auto &model : characterizer.getModels()) {
+        float error = fabsf(model.deadband - static_cast<float>(PLANT.deadband));
+        worstDeadbandError = std::max(worstDeadbandError, error);
+    }
+
+    Log.noticeln("Characterization - Time: %u ms Succeeded: %T Worst Deadband Error: %F",
+                 ticks * CONTROL_PERIOD / 1000, characterizer.succeeded(), worstDeadbandError);
+    return characterizer.succeeded();
+}
+
+/**
+ * The scheduler's callback. Takes schedulerExecution of simulated time
+ */
+void simulatedControlLoop() {
+    hostClockAdvance(schedulerExecution);
+}
+
+/**
+ * Drive the scheduler through schedulerTicks from the tick timer, as its loop would, and check its
+ * statistics
+ *
+ * @return True if the statistics were as expected
+ */
+bool checkScheduler() {
+    Scheduler *scheduler = Scheduler::instance();
+    scheduler->initialize(SCHEDULER_RATE, SCHEDULER_TIMER, simulatedControlLoop);
+    if (!tickTimerStart(SCHEDULER_TIMER, scheduler->getPeriod())) {
+        Log.errorln("Scheduler - Failed to start the tick timer");
+        return false;
+    }
+
+    // Each interval is from the start of the previous tick, which its callback has moved on from
+    uint32_t lastExecution = 0;
+    for (const auto &tick : schedulerTicks) {
+        hostClockAdvance(tick[0] - lastExecution);
+        hostTickRaise(tick[1]);
+        schedulerExecution = tick[2];
+        lastExecution = tick[2];
+        scheduler->tick(clockMicros(), tickTimerWait());
+    }
+    tickTimerStop();
+    DeferredLog::instance()->drain();
+
+    SchedulerStatistics statistics = scheduler->getStatistics();
+    Log.noticeln("Scheduler - Ticks: %u Misses: %u Worst Jitter: %u us Worst Execution: %u us",
+                 statistics.ticks, statistics.deadlineMisses, statistics.worstJitter,
+                 statistics.worstExecutionTime);
+    return statistics.ticks == schedulerExpected.ticks &&
+           statistics.deadlineMisses == schedulerExpected.deadlineMisses &&
+           statistics.worstJitter == schedulerExpected.worstJitter &&
+           statistics.worstExecutionTime == schedulerExpected.worstExecutionTime &&
+           statistics.lastExecutionTime == schedulerExpected.lastExecutionTime;
+}
+
+/**
+ * Build the sample written n-th in the sample channel stress test. Every field is derived from n
+ * (exactly, as n < 2^22)
+ *
+ * @param n - The sample's sequence number
+ * @return The sample
+ */
+IMUSample stressSample(const uint32_t &n) {
+    float value = static_cast<float>(n);
+    IMUSample sample = {};
+    sample.quaternion = Quaternion(value, -value, value + 0.5f, value * 2.0f);
+    sample.timestamp = n * 7 + 1;
+    sample.sequence = n;
+    sample.deviceTimestamp = ~n;
+    return sample;
+}
+
+/**
+ * Check that a sample from the sample channel stress test is whole, with every field from the same
+ * write
+ *
+ * @param sample - The sample
+ * @return True if the sample is whole
+ */
+bool wholeSample(const IMUSample &sample) {
+    IMUSample expected = stressSample(sample.sequence);
+    return sample.quaternion.w == expected.quaternion.w &&
+           sample.quaternion.x == expected.quaternion.x &&
+           sample.quaternion.y == expected.quaternion.y &&
+           sample.quaternion.z == expected.quaternion.z &&
+           sample.timestamp == expected.timestamp &&
+           sample.deviceTimestamp == expected.deviceTimestamp;
+}
+
+/**
+ * Race reader threads against the writer of a sample channel and history, checking that no read
+ * is torn, that each reader's latest samples never go backwards and that the history's samples
+ * come out newest first without gaps
+ *
+ * @return True if no read was torn or out of order
+ */
+bool stressSampleChannel() {
+    static SampleChannel<IMUSample> channel;
+    static SampleHistory<IMUSample, SAMPLE_HISTORY_SIZE> history;
+    channel.write(stressSample(0));
+    history.push(stressSample(0));
+
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> torn(0);
+    std::atomic<uint32_t> disordered(0);
+    std::atomic<uint64_t> reads(0);
+    std::vector<std::thread> threads;
+
+    for (uint8_t i(0); i < SAMPLE_READERS; ++i) {
+        threads.emplace_back([&]() {
+            uint32_t lastSequence = 0;
+            uint64_t count = 0;
+            std::array<IMUSample, SAMPLE_HISTORY_SIZE> samples;
+
+            while (!done.load(std::memory_order_relaxed)) {
+                IMUSample latest = channel.read();
+                if (!wholeSample(latest)) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                } else if (latest.sequence < lastSequence) {
+                    disordered.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    lastSequence = latest.sequence;
+                }
+
+                size_t copied = history.lastN(samples.data(), samples.size());
+                for (size_t j(0); j < copied; ++j) {
+                    if (!wholeSample(samples[j])) {
+                        torn.fetch_add(1, std::memory_order_relaxed);
+                    } else if (j > 0 && samples[j].sequence + 1 != samples[j - 1].sequence) {
+                        disordered.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                count += 1 + copied;
+            }
+
+            reads.fetch_add(count);
+        });
+    }
+
+    for (uint32_t i(1); i <= SAMPLE_WRITES; ++i) {
+        channel.write(stressSample(i));
+        history.push(stressSample(i));
+    }
+
+    done = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    Log.noticeln("Sample channel - Readers: %u Writes: %u Reads: %u Torn: %u Out of Order: %u",
+                 SAMPLE_READERS, SAMPLE_WRITES, static_cast<uint32_t>(reads.load()), torn.load(),
+                 disordered.load());
+    return torn.load() == 0 && disordered.load() == 0;
+}
+
+/**
+ * A mock of the NimBLEClient for the CachedSubscription, connected to a mock server. Writing the
+ * server's IMU CCCD starts its notifications. A write to any other handle is accepted without
+ * effect, as a server does for a writable attribute
+ */
+class MockClient {
+public:
+    /**
+     * Primary constructor
+     *
+     * @param table - The handles of the server's attributes
+     */
+    explicit MockClient(const GATTHandles &table) : table(table) {}
+
+    /**
+     * Connect to the server again. Its notifications start off
+     */
+    void reconnect() {
+        notifying = false;
+    }
+
+    /**
+     * Move the server's attributes, as a firmware update would
+     *
+     * @param handles - The new handles of the server's attributes
+     */
+    void setTable(const GATTHandles &handles) {
+        table = handles;
+        notifying = false;
+    }
+
+    /**
+     * Discover the server's handles and subscribe to the IMU characteristic, as subscribeToIMU
+     * does
+     *
+     * @return The server's handles
+     */
+    GATTHandles discover() {
+        notifying = true;
+        return table;
+    }
+
+    /**
+     * Write to an attribute of the server
+     *
+     * @param handle - The attribute's handle
+     * @param data - The bytes
+     * @param length - The number of bytes
+     * @return True as the server accepts the write
+     */
+    bool write(const uint16_t &handle, const uint8_t *data, const uint16_t &length) {
+        if (handle == table.IMUCCCD && length == 2) {
+            notifying = (data[0] & 0x01) != 0;
+        }
+
+        return true;
+    }
+
+    /**
+     * Check if the server is sending notifications
+     *
+     * @return True if notifying
+     */
+    bool isNotifying() const {
+        return notifying;
+    }
+
+private:
+    GATTHandles table;  // The handles of the server's attributes
+    bool notifying = false; // If the server is sending IMU notifications
+};
+
+/**
+ * The raw write the CachedSubscription sends its writes through
+ */
+bool writeHandle(MockClient &client, const uint16_t &handle, const uint8_t *data,
+                 const uint16_t &length) {
+    return client.write(handle, data, length);
+}
+
+/**
+ * Write numbered packets to a mock MPU FIFO
+ *
+ * @param mpu - The mock MPU
+ * @param first - The number of the first packet
+ * @param count - The number of packets to write
+ * @return The number of the packet after the last one written
+ */
+uint8_t writePackets(MockMPU &mpu, uint8_t first, const size_t &count) {
+    std::array<uint8_t, FIFO_PACKET_SIZE> packet;
+    for (size_t i(0); i < count; ++i, ++first) {
+        packet.fill(first);
+        mpu.write(packet.data(), packet.size());
+    }
+
+    return first;
+}
+
+/**
+ * Read the packets out of a mock MPU FIFO, checking they are intact, numbered from an expected
+ * packet and handed over oldest first with the right number still to be read
+ *
+ * @param reader - The reader
+ * @param expected - The number of the first packet expected, advanced past those read
+ * @param packets - Set to the number of packets read
+ * @return True if every packet read was as expected
+ */
+bool readPackets(FIFOReader<MockMPU> &reader, uint8_t &expected, size_t &packets) {
+    std::array<uint8_t, FIFO_PACKET_SIZE> buffer;
+    std::vector<size_t> remaining;
+    bool intact = true;
+
+    packets = reader.drain(buffer.data(), [&](uint8_t *packet, size_t left) {
+        for (size_t i(0); i < FIFO_PACKET_SIZE; ++i) {
+            intact = intact && packet[i] == expected;
+        }
+        remaining.push_back(left);
+        ++expected;
+    });
+
+    // The packets still to be read count down to 0
+    for (size_t i(0); i < remaining.size(); ++i) {
+        intact = intact && remaining[i] == remaining.size() - 1 - i;
+    }
+
+    return intact && remaining.size() == packets;
+}
+
+/**
+ * Run the FIFOReader against a mock MPU through several packets per read, an empty FIFO, a
+ * partial packet and an overflow
+ *
+ * @return True if the reader behaved as expected throughout
+ */
+bool checkFIFOReader() {
+    MockMPU mpu;
+    FIFOReader<MockMPU> reader(mpu, FIFO_PACKET_SIZE);
+    uint8_t written = 0;
+    uint8_t expected = 0;
+    size_t packets = 0;
+    bool passed = true;
+
+    // Several packets in one read, then an empty FIFO
+    written = writePackets(mpu, written, 3);
+    passed = passed && readPackets(reader, expected, packets) && packets == 3;
+    passed = passed && readPackets(reader, expected, packets) && packets == 0;
+    bool multiple = passed;
+
+    // A partial packet cannot be aligned, so the FIFO is reset and reading starts again after it
+    written = writePackets(mpu, written, 1);
+    std::array<uint8_t, FIFO_PACKET_SIZE / 2> half;
+    half.fill(0xFF);
+    mpu.write(half.data(), half.size());
+    passed = passed && readPackets(reader, expected, packets) && packets == 0;
+    passed = passed && reader.getResets() == 1 && mpu.getFIFOCount() == 0;
+    expected = written;
+    written = writePackets(mpu, written, 2);
+    passed = passed && readPackets(reader, expected, packets) && packets == 2;
+    bool partial = passed;
+
+    // Overflowing loses data, so the FIFO is reset and reading starts again after it
+    written = writePackets(mpu, written, FIFOReader<MockMPU>::FIFO_SIZE / FIFO_PACKET_SIZE + 2);
+    passed = passed && readPackets(reader, expected, packets) && packets == 0;
+    passed = passed && reader.getResets() == 2 && mpu.getFIFOCount() == 0;
+    expected = written;
+    written = writePackets(mpu, written, 4);
+    passed = passed && readPackets(reader, expected, packets) && packets == 4;
+    passed = passed && expected == written;
+    bool overflow = passed;
+
+    Log.noticeln("FIFO reader - Multiple Packets: %T Partial Packet: %T Overflow: %T Resets: %u",
+                 multiple, partial, overflow, reader.getResets());
+    return passed;
+}
+
+/**
+ * Check a decoded IMU sample against the one sent. q and -q are the same rotation, so the
+ * quaternion may come back negated
+ *
+ * @param sent - The sample sent
+ * @param received - The sample decoded
+ * @param error - The largest error allowed in each component of the quaternion
+ * @param rotation - Set to the angle of the rotation between the quaternions in rad
+ * @return True if the samples match
+ */
+bool matchesSample(const IMUPacketSample &sent, const IMUPacketSample &received,
+                   const float &error, float &rotation) {
+    const Quaternion &q = sent.quaternion;
+    const Quaternion &r = received.quaternion;
+    float sign = q.w * r.w + q.x * r.x + q.y * r.y + q.z * r.z < 0.0f ? -1.0f : 1.0f;
+    std::array<float, 4> difference = {sign * q.w - r.w, sign * q.x - r.x, sign * q.y - r.y,
+                                       sign * q.z - r.z};
+
+    // The angle from the chord between the quaternions, as acos of their dot product loses the
+    // small angles to rounding
+    float chord = 0.0f;
+    bool within = true;
+    for (const float &d : difference) {
+        chord += d * d;
+        within = within && fabsf(d) <= error;
+    }
+    rotation = 4.0f * asinf(std::min(sqrtf(chord) / 2.0f, 1.0f));
+
+    return sent.sequence == received.sequence && sent.timestamp == received.timestamp && within;
+}
+
+/**
+ * Round trip random samples through the IMU packet encoder and decoder in each encoding, across
+ * a wrap of the sequence numbers and timestamps
+ *
+ * @return True if every sample came back as sent
+ */
+bool checkIMUPackets() {
+    std::mt19937 generator(IMU_PACKET_SEED);
+    std::normal_distribution<float> component(0.0f, 1.0f);
+    std::uniform_int_distribution<uint32_t> period(1, IMU_PACKET_PERIOD);
+    uint32_t packets = 0;
+    uint32_t mismatches = 0;
+    std::array<float, 3> worstRotations = {};
+    bool wrapped = false;
+
+    for (size_t i(0); i < imuEncodings.size(); ++i) {
+        IMUEncoding encoding = imuEncodings[i];
+        IMUPacketEncoder encoder(encoding, IMUPacketEncoder::samplesForMTU(IMU_PACKET_MTU,
+                                                                            encoding));
+        std::vector<IMUPacketSample> sent;
+        size_t received = 0;
+
+        // Decode the packet and check its samples against those waiting to be received
+        auto send = [&]() {
+            IMUPacketDecoder decoder(encoder.data(), encoder.size());
+            IMUPacketSample sample = {};
+            size_t first = received;
+            float rotation = 0.0f;
+            while (decoder.next(sample)) {
+                if (received >= sent.size() || !matchesSample(sent[received], sample,
+                                                              imuEncodingErrors[i], rotation) ||
+                    rotation > imuEncodingRotations[i]) {
+                    ++mismatches;
+                }
+                worstRotations[i] = std::max(worstRotations[i], rotation);
+                ++received;
+            }
+
+            // A packet whose samples cross the wrap must still be decoded in sequence
+            wrapped = wrapped || (received - first > 1 && sent[first].sequence >
+                                                           sent[received - 1].sequence);
+            mismatches += decoder.isValid() && received - first == decoder.getCount() ? 0 : 1;
+            encoder.clear();
+            ++packets;
+        };
+
+        IMUPacketSample sample = {Quaternion(), imuPacketStart, imuPacketStart};
+        for (uint32_t n(0); n < IMU_PACKET_SAMPLES; ++n) {
+            sample.quaternion = Quaternion(component(generator), component(generator),
+                                           component(generator), component(generator));
+            sample.quaternion.normalize();
+
+            // A sample that is not the next in sequence starts a new packet
+            if (!encoder.add(sample)) {
+                send();
+                encoder.add(sample);
+            }
+            sent.push_back(sample);
+            if (encoder.isFull()) {
+                send();
+            }
+
+            sample.sequence += n % IMU_PACKET_GAP == IMU_PACKET_GAP - 1 ? 2 : 1;
+            sample.timestamp += period(generator);
+        }
+
+        if (!encoder.isEmpty()) {
+            send();
+        }
+        mismatches += received == sent.size() ? 0 : 1;
+    }
+
+    Log.noticeln("IMU packets - Samples: %u Packets: %u Mismatches: %u Wrapped: %T Worst Q14 "
+                 "Rotation: %F rad Worst SmallestThree Rotation: %F rad",
+                 IMU_PACKET_SAMPLES * static_cast<uint32_t>(imuEncodings.size()), packets,
+                 mismatches, wrapped, worstRotations[1], worstRotations[2]);
+    return mismatches == 0 && wrapped;
+}
+
+/**
+ * Subscribe to a mock server with its cached handles and fall back to discovery, as the
+ * ClientHandler does, through a first connection, a reconnection, a change of the server's
+ * handles and a rejected write
+ *
+ * @return True if the cached handles were used and dropped as expected throughout
+ */
+bool checkGATTCache() {
+    GATTCache cache;
+    cache.setPersistent(true);
+    CachedSubscription<MockClient> subscription(cache, GATT_TIMEOUT);
+    MockClient client(gattTables[0]);
+    uint64_t address = GATTCache::addressKey(gattAddress, 0);
+    uint8_t encodingID = static_cast<uint8_t>(IMUEncoding::SmallestThree);
+    uint32_t now = 0;
+    GATTHandles handles = {};
+
+    // Discover the handles and remember them, as subscribeToIMU does
+    auto discover = [&]() {
+        handles = client.discover();
+        cache.store(address, handles);
+    };
+
+    // Connect and subscribe with the cached handles if there are any, or else by discovery
+    auto connect = [&]() {
+        client.reconnect();
+        if (cache.lookup(address, handles) && subscription.subscribe(client, address, handles,
+                                                                     encodingID, now)) {
+            return true;
+        }
+
+        discover();
+        return false;
+    };
+
+    // Run the connection task until the wait for a notification is over, falling back to
+    // discovery if the cached handles time out
+    auto settle = [&]() {
+        bool expired = false;
+        while (subscription.isPending()) {
+            now += GATT_NOTIFY_PERIOD;
+            if (client.isNotifying()) {
+                subscription.notify();
+            }
+            if (subscription.expired(now)) {
+                expired = true;
+                discover();
+            }
+        }
+
+        return expired;
+    };
+
+    // Check the cache holds a table's handles
+    auto cached = [&](const GATTHandles &expected) {
+        GATTHandles stored = {};
+        return cache.lookup(address, stored) && stored.IMUValue == expected.IMUValue &&
+               stored.IMUCCCD == expected.IMUCCCD;
+    };
+
+    // The first connection discovers the handles
+    bool discovered = !connect() && !settle() && client.isNotifying() && cached(gattTables[0]);
+
+    // A reconnection subscribes with them, and the notifications confirm them
+    bool reused = connect() && subscription.remaining(now) == GATT_TIMEOUT && !settle() &&
+                  client.isNotifying() && cached(gattTables[0]);
+
+    // Once the server's handles move, the cached writes go unanswered until they time out
+    client.setTable(gattTables[1]);
+    uint32_t start = now;
+    bool fellBack = connect() && settle() && now - start == GATT_TIMEOUT &&
+                    client.isNotifying() && cached(gattTables[1]);
+    fellBack = fellBack && connect() && !settle() && client.isNotifying();
+
+    // The handles survive a restart
+    GATTCache restored;
+    restored.setPersistent(true);
+    GATTHandles stored = {};
+    bool persisted = restored.lookup(address, stored) && stored.IMUValue == gattTables[1].IMUValue;
+
+    // A rejected write drops them at once
+    bool rejected = connect();
+    subscription.reject();
+    rejected = rejected && !subscription.isPending() && !cache.lookup(address, handles);
+
+    Log.noticeln("GATT cache - Discovered: %T Reused: %T Fell Back: %T Persisted: %T Rejected: %T",
+                 discovered, reused, fellBack, persisted, rejected);
+    return discovered && reused && fellBack && persisted && rejected;
+}
+
+/**
+ * Move a counter unit by random steps and check every read against the sum of the steps
+ *
+ * @return True if every read matched
+ */
+bool checkCounterExtension() {
+    if (!counterAttach(COUNTER_TEST_UNIT, 0, 0)) {
+        Log.errorln("Counter extension - Failed to attach the counter");
+        return false;
+    }
+
+    int64_t expected = 0;
+    uint32_t mismatches = 0;
+    uint32_t state = 1;
+    for (uint32_t i(0); i < COUNTER_SAMPLES; ++i) {
+        state = state * 1664525UL + 1013904223UL;
+        int64_t step = static_cast<int64_t>(state >> 8) % (COUNTER_MAX_STEP * 3 / 2 + 1) -
+                       COUNTER_MAX_STEP / 2;
+
+        hostCounterAdd(COUNTER_TEST_UNIT, step);
+        expected += step;
+        if (counterRead(COUNTER_TEST_UNIT) != expected) {
+            ++mismatches;
+            expected = counterRead(COUNTER_TEST_UNIT);
+        }
+    }
+
+    // The count must have left the 32-bit range, and clearing must zero it without touching the
+    // counter
+    bool extended = expected > INT32_MAX;
+    bool cleared = counterClear(COUNTER_TEST_UNIT) && counterRead(COUNTER_TEST_UNIT) == 0;
+    hostCounterAdd(COUNTER_TEST_UNIT, -5);
+    cleared = cleared && counterRead(COUNTER_TEST_UNIT) == -5;
+
+    Log.noticeln("Counter extension - Samples: %u Mismatches: %u Past 32 bits: %T Cleared: %T",
+                 COUNTER_SAMPLES, mismatches, extended, cleared);
+    return mismatches == 0 && extended && cleared;
+}
+
+/**
+ * A sample of the counts fed to the velocity estimator
+ */
+struct EstimatorSample {
+    uint32_t elapsed;   // The time since the first sample in µs
+    float speed;    // The wheel's true speed in counts/s
+    float estimate; // The estimator's velocity in counts/s
+    bool edge;  // If the count changed since the last sample
+};
+
+/**
+ * Feed a velocity estimator the counts of a wheel that turns at one speed for ESTIMATOR_STEP and
+ * then at another for as long again, sampled every ESTIMATOR_PERIOD. The clock wraps at the change
+ *
+ * @param first - The first speed in counts/s
+ * @param second - The second speed in counts/s
+ * @return Each sample after the first, with the estimate made from it
+ */
+std::vector<EstimatorSample> feedEstimator(const float &first, const float &second) {
+    VelocityEstimator estimator;
+    uint32_t start = -ESTIMATOR_STEP;
+    int64_t last = 0;
+    estimator.reset(last, start);
+
+    // Start a quarter count past an edge so no edge falls exactly on a sample
+    std::vector<EstimatorSample> samples;
+    for (uint32_t elapsed(ESTIMATOR_PERIOD); elapsed <= 2 * ESTIMATOR_STEP;
+         elapsed += ESTIMATOR_PERIOD) {
+        double position = 0.25 + first * 1.0e-6 * std::min(elapsed, ESTIMATOR_STEP);
+        if (elapsed > ESTIMATOR_STEP) {
+            position += second * 1.0e-6 * (elapsed - ESTIMATOR_STEP);
+        }
+
+        int64_t count = static_cast<int64_t>(floor(position));
+        EstimatorSample sample = {};
+        sample.elapsed = elapsed;
+        sample.speed = elapsed > ESTIMATOR_STEP ? second : first;
+        sample.estimate = estimator.update(count, start + elapsed);
+        sample.edge = count != last;
+        samples.push_back(sample);
+        last = count;
+    }
+
+    return samples;
+}
+
+/**
+ * Get the worst relative error of a velocity estimator's low speed estimates. An estimate is made
+ * at an edge and held until the next, so those from edges whose longest window could reach back
+ * past the start or a change of speed are skipped
+ *
+ * @param samples - The samples fed to the estimator
+ * @return The worst error as a fraction of the speed
+ */
+float estimatorError(const std::vector<EstimatorSample> &samples) {
+    float worst = 0.0f;
+    uint32_t changed = 0;
+    uint32_t lastEdge = 0;
+    for (size_t i(0); i < samples.size(); ++i) {
+        if (i > 0 && samples[i].speed != samples[i - 1].speed) {
+            changed = samples[i - 1].elapsed;
+        }
+        if (samples[i].edge) {
+            lastEdge = samples[i].elapsed;
+        }
+
+        if (lastEdge > changed + ESTIMATOR_WINDOW) {
+            worst = std::max(worst, fabsf(samples[i].estimate / samples[i].speed - 1.0f));
+        }
+    }
+
+    return worst;
+}
+
+/**
+ * Feed the velocity estimator synthetic counts, checking its estimate at high speed, at low speed
+ * with a bounded window, as the wheel stops and across reversals
+ *
+ * @return True if every estimate was within its bound
+ */
+bool checkVelocityEstimator() {
+    // At high speed every estimate is the last period's counts
+    float highError = 0.0f;
+    for (const EstimatorSample &sample : feedEstimator(ESTIMATOR_HIGH_SPEED,
+                                                       ESTIMATOR_HIGH_SPEED)) {
+        highError = std::max(highError, fabsf(sample.estimate - sample.speed));
+    }
+    bool high = highError <= 1.0e6f / ESTIMATOR_PERIOD;
+
+    // At low speed the window spans edges, but never reaches back past its longest window
+    float lowError = estimatorError(feedEstimator(ESTIMATOR_LOW_SPEED, 5.0f * ESTIMATOR_LOW_SPEED));
+    bool low = lowError <= ESTIMATOR_TOLERANCE;
+
+    // Once the wheel stops, the estimate only shrinks, bounded by one count since the last edge
+    bool decayed = true;
+    float previous = 0.0f;
+    uint32_t lastEdge = 0;
+    for (const EstimatorSample &sample : feedEstimator(ESTIMATOR_LOW_SPEED, 0.0f)) {
+        if (sample.edge) {
+            lastEdge = sample.elapsed;
+        } else if (sample.speed == 0.0f) {
+            float bound = 1.0e6f / static_cast<float>(sample.elapsed - lastEdge);
+            decayed = decayed && fabsf(sample.estimate) <= std::min(fabsf(previous), bound);
+        }
+        previous = sample.estimate;
+    }
+
+    // A reversal at high speed shows in the next period, at low speed from the first edge
+    std::vector<EstimatorSample> fast = feedEstimator(ESTIMATOR_HIGH_SPEED, -ESTIMATOR_HIGH_SPEED);
+    bool reversed = fast[ESTIMATOR_STEP / ESTIMATOR_PERIOD].estimate < 0.0f;
+    std::vector<EstimatorSample> slow = feedEstimator(ESTIMATOR_LOW_SPEED, -ESTIMATOR_LOW_SPEED);
+    uint32_t edges = 0;
+    for (const EstimatorSample &sample : slow) {
+        edges += sample.speed < 0.0f && sample.edge ? 1 : 0;
+        reversed = reversed && (edges == 0 || sample.estimate < 0.0f);
+    }
+    float reversedError = estimatorError(slow);
+    reversed = reversed && reversedError <= ESTIMATOR_TOLERANCE;
+
+    Log.noticeln("Velocity estimator - High Speed Error: %F counts/s Low Speed Error: %F "
+                 "Decayed: %T Reversed: %T Reversed Error: %F", highError, lowError, decayed,
+                 reversed, reversedError);
+    return high && low && decayed && reversed;
+}
+
+/**
+ * Race reader threads taking encoder snapshots against updates, checking that every snapshot is
+ * of a single update and that each reader's versions never go backwards
+ *
+ * @return True if no reader saw an inconsistent snapshot
+ */
+bool stressSnapshots() {
+    EncoderHandler *encoders = EncoderHandler::instance();
+    encoders->update();
+    EncoderState initial = encoders->getState();
+    std::atomic<bool> done(false);
+    std::atomic<uint32_t> failures(0);
+    std::atomic<uint64_t> reads(0);
+    std::vector<std::thread> threads;
+
+    for (uint8_t i(0); i < SNAPSHOT_READERS; ++i) {
+        uint8_t reader = encoders->addReader();
+        threads.emplace_back([&, reader]() {
+            uint32_t lastVersion = initial.version;
+            uint64_t count = 0;
+
+            while (!done.load(std::memory_order_relaxed)) {
+                EncoderState snapshot = encoders->getSnapshot(reader);
+                uint32_t updates = snapshot.version - initial.version;
+                bool consistent = snapshot.version >= lastVersion;
+
+                for (size_t j(0); j < snapshot.counts.size(); ++j) {
+                    consistent = consistent && snapshot.counts[j] - initial.counts[j] ==
+                                               snapshotSteps[j] * static_cast<int64_t>(updates);
+                }
+
+                if (!consistent) {
+                    failures.fetch_add(1, std::memory_order_relaxed);
+                }
+                lastVersion = snapshot.version;
+                ++count;
+            }
+
+            reads.fetch_add(count);
+        });
+    }
+
+    for (uint32_t i(0); i < SNAPSHOT_UPDATES; ++i) {
+        for (size_t j(0); j < snapshotSteps.size(); ++j) {
+            counterWrite(simulatedMotors[j].counterUnit, encoders->getState().counts[j] +
+                                                         snapshotSteps[j]);
+        }
+        encoders->update();
+    }
+
+    done = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    Log.noticeln("Snapshot stress - Readers: %u Updates: %u Reads: %u Inconsistent: %u",
+                 SNAPSHOT_READERS, SNAPSHOT_UPDATES, static_cast<uint32_t>(reads.load()),
+                 failures.load());
+    return failures.load() == 0;
+}
+
+/**
+ * Race producer threads deferring bursts of messages against the drain, checking that most
+ * messages come out, that every one comes out intact and in order, and that none go missing
+ *
+ * @return True if every message was accounted for and most were received
+ */
+bool stressDeferredLog() {
+    DeferredLog *log = DeferredLog::instance();
+    log->drain();
+    uint32_t initialDropped = log->getDropped();
+    std::atomic<uint8_t> running(LOG_PRODUCERS);
+    std::vector<std::thread> threads;
+
+    for (uint8_t i(0); i < LOG_PRODUCERS; ++i) {
+        threads.emplace_back([&, i]() {
+            for (uint32_t j(0); j < LOG_MESSAGES; ++j) {
+                deferLog(LOG_LEVEL_VERBOSE, LOG_STRESS_FORMAT, i, j, ~j);
+                if ((j + 1) % LOG_BURST == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(LOG_PAUSE));
+                }
+            }
+            running.fetch_sub(1);
+        });
+    }
+
+    // Take the messages out (without writing them) until the producers are done and it is empty
+    std::array<int64_t, LOG_PRODUCERS> lastMessage;
+    lastMessage.fill(-1);
+    uint32_t received = 0;
+    uint32_t failures = 0;
+    LogRecord record = {};
+    bool finished = false;
+    while (!finished) {
+        finished = running.load() == 0;
+        while (log->pop(record)) {
+            uint32_t producer = record.arguments[0];
+            uint32_t message = record.arguments[1];
+            if (record.format != LOG_STRESS_FORMAT || record.count != 3 ||
+                producer >= LOG_PRODUCERS || record.arguments[2] != ~message ||
+                static_cast<int64_t>(message) <= lastMessage[producer]) {
+                ++failures;
+            } else {
+                lastMessage[producer] = message;
+            }
+            ++received;
+        }
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    uint32_t dropped = log->getDropped() - initialDropped;
+    bool accounted = received + dropped == LOG_PRODUCERS * LOG_MESSAGES;
+    Log.noticeln("Deferred log - Producers: %u Messages: %u Received: %u Dropped: %u Corrupt: %u "
+                 "Accounted: %T", LOG_PRODUCERS, LOG_PRODUCERS * LOG_MESSAGES, received, dropped,
+                 failures, accounted);
+    return failures == 0 && accounted && received > LOG_PRODUCERS * LOG_MESSAGES / 2;
+}
+
+/**
+ * Get the angle between an orientation and the identity orientation
+ *
+ * @param orientation - The orientation
+ * @return The angle in rad
+ */
+float angleFromIdentity(const Quaternion &orientation) {
+    return 2.0f * acosf(std::min(fabsf(orientation.w), 1.0f));
+}
+
+int main() {
+    // Establish logging
+    Serial.begin(0);
+    Log.begin(LOG_LEVEL, &Serial, true);
+    hostClockSimulate(true);
+
+    // Initialize the handlers
+    try {
+        EncoderHandler::instance()->initialize(encoderPins);
+        MotorHandler::instance()->initialize(motorPins, PWM_FREQUENCY, PWM_RESOLUTION,
+                                             DIRECTION_DEADTIME);
+        MotorHandler::instance()->setDeadbands(MOTOR_DEADBANDS);
+        MotorHandler::instance()->setLimits(MOTOR_LIMITS);
+    } catch (const std::exception &ex) {
+        Log.errorln("Failed to initialize the handlers - %s", ex.what());
+        return 1;
+    }
+    DeferredLog::instance()->drain();
+
+    // Run the control loop
+    ControlAlgoImpl::setMaxAngularSpeed(MAX_ANGULAR_SPEED);
+    ControlAlgoImpl::setAttitudeGain(ATTITUDE_GAIN);
+    ControlAlgoImpl::setVelocityGains(VELOCITY_GAINS);
+    Factory factory;
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint32_t i(0); i < CONTROL_ITERATIONS; ++i) {
+        hostPublishIMUSample(syntheticSample(i));
+        EncoderHandler::instance()->update();
+
+        try {
+            factory.makeControlAlgo(CONTROL_SWITCHES).execute();
+        } catch (const std::exception &ex) {
+            Log.errorln("Failed to create or execute control algorithm - %s", ex.what());
+            return 1;
+        }
+
+        hostClockAdvance(CONTROL_PERIOD);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    Log.noticeln("Control loop - Iterations: %u Time: %u ns/iteration", CONTROL_ITERATIONS,
+                 static_cast<uint32_t>(elapsed / CONTROL_ITERATIONS));
+
+    // Step the velocity loops, then close the loop around the plant from random orientations
+    PlantSimulator plant(PLANT, simulatedMotors, SIMULATION_SEED);
+    plant.reset(Quaternion());
+    stepVelocityLoop(plant, VELOCITY_GAINS);
+
+    // Characterize the motors, then step the velocity loops again with the gains tuned from them
+    MotorCharacterizer characterizer(CHARACTERIZATION, DEFAULT_KINEMATICS.getRadiansPerCount());
+    plant.reset(Quaternion());
+    if (!characterizeMotors(plant, characterizer)) {
+        Log.errorln("The motors could not be characterized");
+        return 1;
+    }
+
+    VelocityGains tunedGains = deriveVelocityGains(characterizer.getModels(), CHARACTERIZATION);
+    std::array<float, 3> tunedDeadbands = {};
+    for (size_t i(0); i < tunedDeadbands.size(); ++i) {
+        tunedDeadbands[i] = characterizer.getModels()[i].deadband;
+    }
+    Log.noticeln("Tuned gains - Kp: %F Ki: %F FF: %F", tunedGains.proportional,
+                 tunedGains.integral, tunedGains.feedForward);
+
+    MotorHandler::instance()->setDeadbands(tunedDeadbands);
+    plant.reset(Quaternion());
+    stepVelocityLoop(plant, tunedGains);
+    MotorHandler::instance()->setDeadbands(MOTOR_DEADBANDS);
+    std::mt19937 generator(SIMULATION_SEED);
+    std::normal_distribution<float> component(0.0f, 1.0f);
+    float worstError = 0.0f;
+    float totalError = 0.0f;
+    start = std::chrono::steady_clock::now();
+
+    for (uint32_t scenario(0); scenario < SIMULATION_SCENARIOS; ++scenario) {
+        Quaternion initial(component(generator), component(generator), component(generator),
+                           component(generator));
+        initial.normalize();
+        plant.reset(initial);
+
+        // Restart the algo so it starts from the new orientation, as flipping the switches would
+        factory.makeControlAlgo(restartSwitches);
+        factory.makeControlAlgo(CONTROL_SWITCHES);
+
+        for (uint32_t i(0); i < SIMULATION_TIME * 1000 / CONTROL_PERIOD; ++i) {
+            EncoderHandler::instance()->update();
+
+            try {
+                factory.makeControlAlgo(CONTROL_SWITCHES).execute();
+            } catch (const std::exception &ex) {
+                Log.errorln("Failed to create or execute control algorithm - %s", ex.what());
+                return 1;
+            }
+
+            plant.advance(CONTROL_PERIOD);
+        }
+
+        float error = angleFromIdentity(plant.getOrientation());
+        worstError = std::max(worstError, error);
+        totalError += error;
+    }
+
+    elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    uint64_t simulated = static_cast<uint64_t>(SIMULATION_SCENARIOS) * SIMULATION_TIME * 1000000;
+    Log.noticeln("Simulation - Scenarios: %u Mean Error: %F rad Worst Error: %F rad Speed: %ux "
+                 "real time", SIMULATION_SCENARIOS, totalError / SIMULATION_SCENARIOS, worstError,
+                 static_cast<uint32_t>(simulated / std::max<int64_t>(elapsed, 1)));
+
+    // Drive the scheduler with on time, late and missed ticks
+    if (!checkScheduler()) {
+        Log.errorln("The scheduler's timing statistics were wrong");
+        return 1;
+    }
+
+    // Race the IMU sample channel and history against their writer
+    if (!stressSampleChannel()) {
+        Log.errorln("IMU samples were torn or out of order");
+        return 1;
+    }
+
+    // Read packets out of a mock MPU FIFO
+    if (!checkFIFOReader()) {
+        Log.errorln("The FIFO reader mishandled the mock FIFO");
+        return 1;
+    }
+
+    // Round trip samples through the IMU packets
+    if (!checkIMUPackets()) {
+        Log.errorln("IMU samples did not survive the packet round trip");
+        return 1;
+    }
+
+    // Subscribe with cached GATT handles
+    if (!checkGATTCache()) {
+        Log.errorln("The cached GATT handles were mishandled");
+        return 1;
+    }
+
+    // Wrap the encoder counters
+    if (!checkCounterExtension()) {
+        Log.errorln("Encoder counts were lost across a wrap");
+        return 1;
+    }
+
+    // Check the encoder velocity estimate
+    if (!checkVelocityEstimator()) {
+        Log.errorln("The encoder velocity estimate strayed");
+        return 1;
+    }
+
+    // Race the encoder snapshots against updates
+    if (!stressSnapshots()) {
+        Log.errorln("Encoder snapshots were inconsistent");
+        return 1;
+    }
+
+    // Race the deferred log against its drain
+    if (!stressDeferredLog()) {
+        Log.errorln("Deferred log messages were corrupted or lost");
+        return 1;
+    }
+
+    // Time the control math kernels
+    runQuatMathBenchmarks(BENCHMARK_ITERATIONS, hostNanoseconds, "ns");
+    runControlBenchmarks(BENCHMARK_ITERATIONS, hostNanoseconds, "ns");
+    runMotorBenchmarks(motorPins, BENCHMARK_ITERATIONS, hostNanoseconds, "ns");
+    runLogBenchmarks(BENCHMARK_ITERATIONS, hostNanoseconds, "ns");
+    return 0;
+}
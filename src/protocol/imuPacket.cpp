@@ -0,0 +1,311 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "protocol/imuPacket.h"
+#include <cmath>
+#include <cstring>
+
+// The scale of SmallestThree's 15-bit components. The three smallest components of a unit
+// quaternion lie in [-1/sqrt(2), 1/sqrt(2)]
+static constexpr float SMALLEST_THREE_SCALE = 16383.0f * 1.41421356f;
+static constexpr int32_t SMALLEST_THREE_MAX = 16383;    // The largest 15-bit component
+
+/**
+ * Write a little-endian 16-bit value
+ */
+static void write16(uint8_t *data, const uint16_t &value) {
+    data[0] = value & 0xFF;
+    data[1] = value >> 8;
+}
+
+/**
+ * Write a little-endian 32-bit value
+ */
+static void write32(uint8_t *data, const uint32_t &value) {
+    write16(data, value & 0xFFFF);
+    write16(data + 2, value >> 16);
+}
+
+/**
+ * Read a little-endian 16-bit value
+ */
+static uint16_t read16(const uint8_t *data) {
+    return data[0] | (data[1] << 8);
+}
+
+/**
+ * Read a little-endian 32-bit value
+ */
+static uint32_t read32(const uint8_t *data) {
+    return read16(data) | (static_cast<uint32_t>(read16(data + 2)) << 16);
+}
+
+/**
+ * Convert a float to a rounded fixed-point value, saturating at the limits
+ */
+static int32_t toFixed(const float &value, const float &scale, const int32_t &limit) {
+    int32_t fixed = lroundf(value * scale);
+    return fixed > limit ? limit : (fixed < -limit - 1 ? -limit - 1 : fixed);
+}
+
+/**
+ * Encode a quaternion as its smallest three components. The quaternion is normalized and its
+ * sign is chosen so the dropped component is positive (q and -q are the same rotation)
+ *
+ * @return The number of bytes written
+ */
+static size_t encodeSmallestThree(uint8_t *data, const Quaternion &quaternion) {
+    float components[4] = {quaternion.w, quaternion.x, quaternion.y, quaternion.z};
+    float magnitude = sqrtf(components[0] * components[0] + components[1] * components[1] +
+                            components[2] * components[2] + components[3] * components[3]);
+
+    uint8_t largest = 0;
+    for (uint8_t i(1); i < 4; ++i) {
+        if (fabsf(components[i]) > fabsf(components[largest])) {
+            largest = i;
+        }
+    }
+
+    float scale = magnitude > 0 ? SMALLEST_THREE_SCALE / magnitude : 0;
+    if (components[largest] < 0) {
+        scale = -scale;
+    }
+
+    // [index:2][a:15][b:15][c:15][unused:1], least significant bit first
+    uint64_t bits = largest;
+    uint8_t shift = 2;
+    for (uint8_t i(0); i < 4; ++i) {
+        if (i != largest) {
+            int32_t fixed = toFixed(components[i], scale, SMALLEST_THREE_MAX);
+            bits |= static_cast<uint64_t>(fixed & 0x7FFF) << shift;
+            shift += 15;
+        }
+    }
+
+    write16(&data[0], bits & 0xFFFF);
+    write32(&data[2], bits >> 16);
+    return 6;
+}
+
+/**
+ * Decode a quaternion sent as its smallest three components
+ */
+static void decodeSmallestThree(const uint8_t *data, Quaternion &quaternion) {
+    uint64_t bits = read16(&data[0]) | (static_cast<uint64_t>(read32(&data[2])) << 16);
+    uint8_t largest = bits & 0x3;
+
+    float components[4];
+    float sum = 0;
+    uint8_t shift = 2;
+    for (uint8_t i(0); i < 4; ++i) {
+        if (i != largest) {
+            // Sign extend the 15-bit component
+            auto fixed = static_cast<int16_t>(((bits >> shift) & 0x7FFF) << 1) >> 1;
+            components[i] = fixed / SMALLEST_THREE_SCALE;
+            sum += components[i] * components[i];
+            shift += 15;
+        }
+    }
+    components[largest] = sum < 1 ? sqrtf(1 - sum) : 0;
+
+    quaternion.w = components[0];
+    quaternion.x = components[1];
+    quaternion.y = components[2];
+    quaternion.z = components[3];
+}
+
+/**
+ * Encode a quaternion
+ *
+ * @return The number of bytes written
+ */
+static size_t encodeQuaternion(uint8_t *data, const Quaternion &quaternion, const IMUEncoding
+&encoding) {
+    switch (encoding) {
+        case IMUEncoding::Q14:
+            write16(&data[0], toFixed(quaternion.w, 16384.0f, INT16_MAX));
+            write16(&data[2], toFixed(quaternion.x, 16384.0f, INT16_MAX));
+            write16(&data[4], toFixed(quaternion.y, 16384.0f, INT16_MAX));
+            write16(&data[6], toFixed(quaternion.z, 16384.0f, INT16_MAX));
+            return 8;
+        case IMUEncoding::SmallestThree:
+            return encodeSmallestThree(data, quaternion);
+        case IMUEncoding::Float32:
+        default:
+            memcpy(&data[0], &quaternion.w, sizeof(float));
+            memcpy(&data[4], &quaternion.x, sizeof(float));
+            memcpy(&data[8], &quaternion.y, sizeof(float));
+            memcpy(&data[12], &quaternion.z, sizeof(float));
+            return 16;
+    }
+}
+
+/**
+ * Decode a quaternion
+ */
+static void decodeQuaternion(const uint8_t *data, Quaternion &quaternion, const IMUEncoding
+&encoding) {
+    switch (encoding) {
+        case IMUEncoding::Q14:
+            quaternion.w = static_cast<int16_t>(read16(&data[0])) / 16384.0f;
+            quaternion.x = static_cast<int16_t>(read16(&data[2])) / 16384.0f;
+            quaternion.y = static_cast<int16_t>(read16(&data[4])) / 16384.0f;
+            quaternion.z = static_cast<int16_t>(read16(&data[6])) / 16384.0f;
+            break;
+        case IMUEncoding::SmallestThree:
+            decodeSmallestThree(data, quaternion);
+            break;
+        case IMUEncoding::Float32:
+        default:
+            memcpy(&quaternion.w, &data[0], sizeof(float));
+            memcpy(&quaternion.x, &data[4], sizeof(float));
+            memcpy(&quaternion.y, &data[8], sizeof(float));
+            memcpy(&quaternion.z, &data[12], sizeof(float));
+            break;
+    }
+}
+
+bool isKnownEncoding(const uint8_t &encoding) noexcept {
+    return encoding <= static_cast<uint8_t>(IMUEncoding::SmallestThree);
+}
+
+IMUPacketEncoder::IMUPacketEncoder(const IMUEncoding &encoding, const uint8_t &capacity) noexcept
+        : buffer{}, length(0), encoding(encoding), capacity(1), count(0), lastSequence(0),
+          lastTimestamp(0) {
+    setCapacity(capacity);
+}
+
+void IMUPacketEncoder::setCapacity(const uint8_t &samples) noexcept {
+    size_t maxSamples = (IMU_PACKET_MAX_SIZE - IMU_PACKET_HEADER_SIZE) / (sizeof(uint16_t) +
+                                                                          encodedSize(encoding));
+    capacity = samples < 1 ? 1 : (samples > maxSamples ? maxSamples : samples);
+    clear();
+}
+
+void IMUPacketEncoder::setEncoding(const IMUEncoding &encoding) noexcept {
+    this->encoding = encoding;
+    setCapacity(capacity);
+}
+
+bool IMUPacketEncoder::add(const IMUPacketSample &sample) noexcept {
+    if (count >= capacity) {
+        return false;
+    }
+
+    uint32_t delta = 0;
+    if (count == 0) {
+        // Write the header
+        buffer[0] = IMU_PACKET_VERSION;
+        buffer[1] = static_cast<uint8_t>(encoding);
+        buffer[3] = 0;
+        write32(&buffer[4], sample.sequence);
+        write32(&buffer[8], sample.timestamp);
+        length = IMU_PACKET_HEADER_SIZE;
+    } else {
+        // Samples must be consecutive and close enough in time for a 16-bit delta
+        delta = sample.timestamp - lastTimestamp;
+        if (sample.sequence != lastSequence + 1 || delta > UINT16_MAX) {
+            return false;
+        }
+    }
+
+    write16(&buffer[length], delta);
+    length += sizeof(uint16_t);
+    length += encodeQuaternion(&buffer[length], sample.quaternion, encoding);
+
+    buffer[2] = ++count;
+    lastSequence = sample.sequence;
+    lastTimestamp = sample.timestamp;
+    return true;
+}
+
+void IMUPacketEncoder::clear() noexcept {
+    length = 0;
+    count = 0;
+}
+
+bool IMUPacketEncoder::isFull() const noexcept {
+    return count >= capacity;
+}
+
+bool IMUPacketEncoder::isEmpty() const noexcept {
+    return count == 0;
+}
+
+const uint8_t *IMUPacketEncoder::data() const noexcept {
+    return buffer;
+}
+
+size_t IMUPacketEncoder::size() const noexcept {
+    return length;
+}
+
+uint8_t IMUPacketEncoder::samplesForMTU(const uint16_t &MTU, const IMUEncoding &encoding)
+noexcept {
+    // 3 bytes of every ATT notification are the opcode and handle
+    size_t payload = MTU > 3 ? MTU - 3 : 0;
+    payload = payload < IMU_PACKET_MAX_SIZE ? payload : IMU_PACKET_MAX_SIZE;
+    size_t sampleSize = sizeof(uint16_t) + encodedSize(encoding);
+    size_t samples = payload > IMU_PACKET_HEADER_SIZE ? (payload - IMU_PACKET_HEADER_SIZE) /
+                                                        sampleSize : 0;
+
+    return samples < 1 ? 1 : (samples > UINT8_MAX ? UINT8_MAX : samples);
+}
+
+size_t IMUPacketEncoder::encodedSize(const IMUEncoding &encoding) noexcept {
+    switch (encoding) {
+        case IMUEncoding::Q14:
+            return 8;
+        case IMUEncoding::SmallestThree:
+            return 6;
+        case IMUEncoding::Float32:
+        default:
+            return 16;
+    }
+}
+
+IMUPacketDecoder::IMUPacketDecoder(const uint8_t *data, const size_t &length) noexcept
+        : cursor(nullptr), encoding(IMUEncoding::Float32), count(0), index(0), sequence(0),
+          timestamp(0) {
+    if (data == nullptr || length < IMU_PACKET_HEADER_SIZE || data[0] != IMU_PACKET_VERSION ||
+        !isKnownEncoding(data[1])) {
+        return;
+    }
+
+    // The length must match the number of samples exactly
+    auto packetEncoding = static_cast<IMUEncoding>(data[1]);
+    size_t sampleSize = sizeof(uint16_t) + IMUPacketEncoder::encodedSize(packetEncoding);
+    if (length != IMU_PACKET_HEADER_SIZE + data[2] * sampleSize) {
+        return;
+    }
+
+    cursor = &data[IMU_PACKET_HEADER_SIZE];
+    encoding = packetEncoding;
+    count = data[2];
+    sequence = read32(&data[4]);
+    timestamp = read32(&data[8]);
+}
+
+bool IMUPacketDecoder::isValid() const noexcept {
+    return cursor != nullptr;
+}
+
+uint8_t IMUPacketDecoder::getCount() const noexcept {
+    return count;
+}
+
+bool IMUPacketDecoder::next(IMUPacketSample &sample) noexcept {
+    if (index >= count) {
+        return false;
+    }
+
+    timestamp += read16(cursor);
+    sample.sequence = sequence + index;
+    sample.timestamp = timestamp;
+    decodeQuaternion(cursor + sizeof(uint16_t), sample.quaternion, encoding);
+
+    cursor += sizeof(uint16_t) + IMUPacketEncoder::encodedSize(encoding);
+    ++index;
+    return true;
+}
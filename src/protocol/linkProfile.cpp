@@ -0,0 +1,81 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "protocol/linkProfile.h"
+
+void applyLinkProfile(const LinkProfile &profile) {
+    if (!NimBLEDevice::setMTU(profile.MTU)) {
+        Log.warningln("applyLinkProfile - Failed to set the preferred MTU to %d", profile.MTU);
+    }
+
+    if (profile.PHY2M) {
+        uint8_t mask = BLE_GAP_LE_PHY_1M_MASK | BLE_GAP_LE_PHY_2M_MASK;
+        if (ble_gap_set_prefered_default_le_phy(mask, mask) != 0) {
+            Log.noticeln("applyLinkProfile - The 2M PHY is not supported. Using the 1M PHY");
+        }
+    }
+}
+
+bool tuneConnection(const uint16_t &connHandle, const LinkProfile &profile) {
+    bool success = true;
+
+    // The time to send the payload on the 1M PHY (including the 14 bytes of overhead) in µs
+    uint16_t dataTime = (profile.dataLength + 14) * 8;
+    int rc = ble_gap_set_data_len(connHandle, profile.dataLength, dataTime);
+    if (rc != 0) {
+        Log.warningln("tuneConnection - Failed to set the data length (code %d)", rc);
+        success = false;
+    }
+
+    if (profile.PHY2M) {
+        rc = ble_gap_set_prefered_le_phy(connHandle, BLE_GAP_LE_PHY_2M_MASK,
+                                         BLE_GAP_LE_PHY_2M_MASK, BLE_GAP_LE_PHY_CODED_ANY);
+        if (rc != 0) {
+            Log.noticeln("tuneConnection - Failed to request the 2M PHY (code %d)", rc);
+            success = false;
+        }
+    }
+
+    ble_gap_upd_params params = {};
+    params.itvl_min = profile.minInterval;
+    params.itvl_max = profile.maxInterval;
+    params.latency = profile.latency;
+    params.supervision_timeout = profile.timeout;
+    rc = ble_gap_update_params(connHandle, &params);
+    if (rc != 0) {
+        Log.warningln("tuneConnection - Failed to request the connection parameters (code %d)",
+                      rc);
+        success = false;
+    }
+
+    return success;
+}
+
+LinkParameters readLinkParameters(const NimBLEConnInfo &connInfo) {
+    LinkParameters parameters = {};
+    parameters.MTU = connInfo.getMTU();
+    parameters.interval = connInfo.getConnInterval();
+    parameters.latency = connInfo.getConnLatency();
+    parameters.timeout = connInfo.getConnTimeout();
+
+    if (ble_gap_read_le_phy(connInfo.getConnHandle(), &parameters.txPHY, &parameters.rxPHY) !=
+        0) {
+        parameters.txPHY = 0;
+        parameters.rxPHY = 0;
+    }
+
+    return parameters;
+}
+
+void logLinkParameters(const LinkParameters &parameters, const LinkProfile &profile) {
+    // Intervals are in 1.25 ms units
+    Log.infoln("Link: MTU %d, interval %d.%d ms, latency %d, timeout %d ms, PHY %d/%d",
+               parameters.MTU, parameters.interval * 125 / 100, parameters.interval * 125 % 100,
+               parameters.latency, parameters.timeout * 10, parameters.txPHY, parameters.rxPHY);
+
+    if (parameters.interval > profile.maxInterval || parameters.latency > profile.latency) {
+        Log.warningln("Link: The connection is slower than requested (max interval %d.%d ms)",
+                      profile.maxInterval * 125 / 100, profile.maxInterval * 125 % 100);
+    }
+}
@@ -1,6 +1,6 @@
 // Author: Robert Polk
 // Copyright (c) 2024 BLINK. All rights reserved.
-// Last Modified: 11/24/2024
+// Last Modified: 10/16/2026
 
 //================================================================================================//
 
@@ -23,6 +23,9 @@
 #include <NimBLEDevice.h>
 #include "..\lib\I2Cdev\I2Cdev.h"
 #include "..\lib\MPU6050\MPU6050_6Axis_MotionApps20.h"
+#include "server/fifoReader.h"
+#include "protocol/imuPacket.h"
+#include "protocol/linkProfile.h"
 
 /*
  * Logging
@@ -59,6 +62,9 @@ constexpr uint32_t BAUD_RATE = 115200;  // The baud rate for serial communicatio
  * This section configures the BLE Server by setting the UUIDs and device name. The UUIDs need to
  * match those set in mechanism/main.cpp in order for the server to connect properly. New
  * UUIDs can be generated at https://www.uuidgenerator.net/.
+ *
+ * The link profile sets the MTU, data length, PHY and connection interval requested from each
+ * client. The agreed values are logged whenever they change
  */
 
 // Configuration Variables
@@ -68,11 +74,12 @@ const std::string SERVICE_UUID =
 const std::string IMU_CHARACTERISTIC_UUID =
         "72b9a4be-85fe-4cd5-ae42-f32414542c5a"; // The UUID for the IMU characteristic
 const std::string DEVICE_NAME = "Eyeball";      // The name of the device that the server is on
+constexpr LinkProfile LINK_PROFILE = LOW_LATENCY_LINK;  // The link settings to request
 
 // Program Variables
 NimBLEServer *server = nullptr; // Ptr to the server
 NimBLECharacteristic *IMUCharacteristic = nullptr;  // Ptr to the IMU characteristic
-bool connected = false; // If the server is currently connected to a client
+volatile bool connected = false;    // If the server is currently connected to a client
 bool prevConnected = false; // Previous state of connected
 
 /*
@@ -80,7 +87,12 @@ bool prevConnected = false; // Previous state of connected
  *
  * This section configures the IMU by setting the interrupt pin, I2C clock, and variable offsets.
  * Offset values can be obtained from the IMU_Zero program found in the examples folder of the
- * library
+ * library. The IMU's interrupt wakes a high priority task that drains the DMP FIFO and notifies
+ * the client as soon as each packet is ready. Up to BATCH_SIZE samples are sent per notification
+ * (fewer if the connection's MTU cannot fit them). Larger batches use less of the link but
+ * delay the older samples in each batch by up to (BATCH_SIZE - 1) * DMP_PERIOD. Quaternions are
+ * sent as floats until the client writes the ID of a more compact IMUEncoding to the IMU
+ * characteristic
  */
 
 // Configuration Variables
@@ -92,18 +104,25 @@ int16_t Z_ACCEL_OFFSET = 595;
 int16_t X_GYRO_OFFSET = -103;
 int16_t Y_GYRO_OFFSET = 9;
 int16_t Z_GYRO_OFFSET = 34;
+constexpr uint8_t IMU_TASK_CORE = 1;    // The core the IMU task runs on
+constexpr uint8_t IMU_TASK_PRIORITY = 5;    // The FreeRTOS priority of the IMU task
+constexpr uint32_t IMU_TIMEOUT = 100;   // The time to wait for an interrupt before polling in ms
+constexpr uint32_t DMP_PERIOD = 10000;  // The time between DMP packets in µs (100 Hz)
+constexpr uint8_t BATCH_SIZE = 2;   // The maximum number of samples per notification
 
 // Program Variables
 MPU6050 mpu;            // MPU instance
 bool DMPInit = false;   // If the DMP initialization was successful
-volatile bool interrupt = false; // If the IMU interrupt pin has gone high
-//uint8_t interruptStatus;    // Holds the interrupt status byte from the IMU
+TaskHandle_t IMUTaskHandle = nullptr;   // Ptr to the IMU's FreeRTOS task
 uint8_t DMPStatus;          // The result of each DMP operation (!0 = error)
-//uint16_t packetSize;        // Expected DMP packet size (default is 42 bytes)
-//uint16_t fifoCount;         // Sum of all bytes currently in the FIFO
+uint16_t packetSize;        // Expected DMP packet size (default is 42 bytes)
 uint8_t fifoBuffer[64];     // FIFO storage buffer
-Quaternion quaternion;      // Quaternion container [w,x,y,z]
-uint8_t quaternionData[16]; // Buffer to hold the 4 quaternion floats [wxyz]
+volatile uint32_t interruptTime = 0;    // When the IMU's interrupt last fired in µs
+uint32_t sequence = 0;      // The sequence number of the next sample
+IMUPacketEncoder encoder(IMUEncoding::Float32, BATCH_SIZE); // The batch of samples to notify
+volatile uint16_t peerMTU = BLE_ATT_MTU_DFLT;  // The connection's MTU
+// The IMUEncoding the client asked for
+volatile uint8_t requestedEncoding = static_cast<uint8_t>(IMUEncoding::Float32);
 
 //================================================================================================//
 
@@ -119,9 +138,14 @@ struct ServerCallbacks final : public NimBLEServerCallbacks {
      */
     void onConnect(NimBLEServer *connectedServer, NimBLEConnInfo &connInfo) override {
         connected = true;
+        peerMTU = connectedServer->getPeerMTU(connInfo.getConnHandle());
         Log.trace("Client Address: ");
         Log.traceln(connInfo.getAddress().toString().c_str());
         Log.infoln("Connected to a client");
+
+        // Ask for a fast link. Whatever the client agrees to is logged in onConnParamsUpdate
+        tuneConnection(connInfo.getConnHandle(), LINK_PROFILE);
+        logLinkParameters(readLinkParameters(connInfo), LINK_PROFILE);
     }
 
     /**
@@ -134,10 +158,31 @@ struct ServerCallbacks final : public NimBLEServerCallbacks {
     void
     onDisconnect(NimBLEServer *disconnectedServer, NimBLEConnInfo &connInfo, int reason) override {
         connected = false;
+        requestedEncoding = static_cast<uint8_t>(IMUEncoding::Float32);
         Log.warningln("Client disconnected");
         Log.infoln("Starting advertising");
         NimBLEDevice::startAdvertising();
     }
+
+    /**
+     * Called when the MTU changes. Sizes the IMU batches to fit in a notification
+     *
+     * @param MTU - The new MTU
+     * @param connInfo - The connection info
+     */
+    void onMTUChange(uint16_t MTU, NimBLEConnInfo &connInfo) override {
+        peerMTU = MTU;
+        Log.infoln("MTU changed to %d", MTU);
+    }
+
+    /**
+     * Called when the connection parameters change. Logs the agreed link settings
+     *
+     * @param connInfo - The connection info
+     */
+    void onConnParamsUpdate(NimBLEConnInfo &connInfo) override {
+        logLinkParameters(readLinkParameters(connInfo), LINK_PROFILE);
+    }
 };
 
 /**
@@ -145,7 +190,8 @@ struct ServerCallbacks final : public NimBLEServerCallbacks {
  */
 struct CharacteristicCallbacks final : public NimBLECharacteristicCallbacks {
     /**
-     * Called for write events
+     * Called for write events. A single byte written to the IMU characteristic selects the
+     * encoding of the quaternions
      *
      * @param characteristicWrittenTo - The characteristic that was written to
      * @param connInfo - The connection info
@@ -154,6 +200,17 @@ struct CharacteristicCallbacks final : public NimBLECharacteristicCallbacks {
         Log.trace(characteristicWrittenTo->toString().c_str());
         Log.trace(" written to value: ");
         Log.traceln(characteristicWrittenTo->getValue().c_str());
+
+        if (characteristicWrittenTo == IMUCharacteristic) {
+            NimBLEAttValue value = characteristicWrittenTo->getValue();
+
+            if (value.size() == 1 && isKnownEncoding(value[0])) {
+                requestedEncoding = value[0];
+                Log.infoln("Client requested IMU encoding %d", requestedEncoding);
+            } else {
+                Log.warningln("Client requested an unknown IMU encoding");
+            }
+        }
     }
 
     /**
@@ -208,6 +265,7 @@ void restart() {
 void setupBLEServer() {
     // Initialize BLE Device
     NimBLEDevice::init(DEVICE_NAME);
+    applyLinkProfile(LINK_PROFILE);
     Log.traceln("BLE device created");
 
     // Create the server
@@ -222,6 +280,7 @@ void setupBLEServer() {
     // Create characteristics
     IMUCharacteristic = eyeballService->createCharacteristic(IMU_CHARACTERISTIC_UUID,
                                                              NIMBLE_PROPERTY::READ |
+                                                             NIMBLE_PROPERTY::WRITE |
                                                              NIMBLE_PROPERTY::NOTIFY);
     IMUCharacteristic->setCallbacks(&characteristicCallback);
     Log.traceln("IMU Characteristic created");
@@ -243,9 +302,21 @@ void setupBLEServer() {
 }
 
 /**
- * Interrupt service routine for when the IMU's interrupt pin goes high
+ * Interrupt service routine for when the IMU's interrupt pin goes high. Wakes the IMU task
  */
-void DMPDataReady() { interrupt = true; }
+void IRAM_ATTR DMPDataReady() {
+    if (IMUTaskHandle == nullptr) {
+        return;
+    }
+
+    interruptTime = micros();
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(IMUTaskHandle, &higherPriorityTaskWoken);
+
+    if (higherPriorityTaskWoken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
 
 /**
  * Sets up the IMU to read DMP data. It joins the I2C bus and verifies that connection. It
@@ -295,14 +366,13 @@ void setupIMU() {
         mpu.setDMPEnabled(true);
         Log.traceln("DMP enabled");
 
+        // Get the packet size for draining the FIFO
+        packetSize = mpu.dmpGetFIFOPacketSize();
+
         // Enable the ESP32 interrupt detection
         attachInterrupt(digitalPinToInterrupt(INTERRUPT_PIN), DMPDataReady, RISING);
-      //  interruptStatus = mpu.getIntStatus();
         Log.traceln("Enabled interrupt detection on pin %d", INTERRUPT_PIN);
 
-        // Get the packet size for comparison
-//        packetSize = mpu.dmpGetFIFOPacketSize();
-
         // Set the DMPInit flag to true so the main loop knows all went well
         DMPInit = true;
         Log.infoln("IMU setup successful");
@@ -313,17 +383,83 @@ void setupIMU() {
 }
 
 /**
- * Reads the quaternion data from the DMP and packages it into a 16 byte array
+ * Notifies the client with the current batch of samples and starts a new batch
  */
-void packageQuaternionData() {
-    mpu.dmpGetQuaternion(&quaternion, fifoBuffer);
-    memcpy(&quaternionData[0], &quaternion.w, sizeof(float));
-    memcpy(&quaternionData[4], &quaternion.x, sizeof(float));
-    memcpy(&quaternionData[8], &quaternion.y, sizeof(float));
-    memcpy(&quaternionData[12], &quaternion.z, sizeof(float));
-
-    Log.verboseln("\tQuat:\t%D\t%D\t%D\t%D", quaternion.w, quaternion.x, quaternion.y, quaternion
-            .z);
+void transmitBatch() {
+    if (connected && !encoder.isEmpty()) {
+        IMUCharacteristic->setValue(encoder.data(), encoder.size());
+        IMUCharacteristic->notify();
+    }
+
+    // Start the next batch in the requested encoding, at the size that fits the connection's MTU
+    auto encoding = static_cast<IMUEncoding>(requestedEncoding);
+    encoder.setEncoding(encoding);
+    encoder.setCapacity(min(BATCH_SIZE, IMUPacketEncoder::samplesForMTU(peerMTU, encoding)));
+}
+
+/**
+ * Reads the quaternion data from a DMP packet and adds it to the batch. The batch is transmitted
+ * once it is full
+ *
+ * @param packet - The DMP packet
+ * @param timestamp - When the packet was produced in µs
+ */
+void packageQuaternionData(const uint8_t *packet, const uint32_t &timestamp) {
+    IMUPacketSample sample;
+    mpu.dmpGetQuaternion(&sample.quaternion, packet);
+    sample.sequence = sequence++;
+    sample.timestamp = timestamp;
+
+    // A sample that cannot join the batch (e.g. after a long gap) starts the next one
+    if (!encoder.add(sample)) {
+        transmitBatch();
+        encoder.add(sample);
+    }
+
+    if (encoder.isFull()) {
+        transmitBatch();
+    }
+
+    Log.verboseln("\tQuat:\t%D\t%D\t%D\t%D", sample.quaternion.w, sample.quaternion.x,
+                  sample.quaternion.y, sample.quaternion.z);
+}
+
+/**
+ * A freeRTOS task that waits for the IMU's interrupt, drains every packet from the DMP FIFO and
+ * batches them for the client. If no interrupt arrives within IMU_TIMEOUT the FIFO is drained
+ * anyway so a missed edge cannot stall the data
+ *
+ * @param param - Any parameters to be used by the task (none)
+ */
+void IMUTask(void *param) {
+    Log.infoln("Starting IMU task");
+    FIFOReader<MPU6050> reader(mpu, packetSize);
+
+    while (true) {
+        try {
+            uint32_t newest;
+            if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IMU_TIMEOUT)) == 0) {
+                Log.warningln("IMU interrupt timed out. Polling the FIFO");
+                newest = micros();
+            } else {
+                newest = interruptTime;
+            }
+
+            // The newest packet arrived with the interrupt. Older ones are a DMP period apart
+            reader.drain(fifoBuffer, [newest](uint8_t *packet, size_t remaining) {
+                packageQuaternionData(packet, newest - remaining * DMP_PERIOD);
+            });
+
+            // Samples produced while disconnected are discarded
+            if (!connected) {
+                encoder.clear();
+            }
+        } catch (const std::exception &ex) {
+            Log.errorln("IMU task execution failed - %s", ex.what());
+        } catch (...) {
+            Log.errorln("IMU task execution failed - Unknown Error");
+        }
+    }
 }
 
 /**
@@ -357,30 +493,28 @@ void setup() {
         restart();
     }
 
+    // Create the IMU task. Interrupts before it exists are ignored and drained on its first pass
+    BaseType_t IMUResult = xTaskCreatePinnedToCore(IMUTask, "IMUTask", 4096, nullptr,
+                                                   IMU_TASK_PRIORITY, &IMUTaskHandle,
+                                                   IMU_TASK_CORE);
+
+    if (IMUResult != pdPASS) {
+        Log.errorln("Failed to create IMUTask");
+        restart();
+    }
+
     Log.infoln("Beginning main loop");
 }
 
 /**
- * Main program loop to manage getting quaternion data from the DMP and transmitting it to the
- * client. If the client is connected, it gets the latest quaternion packet, packages it, and
- * then notifies the client. It handles reestablishing connections and disconnections
+ * Main program loop to manage the connection to the client. The IMU data is transmitted by the
+ * IMU task as soon as it is ready. It handles reestablishing connections and disconnections
  */
 void loop() {
     try {
-        // Notify the client that the IMU data has changed
-        if (connected) {
-            if (!DMPInit) {
-                Log.errorln("DMP not initialized successfully");
-                restart();
-            }
-
-            // Get the latest packet and transmit it
-            if (mpu.dmpGetCurrentFIFOPacket(fifoBuffer)) {
-                packageQuaternionData();
-                IMUCharacteristic->setValue(quaternionData, sizeof(quaternionData));
-                IMUCharacteristic->notify();
-                delay(10);
-            }
+        if (connected && !DMPInit) {
+            Log.errorln("DMP not initialized successfully");
+            restart();
         }
 
         // For disconnecting
@@ -394,6 +528,8 @@ void loop() {
         if (connected && !prevConnected) {
             prevConnected = connected;
         }
+
+        delay(100); // Connection changes do not need to be handled quickly
     } catch (const std::exception &ex) {
         Log.errorln("Loop execution failed - %s", ex.what());
     } catch (...) {
@@ -0,0 +1,242 @@
+// Author: Robert Polk
+// Copyright (c) 2024 BLINK. All rights reserved.
+// Last Modified: 10/16/2026
+
+#include "simulation/plantSimulator.h"
+#include <cmath>
+#include <stdexcept>
+#include "hal/clock.h"
+#include "hal/gpio.h"
+#include "hal/native/hostHAL.h"
+
+PlantSimulator::PlantSimulator(const PlantParameters &parameters,
+                               const std::array<SimulatedMotor, 3> &motors, const uint32_t &seed)
+        : parameters(parameters), motors(motors), axes{}, inverseInertia{},
+          orientation{1.0, 0.0, 0.0, 0.0}, angularVelocity{}, encoderRemainders{},
+          generator(seed), time(0), nextSampleTime(0), sequence(0) {
+    if (parameters.step == 0 || parameters.IMUPeriod == 0) {
+        throw std::logic_error("PlantSimulator - The step and IMU period must be non-zero");
+    }
+
+    if (parameters.wheelRadius <= 0.0 || parameters.sphereRadius <= 0.0) {
+        throw std::logic_error("PlantSimulator - The wheel and sphere radii must be positive");
+    }
+
+    // The wheels are spaced 120° apart below the equator and drive around the vertical axis. A
+    // wheel turns at ratio * (contact x drive) . ω, where ratio is the sphere to wheel radius
+    double ratio = parameters.sphereRadius / parameters.wheelRadius;
+    double c = cos(parameters.contactElevation);
+    double s = sin(parameters.contactElevation);
+    for (size_t i(0); i < axes.size(); ++i) {
+        double azimuth = 2.0 * M_PI * static_cast<double>(i) / 3.0;
+        axes[i] = {ratio * s * cos(azimuth), ratio * s * sin(azimuth), ratio * c};
+    }
+
+    // The rotors turn with the sphere, so their inertia adds to it along each wheel's axis
+    std::array<std::array<double, 3>, 3> inertia = {};
+    double rotor = parameters.rotorInertia * parameters.gearRatio * parameters.gearRatio;
+    for (size_t row(0); row < 3; ++row) {
+        for (size_t col(0); col < 3; ++col) {
+            inertia[row][col] = row == col ? parameters.sphereInertia : 0.0;
+            for (const auto &axis : axes) {
+                inertia[row][col] += rotor * axis[row] * axis[col];
+            }
+        }
+    }
+
+    // Invert the inertia by its cofactors
+    double det = inertia[0][0] * (inertia[1][1] * inertia[2][2] - inertia[1][2] * inertia[2][1]) -
+                 inertia[0][1] * (inertia[1][0] * inertia[2][2] - inertia[1][2] * inertia[2][0]) +
+                 inertia[0][2] * (inertia[1][0] * inertia[2][1] - inertia[1][1] * inertia[2][0]);
+    if (det <= 0.0) {
+        throw std::logic_error("PlantSimulator - The inertia must be positive definite");
+    }
+
+    for (size_t row(0); row < 3; ++row) {
+        for (size_t col(0); col < 3; ++col) {
+            const auto &a = inertia[(col + 1) % 3];
+            const auto &b = inertia[(col + 2) % 3];
+            inverseInertia[row][col] = (a[(row + 1) % 3] * b[(row + 2) % 3] -
+                                        a[(row + 2) % 3] * b[(row + 1) % 3]) / det;
+        }
+    }
+}
+
+void PlantSimulator::reset(const Quaternion &orientation) {
+    double magnitude = sqrt(orientation.w * orientation.w + orientation.x * orientation.x +
+                            orientation.y * orientation.y + orientation.z * orientation.z);
+    if (magnitude <= 0.0) {
+        throw std::logic_error("PlantSimulator::reset - The orientation must be non-zero");
+    }
+
+    this->orientation = {orientation.w / magnitude, orientation.x / magnitude,
+                         orientation.y / magnitude, orientation.z / magnitude};
+    angularVelocity = {};
+    encoderRemainders = {};
+    pendingSamples.clear();
+    nextSampleTime = time;
+}
+
+void PlantSimulator::advance(const uint32_t &us) {
+    uint64_t end = time + us;
+
+    while (time < end) {
+        uint32_t step = static_cast<uint32_t>(std::min<uint64_t>(parameters.step, end - time));
+        integrate(static_cast<double>(step) * 1.0e-6);
+        time += step;
+        hostClockAdvance(step);
+
+        while (nextSampleTime <= time) {
+            sampleIMU();
+            nextSampleTime += parameters.IMUPeriod;
+        }
+        deliverIMU();
+    }
+}
+
+Quaternion PlantSimulator::getOrientation() const noexcept {
+    return {static_cast<float>(orientation[0]), static_cast<float>(orientation[1]),
+            static_cast<float>(orientation[2]), static_cast<float>(orientation[3])};
+}
+
+std::array<double, 3> PlantSimulator::getAngularVelocity() const noexcept {
+    return angularVelocity;
+}
+
+uint64_t PlantSimulator::getTime() const noexcept {
+    return time;
+}
+
+void PlantSimulator::integrate(const double &dt) {
+    // Sum the torque each motor applies to the sphere
+    std::array<double, 3> torque = {};
+    for (size_t i(0); i < motors.size(); ++i) {
+        const auto &axis = axes[i];
+        double wheelSpeed = axis[0] * angularVelocity[0] + axis[1] * angularVelocity[1] +
+                            axis[2] * angularVelocity[2];
+        double motorSpeed = wheelSpeed * parameters.gearRatio;
+
+        // The winding's inductance is negligible at the loop rate, so the current settles within
+        // each PWM period
+        double current = readCurrent(motors[i], parameters.torqueConstant * motorSpeed);
+        double wheelTorque = parameters.torqueConstant * current * parameters.gearRatio *
+                             parameters.gearEfficiency;
+
+        for (size_t j(0); j < torque.size(); ++j) {
+            torque[j] += wheelTorque * axis[j];
+        }
+    }
+
+    for (size_t j(0); j < torque.size(); ++j) {
+        torque[j] -= parameters.damping * angularVelocity[j];
+    }
+
+    // Semi-implicit Euler: update the velocity first and move with the new velocity
+    for (size_t row(0); row < 3; ++row) {
+        for (size_t col(0); col < 3; ++col) {
+            angularVelocity[row] += inverseInertia[row][col] * torque[col] * dt;
+        }
+    }
+
+    // Count the encoder edges each motor shaft passed, keeping the partial counts
+    for (size_t i(0); i < motors.size(); ++i) {
+        const auto &axis = axes[i];
+        double wheelSpeed = axis[0] * angularVelocity[0] + axis[1] * angularVelocity[1] +
+                            axis[2] * angularVelocity[2];
+        double counts = encoderRemainders[i] + wheelSpeed * parameters.gearRatio * dt *
+                                               parameters.encoderCPR / (2.0 * M_PI);
+        double whole = floor(counts);
+        encoderRemainders[i] = counts - whole;
+
+        if (whole != 0.0) {
+            hostCounterAdd(motors[i].counterUnit, static_cast<int64_t>(whole));
+        }
+    }
+
+    // Rotate the orientation by the step's rotation (in the world frame)
+    double speed = sqrt(angularVelocity[0] * angularVelocity[0] +
+                        angularVelocity[1] * angularVelocity[1] +
+                        angularVelocity[2] * angularVelocity[2]);
+    if (speed > 0.0) {
+        double half = speed * dt / 2.0;
+        double scale = sin(half) / speed;
+        std::array<double, 4> step = {cos(half), angularVelocity[0] * scale,
+                                      angularVelocity[1] * scale, angularVelocity[2] * scale};
+        const auto &q = orientation;
+        std::array<double, 4> rotated = {
+                step[0] * q[0] - step[1] * q[1] - step[2] * q[2] - step[3] * q[3],
+                step[0] * q[1] + step[1] * q[0] + step[2] * q[3] - step[3] * q[2],
+                step[0] * q[2] - step[1] * q[3] + step[2] * q[0] + step[3] * q[1],
+                step[0] * q[3] + step[1] * q[2] - step[2] * q[1] + step[3] * q[0]};
+
+        double magnitude = sqrt(rotated[0] * rotated[0] + rotated[1] * rotated[1] +
+                                rotated[2] * rotated[2] + rotated[3] * rotated[3]);
+        for (size_t j(0); j < orientation.size(); ++j) {
+            orientation[j] = rotated[j] / magnitude;
+        }
+    }
+}
+
+void PlantSimulator::sampleIMU() {
+    // Perturb the orientation by a small random rotation
+    std::normal_distribution<double> noise(0.0, parameters.IMUNoise);
+    std::array<double, 4> error = {1.0, noise(generator) / 2.0, noise(generator) / 2.0,
+                                   noise(generator) / 2.0};
+    const auto &q = orientation;
+    Quaternion measured(
+            static_cast<float>(error[0] * q[0] - error[1] * q[1] - error[2] * q[2] -
+                               error[3] * q[3]),
+            static_cast<float>(error[0] * q[1] + error[1] * q[0] + error[2] * q[3] -
+                               error[3] * q[2]),
+            static_cast<float>(error[0] * q[2] - error[1] * q[3] + error[2] * q[0] +
+                               error[3] * q[1]),
+            static_cast<float>(error[0] * q[3] + error[1] * q[2] - error[2] * q[1] +
+                               error[3] * q[0]));
+    measured.normalize();
+
+    // Notifications arrive in order, so a sample is never delivered before the one ahead of it
+    std::uniform_int_distribution<int64_t> jitter(-static_cast<int64_t>(parameters.IMUJitter),
+                                                  parameters.IMUJitter);
+    uint64_t deliveryTime = nextSampleTime + parameters.IMULatency + jitter(generator);
+    if (!pendingSamples.empty() && deliveryTime < pendingSamples.back().deliveryTime) {
+        deliveryTime = pendingSamples.back().deliveryTime;
+    }
+
+    PendingSample pending = {};
+    pending.deliveryTime = deliveryTime;
+    pending.sample.quaternion = measured;
+    pending.sample.sequence = sequence++;
+    pending.sample.deviceTimestamp = static_cast<uint32_t>(nextSampleTime);
+    pendingSamples.push_back(pending);
+}
+
+void PlantSimulator::deliverIMU() {
+    while (!pendingSamples.empty() && pendingSamples.front().deliveryTime <= time) {
+        IMUSample sample = pendingSamples.front().sample;
+        sample.timestamp = clockMicros();
+        hostPublishIMUSample(sample);
+        pendingSamples.pop_front();
+    }
+}
+
+double PlantSimulator::readCurrent(const SimulatedMotor &motor, const double &backEMF) const {
+    uint8_t resolution = hostPWMResolution(motor.PWMChannel);
+    if (resolution == 0) {
+        return 0.0;
+    }
+
+    // IN1 is high for the duty cycle. With IN2 low, IN1 high drives forward and IN1 low coasts.
+    // With IN2 high, IN1 low drives in reverse and IN1 high brakes
+    double high = static_cast<double>(hostPWMRead(motor.PWMChannel)) /
+                  static_cast<double>((1UL << resolution) - 1);
+    bool reverse = gpioRead(motor.directionPin);
+    double drive = reverse ? 1.0 - high : high;
+    double brake = reverse ? high : 0.0;
+    if (drive < parameters.deadband) {
+        drive = 0.0;
+    }
+
+    // A coasting motor carries no current, a braking one is shorted across its back-EMF
+    double voltage = reverse ? -parameters.supplyVoltage : parameters.supplyVoltage;
+    return (drive * (voltage - backEMF) - brake * backEMF) / parameters.resistance;
+}